@@ -0,0 +1,318 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "additive.h"
+
+// vector types / operations of the selected kernel
+#if defined(FAS_ADDITIVE_AVX)
+#ifdef USE_DOUBLE
+    typedef __m256d fas_vec;
+    #define FAS_VEC_LANES 4
+    #define fas_vec_load _mm256_loadu_pd
+    #define fas_vec_store _mm256_storeu_pd
+    #define fas_vec_set1 _mm256_set1_pd
+    #define fas_vec_add _mm256_add_pd
+    #define fas_vec_sub _mm256_sub_pd
+    #define fas_vec_mul _mm256_mul_pd
+#else
+    typedef __m256 fas_vec;
+    #define FAS_VEC_LANES 8
+    #define fas_vec_load _mm256_loadu_ps
+    #define fas_vec_store _mm256_storeu_ps
+    #define fas_vec_set1 _mm256_set1_ps
+    #define fas_vec_add _mm256_add_ps
+    #define fas_vec_sub _mm256_sub_ps
+    #define fas_vec_mul _mm256_mul_ps
+#endif
+#elif defined(FAS_ADDITIVE_SSE)
+#ifdef USE_DOUBLE
+    typedef __m128d fas_vec;
+    #define FAS_VEC_LANES 2
+    #define fas_vec_load _mm_loadu_pd
+    #define fas_vec_store _mm_storeu_pd
+    #define fas_vec_set1 _mm_set1_pd
+    #define fas_vec_add _mm_add_pd
+    #define fas_vec_sub _mm_sub_pd
+    #define fas_vec_mul _mm_mul_pd
+#else
+    typedef __m128 fas_vec;
+    #define FAS_VEC_LANES 4
+    #define fas_vec_load _mm_loadu_ps
+    #define fas_vec_store _mm_storeu_ps
+    #define fas_vec_set1 _mm_set1_ps
+    #define fas_vec_add _mm_add_ps
+    #define fas_vec_sub _mm_sub_ps
+    #define fas_vec_mul _mm_mul_ps
+#endif
+#elif defined(FAS_ADDITIVE_NEON)
+    typedef float32x4_t fas_vec;
+    #define FAS_VEC_LANES 4
+    #define fas_vec_load vld1q_f32
+    #define fas_vec_store vst1q_f32
+    #define fas_vec_set1 vdupq_n_f32
+    #define fas_vec_add vaddq_f32
+    #define fas_vec_sub vsubq_f32
+    #define fas_vec_mul vmulq_f32
+#endif
+
+struct _additive_bank *createAdditiveBanks(unsigned int n, unsigned int max_instruments) {
+    struct _additive_bank *banks = (struct _additive_bank *)calloc(max_instruments, sizeof(struct _additive_bank));
+
+    if (banks == NULL) {
+        printf("createAdditiveBanks alloc. error.");
+        fflush(stdout);
+        return NULL;
+    }
+
+    // room for all rows + padding
+    unsigned int capacity = ((n + FAS_ADDITIVE_LANES - 1) / FAS_ADDITIVE_LANES) * FAS_ADDITIVE_LANES;
+    if (capacity == 0) {
+        capacity = FAS_ADDITIVE_LANES;
+    }
+
+    unsigned int k = 0;
+    for (k = 0; k < max_instruments; k += 1) {
+        struct _additive_bank *bank = &banks[k];
+
+        bank->osc_index = (unsigned int *)calloc(capacity, sizeof(unsigned int));
+
+#ifdef MAGIC_CIRCLE
+        bank->eps = (FAS_FLOAT *)calloc(capacity, sizeof(FAS_FLOAT));
+        bank->x = (FAS_FLOAT *)calloc(capacity, sizeof(FAS_FLOAT));
+        bank->y = (FAS_FLOAT *)calloc(capacity, sizeof(FAS_FLOAT));
+#else
+        bank->phase_index = (FAS_FLOAT *)calloc(capacity, sizeof(FAS_FLOAT));
+        bank->phase_step = (FAS_FLOAT *)calloc(capacity, sizeof(FAS_FLOAT));
+#endif
+
+        bank->pvl = (FAS_FLOAT *)calloc(capacity, sizeof(FAS_FLOAT));
+        bank->pvr = (FAS_FLOAT *)calloc(capacity, sizeof(FAS_FLOAT));
+        bank->dvl = (FAS_FLOAT *)calloc(capacity, sizeof(FAS_FLOAT));
+        bank->dvr = (FAS_FLOAT *)calloc(capacity, sizeof(FAS_FLOAT));
+
+        if (bank->osc_index == NULL ||
+#ifdef MAGIC_CIRCLE
+            bank->eps == NULL || bank->x == NULL || bank->y == NULL ||
+#else
+            bank->phase_index == NULL || bank->phase_step == NULL ||
+#endif
+            bank->pvl == NULL || bank->pvr == NULL || bank->dvl == NULL || bank->dvr == NULL) {
+            printf("createAdditiveBanks alloc. error.");
+            fflush(stdout);
+
+            // banks are zero initialized so that partially allocated banks can be freed
+            return freeAdditiveBanks(&banks, max_instruments);
+        }
+    }
+
+    return banks;
+}
+
+void sliceAdditiveBank(struct _additive_bank *bank, unsigned int offset, struct _additive_bank *slice) {
+    slice->count = 0;
+    slice->partials = 0;
+
+    slice->osc_index = &bank->osc_index[offset];
+
+#ifdef MAGIC_CIRCLE
+    slice->eps = &bank->eps[offset];
+    slice->x = &bank->x[offset];
+    slice->y = &bank->y[offset];
+#else
+    slice->phase_index = &bank->phase_index[offset];
+    slice->phase_step = &bank->phase_step[offset];
+#endif
+
+    slice->pvl = &bank->pvl[offset];
+    slice->pvr = &bank->pvr[offset];
+    slice->dvl = &bank->dvl[offset];
+    slice->dvr = &bank->dvr[offset];
+}
+
+void padAdditiveBank(struct _additive_bank *bank) {
+    unsigned int p = bank->partials;
+
+    bank->count = ((p + FAS_ADDITIVE_LANES - 1) / FAS_ADDITIVE_LANES) * FAS_ADDITIVE_LANES;
+
+    for (; p < bank->count; p += 1) {
+#ifdef MAGIC_CIRCLE
+        bank->eps[p] = 0;
+        bank->x[p] = 0;
+        bank->y[p] = 0;
+#else
+        bank->phase_index[p] = 0;
+        bank->phase_step[p] = 0;
+#endif
+        bank->pvl[p] = 0;
+        bank->pvr[p] = 0;
+        bank->dvl[p] = 0;
+        bank->dvr[p] = 0;
+    }
+}
+
+#ifdef MAGIC_CIRCLE
+static void computeMagicCircle(struct _additive_bank *bank, FAS_FLOAT *lerp_t, unsigned int len, FAS_FLOAT *out_l, FAS_FLOAT *out_r) {
+    unsigned int p, b;
+
+#ifdef FAS_VEC_LANES
+    unsigned int w;
+
+    // per sample partial sums; reduced once at the end
+    fas_vec acc_l[FAS_BLOCK_SIZE];
+    fas_vec acc_r[FAS_BLOCK_SIZE];
+
+    FAS_FLOAT lanes_l[FAS_VEC_LANES];
+    FAS_FLOAT lanes_r[FAS_VEC_LANES];
+
+    for (b = 0; b < len; b += 1) {
+        acc_l[b] = fas_vec_set1(0);
+        acc_r[b] = fas_vec_set1(0);
+    }
+
+    for (p = 0; p < bank->count; p += FAS_VEC_LANES) {
+        fas_vec eps = fas_vec_load(&bank->eps[p]);
+        fas_vec x = fas_vec_load(&bank->x[p]);
+        fas_vec y = fas_vec_load(&bank->y[p]);
+
+        fas_vec pvl = fas_vec_load(&bank->pvl[p]);
+        fas_vec pvr = fas_vec_load(&bank->pvr[p]);
+        fas_vec dvl = fas_vec_load(&bank->dvl[p]);
+        fas_vec dvr = fas_vec_load(&bank->dvr[p]);
+
+        for (b = 0; b < len; b += 1) {
+            x = fas_vec_add(x, fas_vec_mul(eps, y));
+            y = fas_vec_sub(y, fas_vec_mul(eps, x));
+
+            fas_vec t = fas_vec_set1(lerp_t[b]);
+
+            fas_vec vl = fas_vec_add(pvl, fas_vec_mul(dvl, t));
+            fas_vec vr = fas_vec_add(pvr, fas_vec_mul(dvr, t));
+
+            acc_l[b] = fas_vec_add(acc_l[b], fas_vec_mul(vl, y));
+            acc_r[b] = fas_vec_add(acc_r[b], fas_vec_mul(vr, y));
+        }
+
+        fas_vec_store(&bank->x[p], x);
+        fas_vec_store(&bank->y[p], y);
+    }
+
+    for (b = 0; b < len; b += 1) {
+        fas_vec_store(lanes_l, acc_l[b]);
+        fas_vec_store(lanes_r, acc_r[b]);
+
+        FAS_FLOAT sl = 0, sr = 0;
+        for (w = 0; w < FAS_VEC_LANES; w += 1) {
+            sl += lanes_l[w];
+            sr += lanes_r[w];
+        }
+
+        out_l[b] += sl;
+        out_r[b] += sr;
+    }
+#else
+    for (p = 0; p < bank->partials; p += 1) {
+        FAS_FLOAT eps = bank->eps[p];
+        FAS_FLOAT x = bank->x[p];
+        FAS_FLOAT y = bank->y[p];
+
+        for (b = 0; b < len; b += 1) {
+            x = x + eps * y;
+            y = -eps * x + y;
+
+            FAS_FLOAT vl = bank->pvl[p] + bank->dvl[p] * lerp_t[b];
+            FAS_FLOAT vr = bank->pvr[p] + bank->dvr[p] * lerp_t[b];
+
+            out_l[b] += vl * y;
+            out_r[b] += vr * y;
+        }
+
+        bank->x[p] = x;
+        bank->y[p] = y;
+    }
+#endif
+}
+#else
+static void computeWavetable(struct _additive_bank *bank, FAS_FLOAT *wavetable, unsigned int wavetable_size, FAS_FLOAT *lerp_t, unsigned int len, FAS_FLOAT *out_l, FAS_FLOAT *out_r) {
+    unsigned int p, b;
+
+    FAS_FLOAT size = wavetable_size;
+
+    // note : table lookups are scalar (no gather on SSE / NEON)
+    for (p = 0; p < bank->partials; p += 1) {
+        FAS_FLOAT phase_index = bank->phase_index[p];
+        FAS_FLOAT phase_step = bank->phase_step[p];
+
+        for (b = 0; b < len; b += 1) {
+            // linear interpolation sampling
+            int phase_index1 = (int)phase_index;
+
+            FAS_FLOAT smp1 = wavetable[phase_index1];
+            FAS_FLOAT smp2 = wavetable[phase_index1 + 1];
+
+            FAS_FLOAT mu = phase_index - (FAS_FLOAT)phase_index1;
+
+            FAS_FLOAT smp = smp1 + mu * (smp2 - smp1);
+
+            FAS_FLOAT vl = bank->pvl[p] + bank->dvl[p] * lerp_t[b];
+            FAS_FLOAT vr = bank->pvr[p] + bank->dvr[p] * lerp_t[b];
+
+            out_l[b] += vl * smp;
+            out_r[b] += vr * smp;
+
+            phase_index += phase_step;
+            while (phase_index >= size) {
+                phase_index -= size;
+            }
+        }
+
+        bank->phase_index[p] = phase_index;
+    }
+}
+#endif
+
+void computeAdditiveBank(struct _additive_bank *bank, FAS_FLOAT *wavetable, unsigned int wavetable_size, FAS_FLOAT *lerp_t, unsigned int len, FAS_FLOAT *out_l, FAS_FLOAT *out_r) {
+#ifdef MAGIC_CIRCLE
+    // wavetable is only used by the wavetable variant
+    (void)wavetable;
+    (void)wavetable_size;
+
+    computeMagicCircle(bank, lerp_t, len, out_l, out_r);
+#else
+    computeWavetable(bank, wavetable, wavetable_size, lerp_t, len, out_l, out_r);
+#endif
+}
+
+struct _additive_bank *freeAdditiveBanks(struct _additive_bank **b, unsigned int max_instruments) {
+    struct _additive_bank *banks = *b;
+
+    if (banks == NULL) {
+        return NULL;
+    }
+
+    unsigned int k = 0;
+    for (k = 0; k < max_instruments; k += 1) {
+        struct _additive_bank *bank = &banks[k];
+
+        free(bank->osc_index);
+
+#ifdef MAGIC_CIRCLE
+        free(bank->eps);
+        free(bank->x);
+        free(bank->y);
+#else
+        free(bank->phase_index);
+        free(bank->phase_step);
+#endif
+
+        free(bank->pvl);
+        free(bank->pvr);
+        free(bank->dvl);
+        free(bank->dvr);
+    }
+
+    free(banks);
+
+    *b = NULL;
+
+    return NULL;
+}
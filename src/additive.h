@@ -0,0 +1,72 @@
+#ifndef _FAS_ADDITIVE_H_
+#define _FAS_ADDITIVE_H_
+
+    #include <stdlib.h>
+
+    #include "constants.h"
+
+    // SIMD kernel selection (USE_SSE / USE_NEON build options)
+#if defined(USE_SSE) && defined(__AVX__)
+    #include <immintrin.h>
+
+    #define FAS_ADDITIVE_AVX
+#elif defined(USE_SSE) && defined(__SSE2__)
+    #include <emmintrin.h>
+
+    #define FAS_ADDITIVE_SSE
+#elif defined(USE_NEON) && (defined(__ARM_NEON) || defined(__NEON__)) && !defined(USE_DOUBLE)
+    #include <arm_neon.h>
+
+    #define FAS_ADDITIVE_NEON
+#endif
+
+    // packed partials count is always a multiple of this (largest supported vector width)
+    #define FAS_ADDITIVE_LANES 16
+
+    /**
+     * packed (structure of arrays) copy of an additive instrument active partials
+     * it is filled on each audio block, processed by computeAdditiveBank then oscillators state is written back
+     **/
+    struct _additive_bank {
+        // packed partials count (including zero padding up to FAS_ADDITIVE_LANES)
+        unsigned int count;
+        // actual partials count
+        unsigned int partials;
+
+        // oscillator (row) index of each packed partials
+        unsigned int *osc_index;
+
+#ifdef MAGIC_CIRCLE
+        FAS_FLOAT *eps;
+        FAS_FLOAT *x;
+        FAS_FLOAT *y;
+#else
+        FAS_FLOAT *phase_index;
+        FAS_FLOAT *phase_step;
+#endif
+
+        // volume ramp : previous_volume + diff_volume * lerp_t
+        FAS_FLOAT *pvl, *pvr;
+        FAS_FLOAT *dvl, *dvr;
+    };
+
+    extern struct _additive_bank *createAdditiveBanks(unsigned int n, unsigned int max_instruments);
+
+    /**
+     * make slice a view of bank starting at packed partial offset (multiple of FAS_ADDITIVE_LANES); used to pack / compute disjoint ranges of partials concurrently
+     **/
+    extern void sliceAdditiveBank(struct _additive_bank *bank, unsigned int offset, struct _additive_bank *slice);
+
+    /**
+     * pad the packed partials with silent partials up to a multiple of FAS_ADDITIVE_LANES
+     **/
+    extern void padAdditiveBank(struct _additive_bank *bank);
+
+    /**
+     * accumulate len samples of all packed partials into out_l / out_r; lerp_t hold the volume interpolation factor of each samples
+     **/
+    extern void computeAdditiveBank(struct _additive_bank *bank, FAS_FLOAT *wavetable, unsigned int wavetable_size, FAS_FLOAT *lerp_t, unsigned int len, FAS_FLOAT *out_l, FAS_FLOAT *out_r);
+
+    extern struct _additive_bank *freeAdditiveBanks(struct _additive_bank **banks, unsigned int max_instruments);
+
+#endif
@@ -28,6 +28,11 @@
     #define ACTION 5
     #define INSTRUMENT_SETTINGS 6
 
+    // bank settings frame data type flags
+    #define FAS_FRAME_DATA_FLOAT 1
+    #define FAS_FRAME_DATA_SPARSE 2
+    #define FAS_FRAME_DATA_HALF 4 // IEEE half float, take precedence over FAS_FRAME_DATA_FLOAT
+
     // actions
     #define FAS_ACTION_SAMPLES_RELOAD 0
     #define FAS_ACTION_NOTE_RESET 1
@@ -42,6 +47,23 @@
 
     #define FAS_EASING_COUNT 32
 
+    // audio callback buffer is rendered by blocks of (at most) this amount of samples
+    #define FAS_BLOCK_SIZE 128
+
+    // oscillators per instrument state is aligned on cache lines
+    #define FAS_CACHE_LINE_SIZE 64
+
+    // oscillators generic parameters count (fp1 ... fp4)
+    #define FAS_OSC_PARAMS 6
+
+    // workers pool; busy-wait iterations before yielding then sleeping (ns) when idle
+    #define FAS_WORKERS_SPIN 16384
+    #define FAS_WORKERS_SLEEP_NS 100000
+
+    // frames decoding threads; yield iterations before sleeping (ns) when idle
+    #define FAS_DECODER_SPIN 1024
+    #define FAS_DECODER_SLEEP_NS 100000
+
     // program settings constants
     #define FAS_SAMPLE_RATE 44100
     #define FAS_FRAMES_PER_BUFFER 0
@@ -62,9 +84,19 @@
     #define FAS_AUDIO 1
     #define FAS_SMOOTH_FACTOR 1.0
     #define FAS_GRANULAR_MAX_DENSITY 32
+    #define FAS_GRANULAR_MAX_GRAINS 4096 // active grains per instrument
     #define FAS_STREAM_INFOS_SEND_DELAY 2
     #define FAS_MAX_DROP 60 // 1 second
     #define FAS_RENDER_WIDTH 4096
+    #define FAS_WORKERS 0
+    #define FAS_DECODERS 1
+    #define FAS_PARTITION_THRESHOLD 512
+    #define FAS_LOOKAHEAD 0
+    #define FAS_RAND_SEED 0 // 0 : time based seed
+    #define FAS_FAUST_MAX_OPTIONS 32 // max. Faust compiler arguments
+    #define FAS_FAUST_POLYPHONY 64 // Faust generators instances per DSP file
+    #define FAS_PARTIAL_CONV_PART_LEN 2048 // additive partials convolution partition length (and latency)
+    #define FAS_PARTIAL_CONV_POLYPHONY 64 // additive partials convolvers (simultaneous convolution partials of all instruments)
 
     // limit max. frequency for filters & some soundpipe effects (eq etc.), this is in percent of Nyquist frequency
     #define FAS_FREQ_LIMIT_FACTOR 0.75 // ~36.0kHz for 96kHz sampling rate
@@ -81,6 +113,12 @@
     #define FAS_CMD_CHN_FX_SETTINGS 3
     #define FAS_CMD_INSTRUMENT_SETTINGS 4
 
+    // Faust reload states (background build then swap by the audio thread)
+    #define FAS_FAUST_RELOAD_IDLE 0
+    #define FAS_FAUST_RELOAD_BUILDING 1
+    #define FAS_FAUST_RELOAD_READY 2
+    #define FAS_FAUST_RELOAD_SWAPPED 3
+
     // audio thread states
     #define FAS_AUDIO_PLAY 0
     #define FAS_AUDIO_PAUSE 1
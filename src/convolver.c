@@ -0,0 +1,405 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "convolver.h"
+#include "afSTFT/fft4g.h"
+
+struct _fas_conv_kernels *createConvolutionKernels(struct sample *impulses, unsigned int count, unsigned int part_len) {
+    struct _fas_conv_kernels *kernels = (struct _fas_conv_kernels *)calloc(1, sizeof(struct _fas_conv_kernels));
+
+    if (kernels == NULL) {
+        printf("createConvolutionKernels alloc. error.");
+        fflush(stdout);
+        return NULL;
+    }
+
+    unsigned int n2 = part_len * 2;
+
+    kernels->part_len = part_len;
+    kernels->max_partitions = 1;
+
+    kernels->ip = (int *)calloc(2 + (int)sqrt(n2 / 2) + 1, sizeof(int));
+    kernels->w = (float *)calloc(n2 / 2, sizeof(float));
+    kernels->kernels = (struct _fas_conv_kernel *)calloc(count > 0 ? count : 1, sizeof(struct _fas_conv_kernel));
+
+    float *work = (float *)calloc(n2, sizeof(float));
+
+    if (kernels->ip == NULL || kernels->w == NULL || kernels->kernels == NULL || work == NULL) {
+        printf("createConvolutionKernels alloc. error.");
+        fflush(stdout);
+
+        free(work);
+        return freeConvolutionKernels(&kernels);
+    }
+
+    // FFT tables initialization (done on first call)
+    kernels->ip[0] = 0;
+    rdft(n2, 1, work, kernels->ip, kernels->w);
+
+    unsigned int i = 0, p = 0;
+    for (i = 0; i < count; i += 1) {
+        struct sample *smp = &impulses[i];
+        struct _fas_conv_kernel *kernel = &kernels->kernels[i];
+
+        unsigned int partitions = (smp->frames + part_len - 1) / part_len;
+        if (partitions == 0) {
+            partitions = 1;
+        }
+
+        kernel->spectra = (float *)calloc(partitions * n2, sizeof(float));
+        if (kernel->spectra == NULL) {
+            printf("createConvolutionKernels alloc. error.");
+            fflush(stdout);
+
+            free(work);
+            return freeConvolutionKernels(&kernels);
+        }
+
+        kernel->partitions = partitions;
+
+        for (p = 0; p < partitions; p += 1) {
+            float *spectrum = &kernel->spectra[p * n2];
+
+            unsigned int j = 0;
+            for (j = 0; j < part_len; j += 1) {
+                unsigned int index = p * part_len + j;
+
+                spectrum[j] = (index < smp->frames) ? smp->data_l[index] : 0;
+            }
+
+            rdft(n2, 1, spectrum, kernels->ip, kernels->w);
+        }
+
+        if (partitions > kernels->max_partitions) {
+            kernels->max_partitions = partitions;
+        }
+
+        kernels->count += 1;
+    }
+
+    free(work);
+
+    return kernels;
+}
+
+struct _fas_conv_kernels *freeConvolutionKernels(struct _fas_conv_kernels **k) {
+    struct _fas_conv_kernels *kernels = *k;
+
+    if (kernels == NULL) {
+        return NULL;
+    }
+
+    if (kernels->kernels) {
+        unsigned int i = 0;
+        for (i = 0; i < kernels->count; i += 1) {
+            free(kernels->kernels[i].spectra);
+        }
+
+        free(kernels->kernels);
+    }
+
+    free(kernels->ip);
+    free(kernels->w);
+    free(kernels);
+
+    *k = NULL;
+
+    return NULL;
+}
+
+struct _fas_convolver *createConvolver(struct _fas_conv_kernels *kernels) {
+    if (kernels == NULL) {
+        return NULL;
+    }
+
+    struct _fas_convolver *conv = (struct _fas_convolver *)calloc(1, sizeof(struct _fas_convolver));
+    if (conv == NULL) {
+        printf("createConvolver alloc. error.");
+        fflush(stdout);
+        return NULL;
+    }
+
+    unsigned int n = kernels->part_len;
+
+    conv->kernels = kernels;
+    conv->part_len = n;
+    conv->max_partitions = kernels->max_partitions;
+
+    conv->history = (float *)calloc(conv->max_partitions * n * 2, sizeof(float));
+    conv->input = (float *)calloc(n, sizeof(float));
+    conv->output = (float *)calloc(n, sizeof(float));
+    conv->overlap = (float *)calloc(n, sizeof(float));
+    conv->work = (float *)calloc(n * 2, sizeof(float));
+
+    if (conv->history == NULL || conv->input == NULL || conv->output == NULL || conv->overlap == NULL || conv->work == NULL) {
+        printf("createConvolver alloc. error.");
+        fflush(stdout);
+
+        return freeConvolver(&conv);
+    }
+
+    return conv;
+}
+
+void setConvolverKernel(struct _fas_convolver *conv, struct _fas_conv_kernel *kernel) {
+    conv->kernel = kernel;
+
+    // history is cleared lazily; only spectra computed after this call are used
+    conv->filled = 0;
+    conv->pos = 0;
+
+    memset(conv->input, 0, sizeof(float) * conv->part_len);
+    memset(conv->output, 0, sizeof(float) * conv->part_len);
+    memset(conv->overlap, 0, sizeof(float) * conv->part_len);
+}
+
+void processConvolverBlock(struct _fas_convolver *conv) {
+    struct _fas_conv_kernel *kernel = conv->kernel;
+
+    unsigned int n = conv->part_len;
+    unsigned int n2 = n * 2;
+    unsigned int i = 0, p = 0;
+
+    conv->pos = 0;
+
+    if (kernel == NULL) {
+        memset(conv->output, 0, sizeof(float) * n);
+
+        return;
+    }
+
+    int *ip = conv->kernels->ip;
+    float *w = conv->kernels->w;
+
+    // transform the zero padded input block into the history
+    float *spectrum = &conv->history[conv->head * n2];
+
+    memcpy(spectrum, conv->input, sizeof(float) * n);
+    memset(&spectrum[n], 0, sizeof(float) * n);
+
+    rdft(n2, 1, spectrum, ip, w);
+
+    if (conv->filled < conv->max_partitions) {
+        conv->filled += 1;
+    }
+
+    unsigned int partitions = kernel->partitions;
+    if (partitions > conv->filled) {
+        partitions = conv->filled;
+    }
+
+    // spectra multiply-accumulate; first two values are DC and Nyquist (real) then real / imaginary pairs
+    float *acc = conv->work;
+    memset(acc, 0, sizeof(float) * n2);
+
+    unsigned int index = conv->head;
+    for (p = 0; p < partitions; p += 1) {
+        float *x = &conv->history[index * n2];
+        float *h = &kernel->spectra[p * n2];
+
+        acc[0] += x[0] * h[0];
+        acc[1] += x[1] * h[1];
+
+        for (i = 2; i < n2; i += 2) {
+            acc[i] += x[i] * h[i] - x[i + 1] * h[i + 1];
+            acc[i + 1] += x[i] * h[i + 1] + x[i + 1] * h[i];
+        }
+
+        index = (index == 0) ? conv->max_partitions - 1 : index - 1;
+    }
+
+    rdft(n2, -1, acc, ip, w);
+
+    // inverse transform is scaled by n2 / 2; overlap-add with the previous block tail
+    float scale = 2.0f / n2;
+    for (i = 0; i < n; i += 1) {
+        conv->output[i] = acc[i] * scale + conv->overlap[i];
+        conv->overlap[i] = acc[n + i] * scale;
+    }
+
+    conv->head = (conv->head + 1) % conv->max_partitions;
+}
+
+struct _fas_convolver *freeConvolver(struct _fas_convolver **c) {
+    struct _fas_convolver *conv = *c;
+
+    if (conv == NULL) {
+        return NULL;
+    }
+
+    free(conv->history);
+    free(conv->input);
+    free(conv->output);
+    free(conv->overlap);
+    free(conv->work);
+    free(conv);
+
+    *c = NULL;
+
+    return NULL;
+}
+
+struct _fas_conv_voices *createConvolverVoices(struct _fas_conv_kernels *kernels, unsigned int polyphony) {
+    if (kernels == NULL || polyphony == 0) {
+        return NULL;
+    }
+
+    struct _fas_conv_voices *voices = (struct _fas_conv_voices *)calloc(1, sizeof(struct _fas_conv_voices));
+    if (voices == NULL) {
+        printf("createConvolverVoices alloc. error.");
+        fflush(stdout);
+        return NULL;
+    }
+
+    voices->polyphony = polyphony;
+
+    voices->voices = (struct _fas_conv_voice *)calloc(polyphony, sizeof(struct _fas_conv_voice));
+    voices->free_voices = (unsigned int *)calloc(polyphony, sizeof(unsigned int));
+
+    if (voices->voices == NULL || voices->free_voices == NULL) {
+        printf("createConvolverVoices alloc. error.");
+        fflush(stdout);
+
+        return freeConvolverVoices(&voices);
+    }
+
+    unsigned int i = 0;
+    for (i = 0; i < polyphony; i += 1) {
+        struct _fas_conv_voice *voice = &voices->voices[i];
+
+        voice->owner = -1;
+
+        voice->conv = createConvolver(kernels);
+        if (voice->conv == NULL) {
+            return freeConvolverVoices(&voices);
+        }
+
+        voices->free_voices[i] = i;
+    }
+
+    voices->free_count = polyphony;
+
+    return voices;
+}
+
+static void releaseConvolverVoice(struct _fas_conv_voices *voices, unsigned int index) {
+    struct _fas_conv_voice *voice = &voices->voices[index];
+
+    if (voice->owner < 0) {
+        return;
+    }
+
+    voices->assigned[voice->owner] = 0;
+    voice->owner = -1;
+
+    voices->free_voices[voices->free_count] = index;
+    voices->free_count += 1;
+}
+
+int setConvolverVoicesBank(struct _fas_conv_voices *voices, unsigned int n, unsigned int max_instruments) {
+    if (voices == NULL) {
+        return 0;
+    }
+
+    unsigned int i = 0;
+    if (voices->assigned) {
+        for (i = 0; i < voices->polyphony; i += 1) {
+            releaseConvolverVoice(voices, i);
+        }
+
+        free(voices->assigned);
+    }
+
+    voices->rows = n;
+    voices->max_instruments = max_instruments;
+
+    voices->assigned = (unsigned int *)calloc(n * max_instruments, sizeof(unsigned int));
+    if (voices->assigned == NULL) {
+        printf("setConvolverVoicesBank alloc. error.");
+        fflush(stdout);
+
+        voices->rows = 0;
+
+        return -1;
+    }
+
+    return 0;
+}
+
+struct _fas_convolver *acquireConvolverVoice(struct _fas_conv_voices *voices, struct _fas_conv_kernel *kernel, unsigned int instrument, unsigned int row) {
+    if (voices == NULL || voices->assigned == NULL || row >= voices->rows || instrument >= voices->max_instruments) {
+        return NULL;
+    }
+
+    unsigned int owner = instrument * voices->rows + row;
+    unsigned int v = voices->assigned[owner];
+
+    if (v) {
+        struct _fas_conv_voice *voice = &voices->voices[v - 1];
+
+        voice->stamp = voices->stamp;
+
+        return voice->conv;
+    }
+
+    if (voices->free_count == 0) {
+        return NULL;
+    }
+
+    voices->free_count -= 1;
+
+    unsigned int index = voices->free_voices[voices->free_count];
+
+    struct _fas_conv_voice *voice = &voices->voices[index];
+    voice->owner = owner;
+    voice->stamp = voices->stamp;
+
+    voices->assigned[owner] = index + 1;
+
+    // note-on : previous note tail is not heard
+    setConvolverKernel(voice->conv, kernel);
+
+    return voice->conv;
+}
+
+void releaseConvolverVoices(struct _fas_conv_voices *voices) {
+    if (voices == NULL) {
+        return;
+    }
+
+    unsigned int i = 0;
+    for (i = 0; i < voices->polyphony; i += 1) {
+        struct _fas_conv_voice *voice = &voices->voices[i];
+
+        if (voice->owner >= 0 && voice->stamp != voices->stamp) {
+            releaseConvolverVoice(voices, i);
+        }
+    }
+
+    voices->stamp += 1;
+}
+
+struct _fas_conv_voices *freeConvolverVoices(struct _fas_conv_voices **v) {
+    struct _fas_conv_voices *voices = *v;
+
+    if (voices == NULL) {
+        return NULL;
+    }
+
+    unsigned int i = 0;
+    if (voices->voices) {
+        for (i = 0; i < voices->polyphony; i += 1) {
+            freeConvolver(&voices->voices[i].conv);
+        }
+    }
+
+    free(voices->voices);
+    free(voices->free_voices);
+    free(voices->assigned);
+    free(voices);
+
+    *v = NULL;
+
+    return NULL;
+}
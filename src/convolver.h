@@ -0,0 +1,158 @@
+#ifndef _FAS_CONVOLVER_H_
+#define _FAS_CONVOLVER_H_
+
+    #include <stdlib.h>
+
+    #include "constants.h"
+    #include "samples.h"
+
+    /**
+     * uniformly partitioned convolution; impulses are split into partitions of part_len samples which are transformed once on load
+     * a convolver hold its input spectra history and switch impulse by pointing to another kernel so it never allocate once created
+     **/
+    struct _fas_conv_kernel {
+        unsigned int partitions;
+        // partitions spectra, part_len * 2 values each (Ooura rdft packing)
+        float *spectra;
+    };
+
+    struct _fas_conv_kernels {
+        unsigned int count;
+        unsigned int part_len;
+        // longest kernel partitions count (convolvers history size)
+        unsigned int max_partitions;
+
+        struct _fas_conv_kernel *kernels;
+
+        // FFT tables (part_len * 2 points); read only once initialized so they are shared by all convolvers
+        int *ip;
+        float *w;
+    };
+
+    struct _fas_convolver {
+        struct _fas_conv_kernels *kernels;
+        struct _fas_conv_kernel *kernel;
+
+        unsigned int part_len;
+        unsigned int max_partitions;
+
+        // input spectra ring buffer; head is the most recent spectrum, filled the number of spectra since the last kernel change
+        float *history;
+        unsigned int head;
+        unsigned int filled;
+
+        // current input / output blocks, position into them and overlapping part of the previous output block
+        float *input;
+        float *output;
+        float *overlap;
+        unsigned int pos;
+
+        // spectra accumulator
+        float *work;
+    };
+
+    /**
+     * transform all impulses (left channel); return NULL on allocation error
+     **/
+    extern struct _fas_conv_kernels *createConvolutionKernels(struct sample *impulses, unsigned int count, unsigned int part_len);
+    extern struct _fas_conv_kernels *freeConvolutionKernels(struct _fas_conv_kernels **kernels);
+
+    /**
+     * a convolver is tied to a kernels set (FFT tables, history size) and must be created again when the set change
+     **/
+    extern struct _fas_convolver *createConvolver(struct _fas_conv_kernels *kernels);
+    extern struct _fas_convolver *freeConvolver(struct _fas_convolver **conv);
+
+    /**
+     * switch impulse and clear the convolver history; kernel can be NULL (silence)
+     **/
+    extern void setConvolverKernel(struct _fas_convolver *conv, struct _fas_conv_kernel *kernel);
+
+    extern void processConvolverBlock(struct _fas_convolver *conv);
+
+    // convolver of the convolvers pool
+    struct _fas_conv_voice {
+        struct _fas_convolver *conv;
+
+        // assigned (instrument, row) as instrument * rows + row, -1 when free
+        int owner;
+        // frame of the last note played by this convolver
+        unsigned int stamp;
+    };
+
+    /**
+     * convolvers pool; polyphony convolvers (sized to the longest impulse) are assigned to an (instrument, row) pair on note-on (notes preprocessing)
+     * and recycled once the note is not part of a frame anymore so that memory does not depend on the bank height
+     **/
+    struct _fas_conv_voices {
+        struct _fas_conv_voice *voices;
+        unsigned int polyphony;
+
+        // free voices stack (indexes into voices)
+        unsigned int *free_voices;
+        unsigned int free_count;
+
+        // assigned voice index + 1 of each (instrument, row), 0 when none
+        unsigned int *assigned;
+        unsigned int rows;
+        unsigned int max_instruments;
+
+        unsigned int stamp;
+    };
+
+    /**
+     * polyphony convolvers of a kernels set; must be created again when the set change, return NULL when there is no kernels or on allocation error
+     **/
+    extern struct _fas_conv_voices *createConvolverVoices(struct _fas_conv_kernels *kernels, unsigned int polyphony);
+
+    /**
+     * (re)allocate voices assignment for a bank of n rows, all voices are released
+     **/
+    extern int setConvolverVoicesBank(struct _fas_conv_voices *voices, unsigned int n, unsigned int max_instruments);
+
+    /**
+     * return the convolver of an (instrument, row) pair for the current frame, a free convolver is assigned (kernel set, history cleared) when there is none
+     * return NULL when the pool is exhausted
+     **/
+    extern struct _fas_convolver *acquireConvolverVoice(struct _fas_conv_voices *voices, struct _fas_conv_kernel *kernel, unsigned int instrument, unsigned int row);
+
+    /**
+     * release voices which were not acquired since the last call then start a new frame
+     **/
+    extern void releaseConvolverVoices(struct _fas_conv_voices *voices);
+
+    extern struct _fas_conv_voices *freeConvolverVoices(struct _fas_conv_voices **voices);
+
+    static inline struct _fas_convolver *getConvolverVoice(struct _fas_conv_voices *voices, unsigned int instrument, unsigned int row) {
+        if (voices == NULL || voices->assigned == NULL) {
+            return NULL;
+        }
+
+        unsigned int v = voices->assigned[instrument * voices->rows + row];
+
+        return v ? voices->voices[v - 1].conv : NULL;
+    }
+
+    static inline struct _fas_conv_kernel *getConvolutionKernel(struct _fas_conv_kernels *kernels, unsigned int index) {
+        if (kernels == NULL || kernels->count == 0) {
+            return NULL;
+        }
+
+        return &kernels->kernels[index % kernels->count];
+    }
+
+    // one sample in / out; output is delayed by part_len samples
+    static inline FAS_FLOAT computeConvolver(struct _fas_convolver *conv, FAS_FLOAT in) {
+        FAS_FLOAT out = conv->output[conv->pos];
+
+        conv->input[conv->pos] = in;
+        conv->pos += 1;
+
+        if (conv->pos == conv->part_len) {
+            processConvolverBlock(conv);
+        }
+
+        return out;
+    }
+
+#endif
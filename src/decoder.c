@@ -0,0 +1,339 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <sched.h>
+#include <time.h>
+
+#include "decoder.h"
+
+static void waitDecoder() {
+    struct timespec ts = { 0, FAS_DECODER_SLEEP_NS };
+    nanosleep(&ts, NULL);
+}
+
+static void releasePacket(struct _fas_decoder_packet *packet) {
+    atomic_fetch_sub_explicit(&packet->refs, 1, memory_order_release);
+}
+
+static void processJob(struct _fas_decoder *decoder, struct _fas_decoder_job *job) {
+    decoder->prepare(job, decoder->data);
+
+    // the current packet is the previous packet of the next job
+    atomic_store_explicit(&job->curr->prepared, 1, memory_order_release);
+
+    // prepared by the previous job (submitted before so it never wait on this one)
+    while (!atomic_load_explicit(&job->prev->prepared, memory_order_acquire)) {
+        sched_yield();
+    }
+
+    decoder->decode(job, decoder->data);
+
+    // outputs are committed in submission order
+    while (atomic_load_explicit(&decoder->committed, memory_order_acquire) != job->sequence) {
+        sched_yield();
+    }
+
+    decoder->commit(job->output, decoder->data);
+
+    releasePacket(job->prev);
+    releasePacket(job->curr);
+
+    atomic_store_explicit(&decoder->committed, job->sequence + 1, memory_order_release);
+}
+
+static void *decoderThread(void *args) {
+    struct _fas_decoder_thread *thread = (struct _fas_decoder_thread *)args;
+    struct _fas_decoder *decoder = thread->decoder;
+
+    unsigned int mask = decoder->queue_size - 1;
+    unsigned int idle = 0;
+
+    while (!atomic_load_explicit(&decoder->quit, memory_order_relaxed)) {
+        unsigned int read_position = atomic_load_explicit(&thread->read_position, memory_order_relaxed);
+        unsigned int write_position = atomic_load_explicit(&thread->write_position, memory_order_acquire);
+
+        if (read_position == write_position) {
+            // yield first (frames usually come in bursts) then sleep
+            idle += 1;
+
+            if (idle < FAS_DECODER_SPIN) {
+                sched_yield();
+            } else {
+                waitDecoder();
+            }
+
+            continue;
+        }
+
+        idle = 0;
+
+        // the job slot stay reserved until it is done so that packets pool bound hold
+        processJob(decoder, &thread->jobs[read_position & mask]);
+
+        atomic_store_explicit(&thread->read_position, read_position + 1, memory_order_release);
+    }
+
+    return NULL;
+}
+
+struct _fas_decoder *createDecoder(unsigned int count, unsigned int queue_size, fas_decoder_prepare prepare, fas_decoder_decode decode, fas_decoder_commit commit, void *data) {
+    struct _fas_decoder *decoder = (struct _fas_decoder *)calloc(1, sizeof(struct _fas_decoder));
+    if (decoder == NULL) {
+        printf("createDecoder alloc. error.");
+        fflush(stdout);
+        return NULL;
+    }
+
+    // power of two jobs rings
+    unsigned int capacity = 1;
+    while (capacity < queue_size) {
+        capacity <<= 1;
+    }
+
+    decoder->queue_size = capacity;
+    decoder->prepare = prepare;
+    decoder->decode = decode;
+    decoder->commit = commit;
+    decoder->data = data;
+
+    atomic_init(&decoder->committed, 0);
+    atomic_init(&decoder->quit, 0);
+
+    decoder->threads = (struct _fas_decoder_thread *)calloc(count > 0 ? count : 1, sizeof(struct _fas_decoder_thread));
+    if (decoder->threads == NULL) {
+        printf("createDecoder alloc. error.");
+        fflush(stdout);
+
+        free(decoder);
+        return NULL;
+    }
+
+    decoder->threads[0].decoder = decoder;
+
+    unsigned int i = 0;
+    for (i = 0; i < count; i += 1) {
+        struct _fas_decoder_thread *thread = &decoder->threads[i];
+
+        thread->decoder = decoder;
+
+        atomic_init(&thread->write_position, 0);
+        atomic_init(&thread->read_position, 0);
+
+        thread->jobs = (struct _fas_decoder_job *)calloc(capacity, sizeof(struct _fas_decoder_job));
+        if (thread->jobs == NULL) {
+            printf("createDecoder alloc. error.");
+            fflush(stdout);
+
+            return freeDecoder(&decoder);
+        }
+
+        int err = pthread_create(&thread->thread, NULL, &decoderThread, (void *)thread);
+        if (err != 0) {
+            fprintf(stderr, "createDecoder : pthread_create error %i\n", err);
+
+            free(thread->jobs);
+            thread->jobs = NULL;
+
+            return freeDecoder(&decoder);
+        }
+
+        decoder->count = i + 1;
+    }
+
+    return decoder;
+}
+
+static void freeDecoderFrames(struct _fas_decoder *decoder) {
+    unsigned int i = 0;
+
+    if (decoder->packets) {
+        for (i = 0; i < decoder->packets_count; i += 1) {
+            free(decoder->packets[i].data);
+
+            freeSparseFrame(&decoder->packets[i].sparse_frame);
+        }
+
+        free(decoder->packets);
+    }
+
+    decoder->packets = NULL;
+    decoder->packets_count = 0;
+    decoder->last = NULL;
+}
+
+int setDecoderFrames(struct _fas_decoder *decoder, size_t packet_capacity, unsigned int h, unsigned int max_instruments, int sparse) {
+    unsigned int i = 0;
+
+    freeDecoderFrames(decoder);
+
+    if (packet_capacity == 0) {
+        return 0;
+    }
+
+    // each pending job hold its packet, plus the last packet, the oldest previous packet and the one exchanged on submit
+    unsigned int packets_count = decoder->count * decoder->queue_size + 3;
+
+    decoder->packets = (struct _fas_decoder_packet *)calloc(packets_count, sizeof(struct _fas_decoder_packet));
+    if (decoder->packets == NULL) {
+        printf("setDecoderFrames alloc. error.");
+        fflush(stdout);
+        return -1;
+    }
+
+    decoder->packets_count = packets_count;
+
+    for (i = 0; i < packets_count; i += 1) {
+        struct _fas_decoder_packet *packet = &decoder->packets[i];
+
+        atomic_init(&packet->refs, 0);
+        atomic_init(&packet->prepared, 0);
+
+        packet->data = (char *)calloc(packet_capacity, sizeof(char));
+        if (packet->data == NULL) {
+            printf("setDecoderFrames alloc. error.");
+            fflush(stdout);
+
+            freeDecoderFrames(decoder);
+            return -1;
+        }
+
+        packet->capacity = packet_capacity;
+
+        if (sparse) {
+            packet->sparse_frame = createSparseFrame(h, max_instruments);
+            if (packet->sparse_frame == NULL) {
+                freeDecoderFrames(decoder);
+                return -1;
+            }
+        }
+    }
+
+    // empty (zeroed) previous frame, its sparse frame has no active rows
+    decoder->last = &decoder->packets[0];
+
+    atomic_store(&decoder->last->refs, 1);
+    atomic_store(&decoder->last->prepared, 1);
+
+    return 0;
+}
+
+int submitDecoder(struct _fas_decoder *decoder, char **packet, size_t *capacity, size_t len, void *output) {
+    unsigned int i = 0;
+
+    if (decoder->last == NULL) {
+        return -1;
+    }
+
+    struct _fas_decoder_packet *free_packet = NULL;
+    for (i = 0; i < decoder->packets_count; i += 1) {
+        if (atomic_load_explicit(&decoder->packets[i].refs, memory_order_acquire) == 0) {
+            free_packet = &decoder->packets[i];
+            break;
+        }
+    }
+
+    if (free_packet == NULL) {
+        return -1;
+    }
+
+    struct _fas_decoder_thread *thread = NULL;
+    unsigned int write_position = 0;
+    if (decoder->count > 0) {
+        for (i = 0; i < decoder->count; i += 1) {
+            unsigned int index = (decoder->next_thread + i) % decoder->count;
+
+            struct _fas_decoder_thread *t = &decoder->threads[index];
+
+            write_position = atomic_load_explicit(&t->write_position, memory_order_relaxed);
+            if (write_position - atomic_load_explicit(&t->read_position, memory_order_acquire) < decoder->queue_size) {
+                thread = t;
+
+                decoder->next_thread = (index + 1) % decoder->count;
+                break;
+            }
+        }
+
+        if (thread == NULL) {
+            return -1;
+        }
+    }
+
+    // exchange buffers
+    char *data = free_packet->data;
+    size_t data_capacity = free_packet->capacity;
+
+    free_packet->data = *packet;
+    free_packet->capacity = *capacity;
+    free_packet->len = len;
+
+    *packet = data;
+    *capacity = data_capacity;
+
+    // the submitting thread reference on the last packet is handed to the job
+    struct _fas_decoder_job job;
+    job.sequence = decoder->submitted;
+    job.prev = decoder->last;
+    job.curr = free_packet;
+    job.output = output;
+    job.prev_sparse_frame = decoder->last->sparse_frame;
+    job.sparse_frame = free_packet->sparse_frame;
+
+    atomic_store_explicit(&free_packet->refs, 2, memory_order_relaxed);
+    atomic_store_explicit(&free_packet->prepared, 0, memory_order_relaxed);
+
+    decoder->last = free_packet;
+    decoder->submitted += 1;
+
+    if (thread == NULL) {
+        processJob(decoder, &job);
+
+        return 0;
+    }
+
+    thread->jobs[write_position & (decoder->queue_size - 1)] = job;
+
+    atomic_store_explicit(&thread->write_position, write_position + 1, memory_order_release);
+
+    return 0;
+}
+
+void flushDecoder(struct _fas_decoder *decoder) {
+    while (atomic_load_explicit(&decoder->committed, memory_order_acquire) != decoder->submitted) {
+        sched_yield();
+    }
+}
+
+struct _fas_decoder *freeDecoder(struct _fas_decoder **d) {
+    struct _fas_decoder *decoder = *d;
+
+    if (decoder == NULL) {
+        return NULL;
+    }
+
+    // threads may wait on each other commits
+    flushDecoder(decoder);
+
+    atomic_store(&decoder->quit, 1);
+
+    unsigned int i = 0;
+    for (i = 0; i < decoder->count; i += 1) {
+        pthread_join(decoder->threads[i].thread, NULL);
+    }
+
+    freeDecoderFrames(decoder);
+
+    if (decoder->threads) {
+        unsigned int threads = decoder->count > 0 ? decoder->count : 1;
+        for (i = 0; i < threads; i += 1) {
+            free(decoder->threads[i].jobs);
+        }
+
+        free(decoder->threads);
+    }
+
+    free(decoder);
+
+    *d = NULL;
+
+    return NULL;
+}
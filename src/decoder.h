@@ -0,0 +1,134 @@
+#ifndef _FAS_DECODER_H_
+#define _FAS_DECODER_H_
+
+    #include <stddef.h>
+    #include <stdatomic.h>
+    #include <pthread.h>
+
+    #include "constants.h"
+    #include "note.h"
+
+    /**
+     * frame packet slot; buffers are exchanged with the network thread packet buffer (no copy)
+     **/
+    struct _fas_decoder_packet {
+        char *data;
+        size_t len;
+        size_t capacity;
+
+        // holders count (queued jobs as current / previous frame, the network thread as last frame), free when 0
+        atomic_uint refs;
+
+        // decoded sparse frame of this packet (NULL when frames are not sparse), prepared once and reused as the next frame previous frame
+        struct _fas_sparse_frame *sparse_frame;
+
+        atomic_int prepared;
+    };
+
+    /**
+     * decode job; a frame is decoded against the previous submitted frame packet
+     * frames are dropped before submission so that the previous packet is always a frame which reach the commit
+     **/
+    struct _fas_decoder_job {
+        unsigned long sequence;
+
+        struct _fas_decoder_packet *prev;
+        struct _fas_decoder_packet *curr;
+
+        // decoded data destination (acquired by the submitting thread)
+        void *output;
+
+        // previous / current packets sparse frames (NULL when frames are not sparse)
+        struct _fas_sparse_frame *prev_sparse_frame;
+        struct _fas_sparse_frame *sparse_frame;
+    };
+
+    /**
+     * decode the job current packet on its own (sparse_frame), called concurrently by decoding threads (the previous packet may not be prepared yet)
+     **/
+    typedef void (*fas_decoder_prepare)(struct _fas_decoder_job *job, void *data);
+
+    /**
+     * decode a job into its output once both packets are prepared, called concurrently by decoding threads
+     **/
+    typedef void (*fas_decoder_decode)(struct _fas_decoder_job *job, void *data);
+
+    /**
+     * publish a decoded output, called in submission order (one call at a time)
+     **/
+    typedef void (*fas_decoder_commit)(void *output, void *data);
+
+    struct _fas_decoder_thread {
+        struct _fas_decoder *decoder;
+
+        pthread_t thread;
+
+        // single producer (network thread) / single consumer jobs ring
+        struct _fas_decoder_job *jobs;
+
+        _Alignas(FAS_CACHE_LINE_SIZE) atomic_uint write_position;
+        _Alignas(FAS_CACHE_LINE_SIZE) atomic_uint read_position;
+    };
+
+    /**
+     * frames decode pipeline; the network thread submit complete frame packets and decoding threads turn them into notes buffers
+     *
+     * jobs are dispatched round-robin over per-thread lock-free rings and results are committed in submission order
+     * a packet is prepared once by its job, the next job wait for it before decoding against it
+     * jobs are decoded (then committed) on the submitting thread when there is no decoding threads
+     **/
+    struct _fas_decoder {
+        unsigned int count;
+        unsigned int queue_size;
+
+        // count threads (one entry when decoding happen on the submitting thread)
+        struct _fas_decoder_thread *threads;
+
+        fas_decoder_prepare prepare;
+        fas_decoder_decode decode;
+        fas_decoder_commit commit;
+        void *data;
+
+        // packets pool (see setDecoderFrames); only the network thread acquire packets
+        unsigned int packets_count;
+        struct _fas_decoder_packet *packets;
+        struct _fas_decoder_packet *last;
+
+        // submitting thread state
+        unsigned long submitted;
+        unsigned int next_thread;
+
+        // next sequence to commit
+        _Alignas(FAS_CACHE_LINE_SIZE) atomic_ulong committed;
+
+        atomic_int quit;
+    };
+
+    /**
+     * spawn count decoding threads with queue_size pending jobs each (no threads when count is 0), return NULL on failure
+     **/
+    extern struct _fas_decoder *createDecoder(unsigned int count, unsigned int queue_size, fas_decoder_prepare prepare, fas_decoder_decode decode, fas_decoder_commit commit, void *data);
+
+    /**
+     * (re)allocate packets of packet_capacity bytes and their sparse frames (when sparse is 1) for h rows frames
+     * the pipeline must be flushed; previous frame become a zeroed packet, return -1 on alloc. failure (no frames can be submitted)
+     **/
+    extern int setDecoderFrames(struct _fas_decoder *decoder, size_t packet_capacity, unsigned int h, unsigned int max_instruments, int sparse);
+
+    /**
+     * submit a frame packet to be decoded into output; the packet buffer is exchanged with a free packet buffer (packet / capacity are updated)
+     * return -1 when the frame is dropped (no free packets or queues full), output is then left to the caller
+     **/
+    extern int submitDecoder(struct _fas_decoder *decoder, char **packet, size_t *capacity, size_t len, void *output);
+
+    /**
+     * wait until all submitted frames are committed
+     **/
+    extern void flushDecoder(struct _fas_decoder *decoder);
+
+    /**
+     * pending frames are committed before threads exit
+     **/
+    extern struct _fas_decoder *freeDecoder(struct _fas_decoder **decoder);
+
+#endif
@@ -1,188 +1,293 @@
 #include "effects.h"
 
 #ifdef WITH_FAUST
-void createFaustEffects(
-    struct _faust_factories *faust_factories,
-    struct _synth_fx **fxs,
-    unsigned int max_channels,
-    unsigned int sample_rate) {
-    if (fxs == NULL || faust_factories == NULL) {
-        return;
+struct _fas_faust_effects *createFaustChannelEffects(struct _faust_factories *faust_factories, unsigned int sample_rate) {
+    if (faust_factories == NULL) {
+        return NULL;
     }
 
-    unsigned int i = 0, j = 0, k = 0;
-    for (i = 0; i < max_channels; i += 1) {
-        struct _synth_fx *fx = fxs[i];
-        
-        fx->faust_effs_len = faust_factories->len;
+    struct _fas_faust_effects *effects = (struct _fas_faust_effects *)calloc(1, sizeof(struct _fas_faust_effects));
+    if (effects == NULL) {
+        printf("createFaustChannelEffects alloc. error.");
+        fflush(stdout);
+        return NULL;
+    }
 
-        for (j = 0; j < FAS_MAX_FX_SLOTS; j += 1) {
-            fx->faust_effs[j] = (struct _fas_faust_dsp **)malloc(sizeof(struct _fas_faust_dsp **) * (faust_factories->len));
-            
-            for (k = 0; k < faust_factories->len; k += 1) {
-                struct _fas_faust_dsp *fdsp = malloc(sizeof(struct _fas_faust_dsp));
-
-                fx->faust_effs[j][k] = fdsp;
-
-                struct _fas_faust_ui_control *uiface = calloc(1, sizeof(struct _fas_faust_ui_control));
-                
-                UIGlue *ui = malloc(sizeof(UIGlue));
-                ui->openTabBox = ui_open_tab_box;
-                ui->openHorizontalBox = ui_open_horizontal_box;
-                ui->openVerticalBox = ui_open_vertical_box;
-                ui->closeBox = ui_close_box;
-                ui->addButton = ui_add_button;
-                ui->addCheckButton = ui_add_check_button;
-                ui->addVerticalSlider = ui_add_vertical_slider;
-                ui->addHorizontalSlider = ui_add_horizontal_slider;
-                ui->addNumEntry = ui_add_num_entry;
-                ui->addHorizontalBargraph = ui_add_horizontal_bargraph;
-                ui->addVerticalBargraph = ui_add_vertical_bargraph;
-                ui->addSoundfile = ui_add_sound_file;
-                ui->declare = ui_declare;
-                ui->uiInterface = uiface;
-                
-                llvm_dsp *dsp = createCDSPInstance(faust_factories->factories[k]);
-
-                buildUserInterfaceCDSPInstance(dsp, ui);
-
-                initCDSPInstance(dsp, sample_rate);
-
-                // initialize on known controls
-                /*
-                struct _fas_faust_ui_control *tmp;
-                tmp = getFaustControl(uiface, "fs_freq");
-                if (tmp) {
-                    *tmp->zone = frequency;
-                }
-                */
-                //
+    effects->len = faust_factories->len;
 
-                fdsp->controls = uiface;
-                fdsp->ui = ui;
-                fdsp->dsp = dsp;
-            }
-        }
-    }
-}
-#endif
+    unsigned int j = 0, k = 0;
+    for (j = 0; j < FAS_MAX_FX_SLOTS; j += 1) {
+        effects->effs[j] = (struct _fas_faust_dsp **)malloc(sizeof(struct _fas_faust_dsp **) * (faust_factories->len));
 
-void createEffects(
-#ifdef WITH_SOUNDPIPE
-    sp_data *spd,
-#endif
-    struct _synth_fx **fxs,
-    unsigned int max_channels,
-    unsigned int sample_rate
-) {
-    unsigned int i = 0, j = 0, k = 0;
+        for (k = 0; k < faust_factories->len; k += 1) {
+            struct _fas_faust_dsp *fdsp = malloc(sizeof(struct _fas_faust_dsp));
 
-    for (i = 0; i < max_channels; i += 1) {
-        fxs[i] = (struct _synth_fx *)calloc(1, sizeof(struct _synth_fx));
+            effects->effs[j][k] = fdsp;
 
-        struct _synth_fx *fx = fxs[i];
+            struct _fas_faust_ui_control *uiface = calloc(1, sizeof(struct _fas_faust_ui_control));
 
-#ifdef WITH_SOUNDPIPE
-        sp_ftbl_create(spd, (sp_ftbl **)&fx->ft_void, 1);
+            UIGlue *ui = malloc(sizeof(UIGlue));
+            ui->openTabBox = ui_open_tab_box;
+            ui->openHorizontalBox = ui_open_horizontal_box;
+            ui->openVerticalBox = ui_open_vertical_box;
+            ui->closeBox = ui_close_box;
+            ui->addButton = ui_add_button;
+            ui->addCheckButton = ui_add_check_button;
+            ui->addVerticalSlider = ui_add_vertical_slider;
+            ui->addHorizontalSlider = ui_add_horizontal_slider;
+            ui->addNumEntry = ui_add_num_entry;
+            ui->addHorizontalBargraph = ui_add_horizontal_bargraph;
+            ui->addVerticalBargraph = ui_add_vertical_bargraph;
+            ui->addSoundfile = ui_add_sound_file;
+            ui->declare = ui_declare;
+            ui->uiInterface = uiface;
 
-        // stereo support
-        for (j = 0; j < FAS_MAX_FX_SLOTS; j += 1) {
-            sp_zitarev_create((sp_zitarev **)&fx->zitarev[j]);
-            sp_zitarev_init(spd, (sp_zitarev *)fx->zitarev[j]);
+            llvm_dsp *dsp = createCDSPInstance(faust_factories->factories[k]);
 
-            sp_revsc_create((sp_revsc **)&fx->revsc[j]);
-            sp_revsc_init(spd, (sp_revsc *)fx->revsc[j]);
+            buildUserInterfaceCDSPInstance(dsp, ui);
 
-            sp_phaser_create((sp_phaser **)&fx->phaser[j]);
-            sp_phaser_init(spd, (sp_phaser *)fx->phaser[j]);
+            initCDSPInstance(dsp, sample_rate);
 
-            sp_panst_create((sp_panst **)&fx->panner[j]);
-            sp_panst_init(spd, (sp_panst *)fx->panner[j]);
-        }
+            fdsp->controls = uiface;
+            fdsp->ui = ui;
+            fdsp->dsp = dsp;
 
-        // no stereo support (so duplicate)
-        for (j = 0; j < FAS_MAX_FX_SLOTS * 2; j += 2) {
-            for (k = 0; k < 2; k += 1) {
-                sp_autowah_create((sp_autowah **)&fx->autowah[j + k]);
-                sp_autowah_init(spd, (sp_autowah *)fx->autowah[j + k]);
+            resolveFaustZones(fdsp);
+        }
+    }
 
-                sp_conv_create((sp_conv **)&fx->conv[j + k]);
-                sp_conv_init(spd, (sp_conv *)fx->conv[j + k], fx->ft_void, 256);
+    return effects;
+}
 
-                sp_delay_create((sp_delay **)&fx->delay[j + k]);
-                sp_delay_init(spd, (sp_delay *)fx->delay[j + k], 1.f);
+struct _fas_faust_effects *freeFaustChannelEffects(struct _fas_faust_effects **e) {
+    struct _fas_faust_effects *effects = *e;
 
-                sp_smoothdelay_create((sp_smoothdelay **)&fx->sdelay[j + k]);
-                sp_smoothdelay_init(spd, (sp_smoothdelay *)fx->sdelay[j + k], 1.f, 1024);
+    if (effects == NULL) {
+        return NULL;
+    }
 
-                sp_comb_create((sp_comb **)&fx->comb[j + k]);
-                sp_comb_init(spd, (sp_comb *)fx->comb[j + k], 0.1f);
+    unsigned int j = 0, k = 0;
+    for (j = 0; j < FAS_MAX_FX_SLOTS; j += 1) {
+        for (k = 0; k < effects->len; k += 1) {
+            struct _fas_faust_dsp *fdsp = effects->effs[j][k];
 
-                sp_bitcrush_create((sp_bitcrush **)&fx->bitcrush[j + k]);
-                sp_bitcrush_init(spd, (sp_bitcrush *)fx->bitcrush[j + k]);
+            freeFaustControls(fdsp->controls);
+            free(fdsp->ui);
 
-                sp_dist_create((sp_dist **)&fx->dist[j + k]);
-                sp_dist_init(spd, (sp_dist *)fx->dist[j + k]);
+            deleteCDSPInstance(fdsp->dsp);
 
-                sp_saturator_create((sp_saturator **)&fx->saturator[j + k]);
-                sp_saturator_init(spd, (sp_saturator *)fx->saturator[j + k]);
+            free(fdsp);
+        }
 
-                sp_compressor_create((sp_compressor **)&fx->compressor[j + k]);
-                sp_compressor_init(spd, (sp_compressor *)fx->compressor[j + k]);
+        free(effects->effs[j]);
+    }
 
-                sp_peaklim_create((sp_peaklim **)&fx->peaklimit[j + k]);
-                sp_peaklim_init(spd, (sp_peaklim *)fx->peaklimit[j + k]);
+    free(effects);
 
-                sp_clip_create((sp_clip **)&fx->clip[j + k]);
-                sp_clip_init(spd, (sp_clip *)fx->clip[j + k]);
+    *e = NULL;
 
-                sp_butlp_create((sp_butlp **)&fx->butlp[j + k]);
-                sp_butlp_init(spd, (sp_butlp *)fx->butlp[j + k]);
+    return NULL;
+}
 
-                sp_buthp_create((sp_buthp **)&fx->buthp[j + k]);
-                sp_buthp_init(spd, (sp_buthp *)fx->buthp[j + k]);
+void createFaustEffects(
+    struct _faust_factories *faust_factories,
+    struct _synth_fx **fxs,
+    unsigned int max_channels,
+    unsigned int sample_rate) {
+    if (fxs == NULL || faust_factories == NULL) {
+        return;
+    }
 
-                sp_butbp_create((sp_butbp **)&fx->butbp[j + k]);
-                sp_butbp_init(spd, (sp_butbp *)fx->butbp[j + k]);
+    unsigned int i = 0;
+    for (i = 0; i < max_channels; i += 1) {
+        fxs[i]->faust_effs = createFaustChannelEffects(faust_factories, sample_rate);
+    }
+}
 
-                sp_butbr_create((sp_butbr **)&fx->butbr[j + k]);
-                sp_butbr_init(spd, (sp_butbr *)fx->butbr[j + k]);
+void swapFaustEffects(struct _synth_fx **fxs, struct _fas_faust_effects **effects, unsigned int max_channels) {
+    unsigned int i = 0;
+    for (i = 0; i < max_channels; i += 1) {
+        struct _fas_faust_effects *previous = fxs[i]->faust_effs;
 
-                sp_pareq_create((sp_pareq **)&fx->pareq[j + k]);
-                sp_pareq_init(spd, (sp_pareq *)fx->pareq[j + k]);
+        fxs[i]->faust_effs = effects[i];
 
-                sp_fold_create((sp_fold **)&fx->fold[j + k]);
-                sp_fold_init(spd, (sp_fold *)fx->fold[j + k]);
+        effects[i] = previous;
+    }
+}
+#endif
 
-                sp_dcblock_create((sp_dcblock **)&fx->dcblock[j + k]);
-                sp_dcblock_init(spd, (sp_dcblock *)fx->dcblock[j + k]);
+void createEffects(
+#ifdef WITH_SOUNDPIPE
+    sp_data *spd,
+#endif
+    struct _synth_fx **fxs,
+    unsigned int max_channels,
+    unsigned int sample_rate
+) {
+    unsigned int i = 0;
 
-                sp_lpc_create((sp_lpc **)&fx->lpc[j + k]);
-                sp_lpc_init(spd, (sp_lpc *)fx->lpc[j + k], 512);
+    for (i = 0; i < max_channels; i += 1) {
+        fxs[i] = (struct _synth_fx *)calloc(1, sizeof(struct _synth_fx));
 
-                sp_waveset_create((sp_waveset **)&fx->wset[j + k]);
-                sp_waveset_init(spd, (sp_waveset *)fx->wset[j + k], 1);
+        struct _synth_fx *fx = fxs[i];
 
-                sp_moogladder_create((sp_moogladder **)&fx->mooglp[j + k]);
-                sp_moogladder_init(spd, (sp_moogladder *)fx->mooglp[j + k]);
+#ifdef WITH_SOUNDPIPE
+        // effects instances are created on slot assignment (see createEffectSlot)
+        sp_ftbl_create(spd, (sp_ftbl **)&fx->ft_void, 1);
+#endif
+    }
+}
 
-                sp_diode_create((sp_diode **)&fx->diodelp[j + k]);
-                sp_diode_init(spd, (sp_diode *)fx->diodelp[j + k]);
+#ifdef WITH_SOUNDPIPE
+void createEffectSlot(
+    sp_data *spd,
+    struct _synth_fx *fx,
+    int fx_id,
+    unsigned int slot
+) {
+    if (slot >= FAS_MAX_FX_SLOTS) {
+        return;
+    }
 
-                sp_wpkorg35_create((sp_wpkorg35 **)&fx->korglp[j + k]);
-                sp_wpkorg35_init(spd, (sp_wpkorg35 *)fx->korglp[j + k]);
+    // stereo support
+    if (fx_id == FX_ZITAREV && fx->zitarev[slot] == NULL) {
+        sp_zitarev_create((sp_zitarev **)&fx->zitarev[slot]);
+        sp_zitarev_init(spd, (sp_zitarev *)fx->zitarev[slot]);
+    } else if (fx_id == FX_SCREV && fx->revsc[slot] == NULL) {
+        sp_revsc_create((sp_revsc **)&fx->revsc[slot]);
+        sp_revsc_init(spd, (sp_revsc *)fx->revsc[slot]);
+    } else if (fx_id == FX_PHASER && fx->phaser[slot] == NULL) {
+        sp_phaser_create((sp_phaser **)&fx->phaser[slot]);
+        sp_phaser_init(spd, (sp_phaser *)fx->phaser[slot]);
+    } else if (fx_id == FX_PANNER && fx->panner[slot] == NULL) {
+        sp_panst_create((sp_panst **)&fx->panner[slot]);
+        sp_panst_init(spd, (sp_panst *)fx->panner[slot]);
+    }
 
-                sp_lpf18_create((sp_lpf18 **)&fx->lpf18[j + k]);
-                sp_lpf18_init(spd, (sp_lpf18 *)fx->lpf18[j + k]);
+    // no stereo support (so duplicate)
+    unsigned int k = 0;
+    for (k = 0; k < 2; k += 1) {
+        unsigned int slot_index = slot * 2 + k;
 
-                sp_tbvcf_create((sp_tbvcf **)&fx->tbvcf[j + k]);
-                sp_tbvcf_init(spd, (sp_tbvcf *)fx->tbvcf[j + k]);
-            }
+        if (fx_id == FX_AUTOWAH && fx->autowah[slot_index] == NULL) {
+            sp_autowah_create((sp_autowah **)&fx->autowah[slot_index]);
+            sp_autowah_init(spd, (sp_autowah *)fx->autowah[slot_index]);
+        } else if (fx_id == FX_CONV && fx->conv[slot_index] == NULL) {
+            sp_conv_create((sp_conv **)&fx->conv[slot_index]);
+            sp_conv_init(spd, (sp_conv *)fx->conv[slot_index], fx->ft_void, 256);
+        } else if (fx_id == FX_DELAY && fx->delay[slot_index] == NULL) {
+            sp_delay_create((sp_delay **)&fx->delay[slot_index]);
+            sp_delay_init(spd, (sp_delay *)fx->delay[slot_index], 1.f);
+        } else if (fx_id == FX_SMOOTH_DELAY && fx->sdelay[slot_index] == NULL) {
+            sp_smoothdelay_create((sp_smoothdelay **)&fx->sdelay[slot_index]);
+            sp_smoothdelay_init(spd, (sp_smoothdelay *)fx->sdelay[slot_index], 1.f, 1024);
+        } else if (fx_id == FX_COMB && fx->comb[slot_index] == NULL) {
+            sp_comb_create((sp_comb **)&fx->comb[slot_index]);
+            sp_comb_init(spd, (sp_comb *)fx->comb[slot_index], 0.1f);
+        } else if (fx_id == FX_BITCRUSH && fx->bitcrush[slot_index] == NULL) {
+            sp_bitcrush_create((sp_bitcrush **)&fx->bitcrush[slot_index]);
+            sp_bitcrush_init(spd, (sp_bitcrush *)fx->bitcrush[slot_index]);
+        } else if (fx_id == FX_DISTORSION && fx->dist[slot_index] == NULL) {
+            sp_dist_create((sp_dist **)&fx->dist[slot_index]);
+            sp_dist_init(spd, (sp_dist *)fx->dist[slot_index]);
+        } else if (fx_id == FX_SATURATOR && fx->saturator[slot_index] == NULL) {
+            sp_saturator_create((sp_saturator **)&fx->saturator[slot_index]);
+            sp_saturator_init(spd, (sp_saturator *)fx->saturator[slot_index]);
+        } else if (fx_id == FX_COMPRESSOR && fx->compressor[slot_index] == NULL) {
+            sp_compressor_create((sp_compressor **)&fx->compressor[slot_index]);
+            sp_compressor_init(spd, (sp_compressor *)fx->compressor[slot_index]);
+        } else if (fx_id == FX_PEAK_LIMITER && fx->peaklimit[slot_index] == NULL) {
+            sp_peaklim_create((sp_peaklim **)&fx->peaklimit[slot_index]);
+            sp_peaklim_init(spd, (sp_peaklim *)fx->peaklimit[slot_index]);
+        } else if (fx_id == FX_CLIP && fx->clip[slot_index] == NULL) {
+            sp_clip_create((sp_clip **)&fx->clip[slot_index]);
+            sp_clip_init(spd, (sp_clip *)fx->clip[slot_index]);
+        } else if (fx_id == FX_B_LOWPASS && fx->butlp[slot_index] == NULL) {
+            sp_butlp_create((sp_butlp **)&fx->butlp[slot_index]);
+            sp_butlp_init(spd, (sp_butlp *)fx->butlp[slot_index]);
+        } else if (fx_id == FX_B_HIGHPASS && fx->buthp[slot_index] == NULL) {
+            sp_buthp_create((sp_buthp **)&fx->buthp[slot_index]);
+            sp_buthp_init(spd, (sp_buthp *)fx->buthp[slot_index]);
+        } else if (fx_id == FX_B_BANDPASS && fx->butbp[slot_index] == NULL) {
+            sp_butbp_create((sp_butbp **)&fx->butbp[slot_index]);
+            sp_butbp_init(spd, (sp_butbp *)fx->butbp[slot_index]);
+        } else if (fx_id == FX_B_BANDREJECT && fx->butbr[slot_index] == NULL) {
+            sp_butbr_create((sp_butbr **)&fx->butbr[slot_index]);
+            sp_butbr_init(spd, (sp_butbr *)fx->butbr[slot_index]);
+        } else if (fx_id == FX_PAREQ && fx->pareq[slot_index] == NULL) {
+            sp_pareq_create((sp_pareq **)&fx->pareq[slot_index]);
+            sp_pareq_init(spd, (sp_pareq *)fx->pareq[slot_index]);
+        } else if (fx_id == FX_FOLD && fx->fold[slot_index] == NULL) {
+            sp_fold_create((sp_fold **)&fx->fold[slot_index]);
+            sp_fold_init(spd, (sp_fold *)fx->fold[slot_index]);
+        } else if (fx_id == FX_DC_BLOCK && fx->dcblock[slot_index] == NULL) {
+            sp_dcblock_create((sp_dcblock **)&fx->dcblock[slot_index]);
+            sp_dcblock_init(spd, (sp_dcblock *)fx->dcblock[slot_index]);
+        } else if (fx_id == FX_LPC && fx->lpc[slot_index] == NULL) {
+            sp_lpc_create((sp_lpc **)&fx->lpc[slot_index]);
+            sp_lpc_init(spd, (sp_lpc *)fx->lpc[slot_index], 512);
+        } else if (fx_id == FX_WAVESET && fx->wset[slot_index] == NULL) {
+            sp_waveset_create((sp_waveset **)&fx->wset[slot_index]);
+            sp_waveset_init(spd, (sp_waveset *)fx->wset[slot_index], 1);
+        } else if (fx_id == FX_MOOG_LPF && fx->mooglp[slot_index] == NULL) {
+            sp_moogladder_create((sp_moogladder **)&fx->mooglp[slot_index]);
+            sp_moogladder_init(spd, (sp_moogladder *)fx->mooglp[slot_index]);
+        } else if (fx_id == FX_DIODE_LPF && fx->diodelp[slot_index] == NULL) {
+            sp_diode_create((sp_diode **)&fx->diodelp[slot_index]);
+            sp_diode_init(spd, (sp_diode *)fx->diodelp[slot_index]);
+        } else if (fx_id == FX_KORG_LPF && fx->korglp[slot_index] == NULL) {
+            sp_wpkorg35_create((sp_wpkorg35 **)&fx->korglp[slot_index]);
+            sp_wpkorg35_init(spd, (sp_wpkorg35 *)fx->korglp[slot_index]);
+        } else if (fx_id == FX_18_LPF && fx->lpf18[slot_index] == NULL) {
+            sp_lpf18_create((sp_lpf18 **)&fx->lpf18[slot_index]);
+            sp_lpf18_init(spd, (sp_lpf18 *)fx->lpf18[slot_index]);
+        } else if (fx_id == FX_TBVCF && fx->tbvcf[slot_index] == NULL) {
+            sp_tbvcf_create((sp_tbvcf **)&fx->tbvcf[slot_index]);
+            sp_tbvcf_init(spd, (sp_tbvcf *)fx->tbvcf[slot_index]);
         }
-#endif
     }
 }
 
+// instances of a slot are created on assignment by createEffectSlot; a slot is skipped if they are missing
+static int hasEffectInstances(struct _synth_fx *fx, int fx_id, unsigned int slot) {
+    unsigned int l = slot * 2;
+    unsigned int r = slot * 2 + 1;
+
+    switch (fx_id) {
+        case FX_ZITAREV: return fx->zitarev[slot] != NULL;
+        case FX_SCREV: return fx->revsc[slot] != NULL;
+        case FX_PHASER: return fx->phaser[slot] != NULL;
+        case FX_PANNER: return fx->panner[slot] != NULL;
+        case FX_AUTOWAH: return fx->autowah[l] && fx->autowah[r];
+        case FX_CONV: return fx->conv[l] && fx->conv[r];
+        case FX_DELAY: return fx->delay[l] && fx->delay[r];
+        case FX_SMOOTH_DELAY: return fx->sdelay[l] && fx->sdelay[r];
+        case FX_COMB: return fx->comb[l] && fx->comb[r];
+        case FX_BITCRUSH: return fx->bitcrush[l] && fx->bitcrush[r];
+        case FX_DISTORSION: return fx->dist[l] && fx->dist[r];
+        case FX_SATURATOR: return fx->saturator[l] && fx->saturator[r];
+        case FX_COMPRESSOR: return fx->compressor[l] && fx->compressor[r];
+        case FX_PEAK_LIMITER: return fx->peaklimit[l] && fx->peaklimit[r];
+        case FX_CLIP: return fx->clip[l] && fx->clip[r];
+        case FX_B_LOWPASS: return fx->butlp[l] && fx->butlp[r];
+        case FX_B_HIGHPASS: return fx->buthp[l] && fx->buthp[r];
+        case FX_B_BANDPASS: return fx->butbp[l] && fx->butbp[r];
+        case FX_B_BANDREJECT: return fx->butbr[l] && fx->butbr[r];
+        case FX_PAREQ: return fx->pareq[l] && fx->pareq[r];
+        case FX_MOOG_LPF: return fx->mooglp[l] && fx->mooglp[r];
+        case FX_DIODE_LPF: return fx->diodelp[l] && fx->diodelp[r];
+        case FX_KORG_LPF: return fx->korglp[l] && fx->korglp[r];
+        case FX_18_LPF: return fx->lpf18[l] && fx->lpf18[r];
+        case FX_TBVCF: return fx->tbvcf[l] && fx->tbvcf[r];
+        case FX_FOLD: return fx->fold[l] && fx->fold[r];
+        case FX_DC_BLOCK: return fx->dcblock[l] && fx->dcblock[r];
+        case FX_LPC: return fx->lpc[l] && fx->lpc[r];
+        case FX_WAVESET: return fx->wset[l] && fx->wset[r];
+        default: return 1;
+    }
+}
+#endif
+
 void updateEffectParameter(
 #ifdef WITH_SOUNDPIPE
     sp_data *sp,
@@ -199,6 +304,10 @@ void updateEffectParameter(
     struct _synth_fx_settings *fx = &chns->fx[slot];
 
 #ifdef WITH_SOUNDPIPE
+    if (!hasEffectInstances(fxs, fx->fx_id, slot)) {
+        return;
+    }
+
     if (fx->fx_id == FX_SMOOTH_DELAY) {
         sp_smoothdelay *sdelay_l = (sp_smoothdelay *)fxs->sdelay[slot2];
         sp_smoothdelay *sdelay_r = (sp_smoothdelay *)fxs->sdelay[slot2 + 1];
@@ -389,57 +498,11 @@ void updateEffectParameter(
 #endif
 #ifdef WITH_FAUST
     if (fx->fx_id == FX_FAUST) {
-        struct _fas_faust_dsp *fdsp = fxs->faust_effs[slot][(unsigned int)fx->fp[0]];
-
-        struct _fas_faust_ui_control *tmp;
-        if (target == 3) {
-            tmp = getFaustControl(fdsp->controls, "fs_p0");
-            if (tmp) { *tmp->zone = value; }
-
-            return;
-        } else if (target == 4) {
-            tmp = getFaustControl(fdsp->controls, "fs_p1");
-            if (tmp) { *tmp->zone = value; }
-
-            return;
-        } else if (target == 5) {
-            tmp = getFaustControl(fdsp->controls, "fs_p2");
-            if (tmp) { *tmp->zone = value; }
-
-            return;
-        } else if (target == 6) {
-            tmp = getFaustControl(fdsp->controls, "fs_p3");
-            if (tmp) { *tmp->zone = value; }
-
-            return;
-        } else if (target == 7) {
-            tmp = getFaustControl(fdsp->controls, "fs_p4");
-            if (tmp) { *tmp->zone = value; }
-
-            return;
-        } else if (target == 8) {
-            tmp = getFaustControl(fdsp->controls, "fs_p5");
-            if (tmp) { *tmp->zone = value; }
-
-            return;
-        } else if (target == 9) {
-            tmp = getFaustControl(fdsp->controls, "fs_p6");
-            if (tmp) { *tmp->zone = value; }
-
-            return;
-        } else if (target == 10) {
-            tmp = getFaustControl(fdsp->controls, "fs_p7");
-            if (tmp) { *tmp->zone = value; }
+        struct _fas_faust_dsp *fdsp = getFaustEffect(fxs, slot, fx->fp[0]);
 
-            return;
-        } else if (target == 11) {
-            tmp = getFaustControl(fdsp->controls, "fs_p8");
-            if (tmp) { *tmp->zone = value; }
-
-            return;
-        } else if (target == 12) {
-            tmp = getFaustControl(fdsp->controls, "fs_p9");
-            if (tmp) { *tmp->zone = value; }
+        // fs_p0 ... fs_p9
+        if (fdsp && target >= 3 && target <= 12) {
+            setFaustZone(fdsp, FAS_FAUST_ZONE_P0 + (target - 3), value);
 
             return;
         }
@@ -654,7 +717,10 @@ void resetConvolution(
 
     unsigned int slot_index = slot * 2 + lr;
 
-    sp_conv_destroy((sp_conv **)&fxs->conv[slot_index]);
+    if (fxs->conv[slot_index]) {
+        sp_conv_destroy((sp_conv **)&fxs->conv[slot_index]);
+    }
+
     sp_conv_create((sp_conv **)&fxs->conv[slot_index]);
 
     sp_conv_init(sp, (sp_conv *)fxs->conv[slot_index], imp_ftbl, v2);
@@ -674,7 +740,10 @@ void resetDelays(
     unsigned int slot_index = slot * 2 + lr;
 
     if (type == 0) {
-        sp_delay_destroy((sp_delay **)&fxs->delay[slot_index]);
+        if (fxs->delay[slot_index]) {
+            sp_delay_destroy((sp_delay **)&fxs->delay[slot_index]);
+        }
+
         sp_delay_create((sp_delay **)&fxs->delay[slot_index]);
 
         sp_delay_init(sp, (sp_delay *)fxs->delay[slot_index], v1);
@@ -682,7 +751,10 @@ void resetDelays(
         sp_delay *delay = (sp_delay *)fxs->delay[slot_index];
         delay->feedback = v2;
     } else if (type == 1) {
-        sp_smoothdelay_destroy((sp_smoothdelay **)&fxs->sdelay[slot_index]);
+        if (fxs->sdelay[slot_index]) {
+            sp_smoothdelay_destroy((sp_smoothdelay **)&fxs->sdelay[slot_index]);
+        }
+
         sp_smoothdelay_create((sp_smoothdelay **)&fxs->sdelay[slot_index]);
 
         sp_smoothdelay_init(sp, (sp_smoothdelay *)fxs->sdelay[slot_index], v1, v2);
@@ -703,7 +775,10 @@ void resetComb(
 ) {
     unsigned int slot_index = slot * 2 + lr;
 
-    sp_comb_destroy((sp_comb **)&fxs->comb[slot_index]);
+    if (fxs->comb[slot_index]) {
+        sp_comb_destroy((sp_comb **)&fxs->comb[slot_index]);
+    }
+
     sp_comb_create((sp_comb **)&fxs->comb[slot_index]);
 
     sp_comb_init(sp, (sp_comb *)fxs->comb[slot_index], v1);
@@ -722,7 +797,10 @@ void resetLpc(
     for (k = 0; k < 2; k += 1) {
         unsigned int slot_index = slot * 2 + k;
 
-        sp_lpc_destroy((sp_lpc **)&fxs->lpc[slot_index]);
+        if (fxs->lpc[slot_index]) {
+            sp_lpc_destroy((sp_lpc **)&fxs->lpc[slot_index]);
+        }
+
         sp_lpc_create((sp_lpc **)&fxs->lpc[slot_index]);
 
         sp_lpc_init(sp, (sp_lpc *)fxs->lpc[slot_index], v1);
@@ -739,7 +817,10 @@ void resetWaveset(
     for (k = 0; k < 2; k += 1) {
         unsigned int slot_index = slot * 2 + k;
 
-        sp_waveset_destroy((sp_waveset **)&fxs->wset[slot_index]);
+        if (fxs->wset[slot_index]) {
+            sp_waveset_destroy((sp_waveset **)&fxs->wset[slot_index]);
+        }
+
         sp_waveset_create((sp_waveset **)&fxs->wset[slot_index]);
 
         sp_waveset_init(sp, (sp_waveset *)fxs->wset[slot_index], v1);
@@ -775,30 +856,249 @@ void resetConvolutions(
     }
 }
 
+// effects chain block processing; one function per effect type, states are looked up once per block
+#ifdef WITH_SOUNDPIPE
+#define FAS_FX_ARGS sp_data *sp, struct _synth_fx *fx, struct _synth_fx_settings *fx_settings, unsigned int slot, FAS_FLOAT *out_l, FAS_FLOAT *out_r, unsigned int len
+#else
+#define FAS_FX_ARGS struct _synth_fx *fx, struct _synth_fx_settings *fx_settings, unsigned int slot, FAS_FLOAT *out_l, FAS_FLOAT *out_r, unsigned int len
+#endif
+
+#ifdef WITH_SOUNDPIPE
+// stereo effect
+#define FAS_FX_STEREO(name, type, field) \
+static void process##name(FAS_FX_ARGS) { \
+    type *fx_lr = (type *)fx->field[slot]; \
+    unsigned int w; \
+    \
+    for (w = 0; w < len; w += 1) { \
+        type##_compute(sp, fx_lr, &out_l[w], &out_r[w], &out_l[w], &out_r[w]); \
+    } \
+}
+
+// mono effect (one per side) processed in place
+#define FAS_FX_MONO(name, type, field) \
+static void process##name(FAS_FX_ARGS) { \
+    type *fx_l = (type *)fx->field[slot * 2]; \
+    type *fx_r = (type *)fx->field[slot * 2 + 1]; \
+    unsigned int w; \
+    \
+    for (w = 0; w < len; w += 1) { \
+        type##_compute(sp, fx_l, &out_l[w], &out_l[w]); \
+        type##_compute(sp, fx_r, &out_r[w], &out_r[w]); \
+    } \
+}
+
+// mono effect (one per side) which must not process in place
+#define FAS_FX_MONO_COPY(name, type, field) \
+static void process##name(FAS_FX_ARGS) { \
+    type *fx_l = (type *)fx->field[slot * 2]; \
+    type *fx_r = (type *)fx->field[slot * 2 + 1]; \
+    unsigned int w; \
+    \
+    for (w = 0; w < len; w += 1) { \
+        FAS_FLOAT insl = out_l[w]; \
+        FAS_FLOAT insr = out_r[w]; \
+        \
+        type##_compute(sp, fx_l, &insl, &out_l[w]); \
+        type##_compute(sp, fx_r, &insr, &out_r[w]); \
+    } \
+}
+
+// mono effect (one per side) with dry / wet mix
+#define FAS_FX_DRY_WET(name, type, field) \
+static void process##name(FAS_FX_ARGS) { \
+    type *fx_l = (type *)fx->field[slot * 2]; \
+    type *fx_r = (type *)fx->field[slot * 2 + 1]; \
+    FAS_FLOAT dry_l = fx->dry[slot * 2], dry_r = fx->dry[slot * 2 + 1]; \
+    FAS_FLOAT wet_l = fx->wet[slot * 2], wet_r = fx->wet[slot * 2 + 1]; \
+    unsigned int w; \
+    \
+    for (w = 0; w < len; w += 1) { \
+        FAS_FLOAT insl = out_l[w]; \
+        FAS_FLOAT insr = out_r[w]; \
+        \
+        FAS_FLOAT outsl = 0; \
+        FAS_FLOAT outsr = 0; \
+        \
+        type##_compute(sp, fx_l, &insl, &outsl); \
+        type##_compute(sp, fx_r, &insr, &outsr); \
+        \
+        out_l[w] = out_l[w] * dry_l + outsl * wet_l; \
+        out_r[w] = out_r[w] * dry_r + outsr * wet_r; \
+    } \
+}
+
+FAS_FX_DRY_WET(Conv, sp_conv, conv)
+FAS_FX_STEREO(Zitarev, sp_zitarev, zitarev)
+FAS_FX_STEREO(Revsc, sp_revsc, revsc)
+FAS_FX_MONO(Autowah, sp_autowah, autowah)
+FAS_FX_STEREO(Phaser, sp_phaser, phaser)
+FAS_FX_DRY_WET(Comb, sp_comb, comb)
+FAS_FX_DRY_WET(Delay, sp_delay, delay)
+FAS_FX_MONO_COPY(SmoothDelay, sp_smoothdelay, sdelay)
+FAS_FX_DRY_WET(Bitcrush, sp_bitcrush, bitcrush)
+FAS_FX_DRY_WET(Distorsion, sp_dist, dist)
+FAS_FX_DRY_WET(Saturator, sp_saturator, saturator)
+FAS_FX_MONO(Compressor, sp_compressor, compressor)
+FAS_FX_DRY_WET(PeakLimiter, sp_peaklim, peaklimit)
+FAS_FX_DRY_WET(Clip, sp_clip, clip)
+FAS_FX_MONO(Lowpass, sp_butlp, butlp)
+FAS_FX_MONO(Highpass, sp_buthp, buthp)
+FAS_FX_MONO(Bandpass, sp_butbp, butbp)
+FAS_FX_MONO(Bandreject, sp_butbr, butbr)
+FAS_FX_MONO(Pareq, sp_pareq, pareq)
+FAS_FX_MONO(MoogLpf, sp_moogladder, mooglp)
+FAS_FX_MONO(DiodeLpf, sp_diode, diodelp)
+FAS_FX_MONO(KorgLpf, sp_wpkorg35, korglp)
+FAS_FX_MONO(Lpf18, sp_lpf18, lpf18)
+FAS_FX_MONO_COPY(Tbvcf, sp_tbvcf, tbvcf)
+FAS_FX_MONO(Fold, sp_fold, fold)
+FAS_FX_MONO(DcBlock, sp_dcblock, dcblock)
+FAS_FX_MONO(Lpc, sp_lpc, lpc)
+FAS_FX_MONO(Waveset, sp_waveset, wset)
+FAS_FX_STEREO(Panner, sp_panst, panner)
+#endif
+
 #ifdef WITH_FAUST
-void freeFaustEffects(struct _synth_fx **fxs, unsigned int max_channels) {
-    if (fxs == NULL) {
+static void processFaust(FAS_FX_ARGS) {
+    struct _fas_faust_dsp *fas_faust_dsp = getFaustEffect(fx, slot, fx_settings->fp[0]);
+    if (fas_faust_dsp == NULL) {
         return;
     }
 
-    unsigned int i = 0, j = 0, k = 0;
-    for (i = 0; i < max_channels; i += 1) {
-        struct _synth_fx *fx = fxs[i];
+    // block processing; DSP output is written in place so input is copied first
+    FAUSTFLOAT in_l[FAS_BLOCK_SIZE], in_r[FAS_BLOCK_SIZE];
 
-        for (j = 0; j < FAS_MAX_FX_SLOTS; j += 1) {
-            for (k = 0; k < fx->faust_effs_len; k += 1) {
-                struct _fas_faust_dsp *fdsp = fx->faust_effs[j][k];
+    unsigned int w;
+    for (w = 0; w < len; w += 1) {
+        in_l[w] = out_l[w];
+        in_r[w] = out_r[w];
+    }
 
-                freeFaustControls(fdsp->controls);
-                free(fdsp->ui);
+    FAUSTFLOAT *faust_input[2] = { in_l, in_r };
+    FAUSTFLOAT *faust_output[2] = { out_l, out_r };
 
-                deleteCDSPInstance(fdsp->dsp);
+    computeCDSPInstance(fas_faust_dsp->dsp, len, faust_input, faust_output);
 
-                free(fdsp);
-            }
+    // mono DSP output is duplicated
+    if (getNumOutputsCDSPInstance(fas_faust_dsp->dsp) == 1) {
+        for (w = 0; w < len; w += 1) {
+            out_r[w] = out_l[w];
+        }
+    }
+}
+#endif
 
-            free(fx->faust_effs[j]);
+// indexed by effect id, NULL when the effect is not available
+static const fas_fx_process fas_fx_processes[FX_FAUST + 1] = {
+#ifdef WITH_SOUNDPIPE
+    [FX_CONV] = processConv,
+    [FX_ZITAREV] = processZitarev,
+    [FX_SCREV] = processRevsc,
+    [FX_AUTOWAH] = processAutowah,
+    [FX_PHASER] = processPhaser,
+    [FX_COMB] = processComb,
+    [FX_DELAY] = processDelay,
+    [FX_SMOOTH_DELAY] = processSmoothDelay,
+    [FX_BITCRUSH] = processBitcrush,
+    [FX_DISTORSION] = processDistorsion,
+    [FX_SATURATOR] = processSaturator,
+    [FX_COMPRESSOR] = processCompressor,
+    [FX_PEAK_LIMITER] = processPeakLimiter,
+    [FX_CLIP] = processClip,
+    [FX_B_LOWPASS] = processLowpass,
+    [FX_B_HIGHPASS] = processHighpass,
+    [FX_B_BANDPASS] = processBandpass,
+    [FX_B_BANDREJECT] = processBandreject,
+    [FX_PAREQ] = processPareq,
+    [FX_MOOG_LPF] = processMoogLpf,
+    [FX_DIODE_LPF] = processDiodeLpf,
+    [FX_KORG_LPF] = processKorgLpf,
+    [FX_18_LPF] = processLpf18,
+    [FX_TBVCF] = processTbvcf,
+    [FX_FOLD] = processFold,
+    [FX_DC_BLOCK] = processDcBlock,
+    [FX_LPC] = processLpc,
+    [FX_WAVESET] = processWaveset,
+    [FX_PANNER] = processPanner,
+#endif
+#ifdef WITH_FAUST
+    [FX_FAUST] = processFaust,
+#endif
+#if !defined(WITH_SOUNDPIPE) && !defined(WITH_FAUST)
+    NULL
+#endif
+};
+
+void compileEffectsChain(struct _synth_fx *fx, struct _synth_chn_settings *chns) {
+    struct _synth_fx_chain *chain = &fx->chain;
+
+    unsigned int slot = 0;
+
+    chain->count = 0;
+
+    for (slot = 0; slot < FAS_MAX_FX_SLOTS; slot += 1) {
+        struct _synth_fx_settings *fx_settings = &chns->fx[slot];
+
+        if (fx_settings->bypass) {
+            continue;
+        }
+
+        int fx_id = fx_settings->fx_id;
+
+        if (fx_id == -1) {
+            break;
+        }
+
+        if (fx_id < 0 || fx_id > FX_FAUST || fas_fx_processes[fx_id] == NULL) {
+            continue;
+        }
+
+#ifdef WITH_SOUNDPIPE
+        if (!hasEffectInstances(fx, fx_id, slot)) {
+            continue;
         }
+#endif
+
+        struct _synth_fx_chain_entry *entry = &chain->entries[chain->count++];
+
+        entry->process = fas_fx_processes[fx_id];
+        entry->slot = slot;
+    }
+}
+
+void processEffectsChain(
+#ifdef WITH_SOUNDPIPE
+    sp_data *sp,
+#endif
+    struct _synth_fx *fx,
+    struct _synth_chn_settings *chns,
+    FAS_FLOAT *out_l,
+    FAS_FLOAT *out_r,
+    unsigned int len) {
+    struct _synth_fx_chain *chain = &fx->chain;
+
+    unsigned int e = 0;
+    for (e = 0; e < chain->count; e += 1) {
+        struct _synth_fx_chain_entry *entry = &chain->entries[e];
+
+        entry->process(
+#ifdef WITH_SOUNDPIPE
+            sp,
+#endif
+            fx, &chns->fx[entry->slot], entry->slot, out_l, out_r, len);
+    }
+}
+
+#ifdef WITH_FAUST
+void freeFaustEffects(struct _synth_fx **fxs, unsigned int max_channels) {
+    if (fxs == NULL) {
+        return;
+    }
+
+    unsigned int i = 0;
+    for (i = 0; i < max_channels; i += 1) {
+        freeFaustChannelEffects(&fxs[i]->faust_effs);
     }
 }
 #endif
@@ -820,40 +1120,124 @@ void freeEffects(struct _synth_fx **fxs, unsigned int max_channels) {
         sp_ftbl_destroy((sp_ftbl **)&fx->ft_void);
 
         for (j = 0; j < FAS_MAX_FX_SLOTS; j += 1) {
-            sp_zitarev_destroy((sp_zitarev **)&fx->zitarev[j]);
-            sp_revsc_destroy((sp_revsc **)&fx->revsc[j]);
+            if (fx->zitarev[j]) {
+                sp_zitarev_destroy((sp_zitarev **)&fx->zitarev[j]);
+            }
+
+            if (fx->revsc[j]) {
+                sp_revsc_destroy((sp_revsc **)&fx->revsc[j]);
+            }
 
-            sp_phaser_destroy((sp_phaser **)&fx->phaser[j]);
-            sp_panst_destroy((sp_panst **)&fx->panner[j]);
+            if (fx->phaser[j]) {
+                sp_phaser_destroy((sp_phaser **)&fx->phaser[j]);
+            }
+
+            if (fx->panner[j]) {
+                sp_panst_destroy((sp_panst **)&fx->panner[j]);
+            }
         }
 
         for (j = 0; j < FAS_MAX_FX_SLOTS * 2; j += 2) {
             for (k = 0; k < 2; k += 1) {
-                sp_autowah_destroy((sp_autowah **)&fx->autowah[j + k]);
-                sp_conv_destroy((sp_conv **)&fx->conv[j + k]);
-                sp_delay_destroy((sp_delay **)&fx->delay[j + k]);
-                sp_smoothdelay_destroy((sp_smoothdelay **)&fx->sdelay[j + k]);
-                sp_comb_destroy((sp_comb **)&fx->comb[j + k]);
-                sp_bitcrush_destroy((sp_bitcrush **)&fx->bitcrush[j + k]);
-                sp_dist_destroy((sp_dist **)&fx->dist[j + k]);
-                sp_saturator_destroy((sp_saturator **)&fx->saturator[j + k]);
-                sp_compressor_destroy((sp_compressor **)&fx->compressor[j + k]);
-                sp_peaklim_destroy((sp_peaklim **)&fx->peaklimit[j + k]);
-                sp_clip_destroy((sp_clip **)&fx->clip[j + k]);
-                sp_butlp_destroy((sp_butlp **)&fx->butlp[j + k]);
-                sp_buthp_destroy((sp_buthp **)&fx->buthp[j + k]);
-                sp_butbp_destroy((sp_butbp **)&fx->butbp[j + k]);
-                sp_butbr_destroy((sp_butbr **)&fx->butbr[j + k]);
-                sp_pareq_destroy((sp_pareq **)&fx->pareq[j + k]);
-                sp_moogladder_destroy((sp_moogladder **)&fx->mooglp[j + k]);
-                sp_diode_destroy((sp_diode **)&fx->diodelp[j + k]);
-                sp_wpkorg35_destroy((sp_wpkorg35 **)&fx->korglp[j + k]);
-                sp_lpf18_destroy((sp_lpf18 **)&fx->lpf18[j + k]);
-                sp_tbvcf_destroy((sp_tbvcf **)&fx->tbvcf[j + k]);
-                sp_fold_destroy((sp_fold **)&fx->fold[j + k]);
-                sp_dcblock_destroy((sp_dcblock **)&fx->dcblock[j + k]);
-                sp_lpc_destroy((sp_lpc **)&fx->lpc[j + k]);
-                sp_waveset_destroy((sp_waveset **)&fx->wset[j + k]);
+                if (fx->autowah[j + k]) {
+                    sp_autowah_destroy((sp_autowah **)&fx->autowah[j + k]);
+                }
+
+                if (fx->conv[j + k]) {
+                    sp_conv_destroy((sp_conv **)&fx->conv[j + k]);
+                }
+
+                if (fx->delay[j + k]) {
+                    sp_delay_destroy((sp_delay **)&fx->delay[j + k]);
+                }
+
+                if (fx->sdelay[j + k]) {
+                    sp_smoothdelay_destroy((sp_smoothdelay **)&fx->sdelay[j + k]);
+                }
+
+                if (fx->comb[j + k]) {
+                    sp_comb_destroy((sp_comb **)&fx->comb[j + k]);
+                }
+
+                if (fx->bitcrush[j + k]) {
+                    sp_bitcrush_destroy((sp_bitcrush **)&fx->bitcrush[j + k]);
+                }
+
+                if (fx->dist[j + k]) {
+                    sp_dist_destroy((sp_dist **)&fx->dist[j + k]);
+                }
+
+                if (fx->saturator[j + k]) {
+                    sp_saturator_destroy((sp_saturator **)&fx->saturator[j + k]);
+                }
+
+                if (fx->compressor[j + k]) {
+                    sp_compressor_destroy((sp_compressor **)&fx->compressor[j + k]);
+                }
+
+                if (fx->peaklimit[j + k]) {
+                    sp_peaklim_destroy((sp_peaklim **)&fx->peaklimit[j + k]);
+                }
+
+                if (fx->clip[j + k]) {
+                    sp_clip_destroy((sp_clip **)&fx->clip[j + k]);
+                }
+
+                if (fx->butlp[j + k]) {
+                    sp_butlp_destroy((sp_butlp **)&fx->butlp[j + k]);
+                }
+
+                if (fx->buthp[j + k]) {
+                    sp_buthp_destroy((sp_buthp **)&fx->buthp[j + k]);
+                }
+
+                if (fx->butbp[j + k]) {
+                    sp_butbp_destroy((sp_butbp **)&fx->butbp[j + k]);
+                }
+
+                if (fx->butbr[j + k]) {
+                    sp_butbr_destroy((sp_butbr **)&fx->butbr[j + k]);
+                }
+
+                if (fx->pareq[j + k]) {
+                    sp_pareq_destroy((sp_pareq **)&fx->pareq[j + k]);
+                }
+
+                if (fx->mooglp[j + k]) {
+                    sp_moogladder_destroy((sp_moogladder **)&fx->mooglp[j + k]);
+                }
+
+                if (fx->diodelp[j + k]) {
+                    sp_diode_destroy((sp_diode **)&fx->diodelp[j + k]);
+                }
+
+                if (fx->korglp[j + k]) {
+                    sp_wpkorg35_destroy((sp_wpkorg35 **)&fx->korglp[j + k]);
+                }
+
+                if (fx->lpf18[j + k]) {
+                    sp_lpf18_destroy((sp_lpf18 **)&fx->lpf18[j + k]);
+                }
+
+                if (fx->tbvcf[j + k]) {
+                    sp_tbvcf_destroy((sp_tbvcf **)&fx->tbvcf[j + k]);
+                }
+
+                if (fx->fold[j + k]) {
+                    sp_fold_destroy((sp_fold **)&fx->fold[j + k]);
+                }
+
+                if (fx->dcblock[j + k]) {
+                    sp_dcblock_destroy((sp_dcblock **)&fx->dcblock[j + k]);
+                }
+
+                if (fx->lpc[j + k]) {
+                    sp_lpc_destroy((sp_lpc **)&fx->lpc[j + k]);
+                }
+
+                if (fx->wset[j + k]) {
+                    sp_waveset_destroy((sp_waveset **)&fx->wset[j + k]);
+                }
             }
         }
 #endif
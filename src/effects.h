@@ -15,6 +15,38 @@
     #include "tools.h"
     #include "constants.h"
 
+    struct _synth_fx;
+
+#ifdef WITH_FAUST
+    // Faust effects instances of a channel, one instance of each factories per slot; swapped as a whole on Faust effects reload
+    struct _fas_faust_effects {
+        struct _fas_faust_dsp **effs[FAS_MAX_FX_SLOTS];
+        size_t len;
+    };
+#endif
+
+    // compiled channel effects chain; an entry process a block of one effect slot in place
+    typedef void (*fas_fx_process)(
+#ifdef WITH_SOUNDPIPE
+        sp_data *sp,
+#endif
+        struct _synth_fx *fx,
+        struct _synth_fx_settings *fx_settings,
+        unsigned int slot,
+        FAS_FLOAT *out_l,
+        FAS_FLOAT *out_r,
+        unsigned int len);
+
+    struct _synth_fx_chain_entry {
+        fas_fx_process process;
+        unsigned int slot;
+    };
+
+    struct _synth_fx_chain {
+        struct _synth_fx_chain_entry entries[FAS_MAX_FX_SLOTS];
+        unsigned int count;
+    };
+
     // synth. fx
     struct _synth_fx {
 #ifdef WITH_SOUNDPIPE
@@ -55,9 +87,11 @@
         FAS_FLOAT wet[FAS_MAX_FX_SLOTS * 2];
 
 #ifdef WITH_FAUST
-        struct _fas_faust_dsp **faust_effs[FAS_MAX_FX_SLOTS];
-        size_t faust_effs_len;
+        struct _fas_faust_effects *faust_effs;
 #endif
+
+        // active (non bypassed) slots; rebuilt by compileEffectsChain when the channel effects settings change
+        struct _synth_fx_chain chain;
     };
     void createEffects(
 #ifdef WITH_SOUNDPIPE
@@ -65,6 +99,15 @@
 #endif
         struct _synth_fx **fx, unsigned int max_channels, unsigned int sample_rate);
 
+#ifdef WITH_SOUNDPIPE
+    /**
+     * create the Soundpipe instances of effect fx_id for a channel slot (left / right when the effect is mono)
+     * instances are kept by the slot once created and reused when the same effect is assigned again
+     * must not be called by the audio thread (allocate)
+     **/
+    void createEffectSlot(sp_data *spd, struct _synth_fx *fx, int fx_id, unsigned int slot);
+#endif
+
     void updateEffectParameter(
 #ifdef WITH_SOUNDPIPE
         sp_data *sp,
@@ -75,6 +118,18 @@
         unsigned int target,
         FAS_FLOAT value);
 
+    void compileEffectsChain(struct _synth_fx *fx, struct _synth_chn_settings *chns);
+
+    void processEffectsChain(
+#ifdef WITH_SOUNDPIPE
+        sp_data *sp,
+#endif
+        struct _synth_fx *fx,
+        struct _synth_chn_settings *chns,
+        FAS_FLOAT *out_l,
+        FAS_FLOAT *out_r,
+        unsigned int len);
+
     void resetConvolutions(
 #ifdef WITH_SOUNDPIPE
         sp_data *sp,
@@ -135,8 +190,26 @@
     void freeEffects(struct _synth_fx **fx, unsigned int max_channels);
 
 #ifdef WITH_FAUST
+    struct _fas_faust_effects *createFaustChannelEffects(struct _faust_factories *faust_factories, unsigned int sample_rate);
+    struct _fas_faust_effects *freeFaustChannelEffects(struct _fas_faust_effects **effects);
+
     void createFaustEffects(struct _faust_factories *faust_factories, struct _synth_fx **fxs, unsigned int max_channels, unsigned int sample_rate);
     void freeFaustEffects(struct _synth_fx **fxs, unsigned int max_channels);
+
+    /**
+     * exchange channels Faust effects with the given ones (allocation free); effects then hold the previous instances
+     **/
+    void swapFaustEffects(struct _synth_fx **fxs, struct _fas_faust_effects **effects, unsigned int max_channels);
+
+    static inline struct _fas_faust_dsp *getFaustEffect(struct _synth_fx *fx, unsigned int slot, FAS_FLOAT index) {
+        struct _fas_faust_effects *effects = fx->faust_effs;
+
+        if (effects == NULL || effects->len == 0) {
+            return NULL;
+        }
+
+        return effects->effs[slot][(unsigned int)index % effects->len];
+    }
 #endif
 
 #endif
\ No newline at end of file
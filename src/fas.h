@@ -71,6 +71,11 @@
       #include "soundpipe.h"
 
       sp_data *sp = NULL;
+
+      // per instrument / channel copies of sp; computes which draw random numbers (noise, drip etc.) update their own state
+      // so instruments / channels rendered by different workers never share it and output does not depend on threads
+      sp_data *fas_instruments_sp = NULL;
+      sp_data *fas_channels_sp = NULL;
 #endif
 
     // fas
@@ -79,15 +84,24 @@
 
       struct _faust_factories *fas_faust_gens = NULL;
       struct _faust_factories *fas_faust_effs = NULL;
+
+      struct _fas_faust_voices *fas_faust_voices = NULL;
 #endif
     #include "tools.h"
     #include "effects.h"
     #include "types.h"
     #include "grains.h"
     #include "oscillators.h"
+    #include "additive.h"
+    #include "workers.h"
+    #include "decoder.h"
+    #include "scheduler.h"
+    #include "convolver.h"
+    #include "lookahead.h"
     #include "wavetables.h"
     #include "filters.h"
     #include "note.h"
+    #include "half.h"
     #include "usage.h"
     #include "time.h"
 
@@ -118,6 +132,8 @@
     char *fas_default_faust_effs_path = "./faust/effects";
     char *fas_install_default_faust_effs_path = "/usr/local/share/fragment/faust/effects";
 
+    char *fas_default_faust_cache_path = "./faust/cache";
+
     // program settings with associated default value
     unsigned int fas_sample_rate = FAS_SAMPLE_RATE;
     int fas_frames_per_buffer = FAS_FRAMES_PER_BUFFER;
@@ -135,12 +151,20 @@
     int fas_input_channels = FAS_INPUT_CHANNELS;
     int fas_output_channels = FAS_OUTPUT_CHANNELS;
     unsigned int fas_granular_max_density = FAS_GRANULAR_MAX_DENSITY;
+    unsigned int fas_granular_max_grains = FAS_GRANULAR_MAX_GRAINS;
     unsigned int frame_data_count = FAS_OUTPUT_CHANNELS / 2;
     unsigned int fas_stream_infos_send_delay = FAS_STREAM_INFOS_SEND_DELAY;
     unsigned int fas_max_drop = FAS_MAX_DROP;
     unsigned int fas_render_width = FAS_RENDER_WIDTH;
     unsigned int fas_max_instruments = FAS_MAX_INSTRUMENTS;
     unsigned int fas_max_channels = FAS_MAX_CHANNELS;
+    unsigned int fas_workers_count = FAS_WORKERS;
+    unsigned int fas_decoders_count = FAS_DECODERS;
+    unsigned int fas_partition_threshold = FAS_PARTITION_THRESHOLD;
+    unsigned int fas_lookahead = FAS_LOOKAHEAD;
+    unsigned int fas_faust_polyphony = FAS_FAUST_POLYPHONY;
+    unsigned int fas_partial_conv_polyphony = FAS_PARTIAL_CONV_POLYPHONY;
+    uint64_t fas_rand_seed = FAS_RAND_SEED;
     int fas_samplerate_converter_type = -1; // SRC_SINC_MEDIUM_QUALITY
     FAS_FLOAT fas_smooth_factor = FAS_SMOOTH_FACTOR;
     FAS_FLOAT fas_noise_amount = FAS_NOISE_AMOUNT;
@@ -156,6 +180,9 @@
     char *fas_impulses_path = NULL;
     char *fas_faust_gens_path = NULL;
     char *fas_faust_effs_path = NULL;
+    char *fas_faust_options = NULL;
+    char *fas_faust_target = NULL;
+    char *fas_faust_cache_path = NULL;
 
     unsigned int fas_drop_counter = 0;
 
@@ -176,6 +203,48 @@
     double note_time;
     FAS_FLOAT note_time_samples;
     FAS_FLOAT lerp_t_step;
+    // notes interpolation factor of each samples of the current block
+    FAS_FLOAT fas_block_lerp_t[FAS_BLOCK_SIZE];
+
+    // instruments rendering workers pool (NULL when instruments are rendered on the audio thread only)
+    struct _fas_workers *fas_workers = NULL;
+    // instruments rendering order (dependency graph of the current block)
+    struct _instruments_graph *fas_instruments_graph = NULL;
+    // rendering tasks of a graph level
+    struct _render_task *fas_render_tasks = NULL;
+
+    // frames decode pipeline (FRAME_DATA packets to notes buffers)
+    struct _fas_decoder *fas_decoder = NULL;
+    // frames format used by the decode callback; only modified while the pipeline is flushed
+    struct _fas_frames_format {
+        unsigned int h;
+        unsigned int data_size;
+        size_t frame_length;
+    } fas_frames_format;
+
+    // look-ahead mode (NULL rings when rendering happen in the device callback); output / input frames between the render thread and the device callback
+    struct _lookahead_ring *fas_output_ring = NULL;
+    struct _lookahead_ring *fas_input_ring = NULL;
+    pthread_t fas_render_thread;
+    atomic_int fas_render_thread_quit = 0;
+    // device callbacks which did not get enough frames
+    atomic_uint fas_lookahead_underruns = 0;
+
+#ifdef WITH_FAUST
+    // Faust reload; factories / instances are built by a background thread then swapped by the audio thread at a frame boundary, previous ones are freed by the reload thread
+    struct _fas_faust_reload {
+        int action; // FAS_ACTION_FAUST_GENS or FAS_ACTION_FAUST_EFFS
+        unsigned int rows;
+
+        struct _faust_factories *factories;
+        struct _fas_faust_voices *voices;
+        struct _fas_faust_effects **effects; // one per channel
+    } fas_faust_reload;
+    pthread_t fas_faust_reload_thread;
+    int fas_faust_reload_joinable = 0;
+    atomic_int fas_faust_reload_state = FAS_FAUST_RELOAD_IDLE;
+    atomic_int fas_faust_reload_quit = 0;
+#endif
 
     FAS_FLOAT last_gain_lr = 0.0;
 
@@ -220,6 +289,11 @@
     unsigned int impulses_count = 0;
     unsigned int impulses_count_m1 = 0;
 
+    // pre-transformed impulses for additive partials convolution
+    struct _fas_conv_kernels *impulses_kernels = NULL;
+    // convolvers of convolution partials (assigned on note-on)
+    struct _fas_conv_voices *fas_conv_voices = NULL;
+
     FAS_FLOAT **grain_envelope;
 
     struct _synth_fx **synth_fx = NULL; 
@@ -272,20 +346,21 @@
         free(freelist_synth_command->data);
     }
 
-    void karplusTrigger(unsigned int instrument_index, struct oscillator *osc, struct note *n) {
+    void karplusTrigger(unsigned int instrument_index, struct oscillator *osc, struct oscillators_state *state, struct note *n) {
         unsigned int d = 0;
+        unsigned int y = n->osc_index;
 
-        memset(osc->fp1[instrument_index], 0, sizeof(FAS_FLOAT) * 4);
-        memset(osc->fp2[instrument_index], 0, sizeof(FAS_FLOAT) * 4);
-        memset(osc->fp3[instrument_index], 0, sizeof(FAS_FLOAT) * 4);
-        memset(osc->fp4[instrument_index], 0, sizeof(FAS_FLOAT) * 4);
+        memset(state->fp1[y], 0, sizeof(FAS_FLOAT) * 4);
+        memset(state->fp2[y], 0, sizeof(FAS_FLOAT) * 4);
+        memset(state->fp3[y], 0, sizeof(FAS_FLOAT) * 4);
+        memset(state->fp4[y], 0, sizeof(FAS_FLOAT) * 4);
 
-        osc->pvalue[instrument_index] = 0.0f;
-        osc->fphase[instrument_index] = 0.0f;
+        state->pvalue[y] = 0.0f;
+        state->fphase[y] = 0.0f;
 
         // fill with noise & filter
         for (d = 0; d < osc->buffer_len; d += 1) {
-            unsigned int bindex = instrument_index * osc->buffer_len + d;
+            unsigned int bindex = osc->buffer_offset + d;
 #ifdef WITH_SOUNDPIPE
             FAS_FLOAT si = 0.f;
             FAS_FLOAT so = 0.f;
@@ -296,10 +371,10 @@
             streson->fdbgain = (n->res > 1.f) ? 1.f : n->res;
             sp_streson_compute(sp, streson, &si, &so);
 
-            osc->buffer[bindex] = so;
+            state->buffer[bindex] = so;
 #else
-            osc->buffer[bindex] = fas_white_noise_table[d % fas_noise_wavetable_size];
-            osc->buffer[bindex] = huovilainen_moog(osc->buffer[bindex], n->cutoff, n->res, osc->fp1[instrument_index], osc->fp2[instrument_index], osc->fp3[instrument_index], 2);
+            state->buffer[bindex] = fas_white_noise_table[d % fas_noise_wavetable_size];
+            state->buffer[bindex] = huovilainen_moog(state->buffer[bindex], n->cutoff, n->res, state->fp1[y], state->fp2[y], state->fp3[y], 2);
 #endif
         }
     }
@@ -377,8 +452,11 @@
                 synth->oscillators = freeOscillatorsBank(&synth->oscillators, synth->bank_settings->h, fas_max_instruments);
             }
 
+            synth->oscillators_state = freeOscillatorsState(&synth->oscillators_state, fas_max_instruments);
+            synth->additive_banks = freeAdditiveBanks(&synth->additive_banks, fas_max_instruments);
+
             if (synth->grains) {
-                freeGrains(&synth->grains, samples_count, fas_max_instruments, synth->bank_settings->h, fas_granular_max_density);
+                freeGrains(&synth->grains);
             }
 
             if (synth->chn_settings) {
@@ -423,7 +501,7 @@
     void initializeSynthChnSettings() {
         unsigned int i = 0, j = 0;
         
-        for (i = 0; i < fas_max_instruments; i += 1) {   
+        for (i = 0; i < fas_max_channels; i += 1) {
             for (j = 0; j < FAS_MAX_FX_SLOTS; j += 1) {  
                 curr_synth.chn_settings[i].fx[j].fx_id = -1;
                 curr_synth.chn_settings[i].fx[j].bypass = 0;
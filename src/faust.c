@@ -1,9 +1,154 @@
+#include <inttypes.h>
+#include <errno.h>
+#include <sys/stat.h>
+
 #include "tinydir/tinydir.h"
 
 #include "tools.h"
 #include "faust.h"
 
-struct _faust_factories *createFaustFactories(char *directory) {
+// FNV-1a
+static uint64_t hashFaustData(uint64_t hash, const unsigned char *data, size_t length) {
+    size_t i = 0;
+    for (i = 0; i < length; i += 1) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+static int hashFaustFile(char *filepath, uint64_t *hash) {
+    FILE *file = fopen(filepath, "rb");
+    if (file == NULL) {
+        return -1;
+    }
+
+    uint64_t h = 0xcbf29ce484222325ULL;
+
+    unsigned char buffer[4096];
+    size_t read_length = 0;
+    while ((read_length = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        h = hashFaustData(h, buffer, read_length);
+    }
+
+    int err = ferror(file);
+
+    fclose(file);
+
+    if (err) {
+        return -1;
+    }
+
+    *hash = h;
+
+    return 0;
+}
+
+// cache key of a DSP file : source code, compiler arguments, target and Faust version
+// imported files (libraries) are only known once compiled, see checkFaustImports
+static int hashFaustSource(char *filepath, char *options, char *target, uint64_t *hash) {
+    uint64_t h = 0;
+    if (hashFaustFile(filepath, &h) != 0) {
+        return -1;
+    }
+
+    // separators so that ("a", "b") and ("ab", "") differ
+    const char *version = getCLibFaustVersion();
+
+    h = hashFaustData(h, (const unsigned char *)"\0", 1);
+    if (options) {
+        h = hashFaustData(h, (const unsigned char *)options, strlen(options));
+    }
+    h = hashFaustData(h, (const unsigned char *)"\0", 1);
+    if (target) {
+        h = hashFaustData(h, (const unsigned char *)target, strlen(target));
+    }
+    h = hashFaustData(h, (const unsigned char *)"\0", 1);
+    if (version) {
+        h = hashFaustData(h, (const unsigned char *)version, strlen(version));
+    }
+
+    *hash = h;
+
+    return 0;
+}
+
+// a cached DSP is valid when all its imported files are unchanged; the imports file has one "hash path" line per imported file
+static int checkFaustImports(char *imports_filepath) {
+    FILE *file = fopen(imports_filepath, "r");
+    if (file == NULL) {
+        return -1;
+    }
+
+    int err = 0;
+
+    char line[4096];
+    while (fgets(line, sizeof(line), file)) {
+        size_t line_length = strlen(line);
+
+        uint64_t stored_hash = 0;
+        if (line_length < 19 || line[line_length - 1] != '\n' || sscanf(line, "%16" SCNx64, &stored_hash) != 1) {
+            err = -1;
+            break;
+        }
+
+        line[line_length - 1] = '\0';
+
+        uint64_t hash = 0;
+        if (hashFaustFile(&line[17], &hash) != 0 || hash != stored_hash) {
+            err = -1;
+            break;
+        }
+    }
+
+    fclose(file);
+
+    return err;
+}
+
+static int writeFaustImports(llvm_dsp_factory *factory, char *imports_filepath) {
+    const char **libraries = getCDSPFactoryLibraryList(factory);
+    if (libraries == NULL) {
+        return -1;
+    }
+
+    int err = 0;
+
+    FILE *file = fopen(imports_filepath, "w");
+    if (file == NULL) {
+        err = -1;
+    }
+
+    unsigned int i = 0;
+    for (i = 0; libraries[i]; i += 1) {
+        uint64_t hash = 0;
+        if (err == 0) {
+            if (hashFaustFile((char *)libraries[i], &hash) != 0 || fprintf(file, "%016" PRIx64 " %s\n", hash, libraries[i]) < 0) {
+                err = -1;
+            }
+        }
+
+        freeCMemory((void *)libraries[i]);
+    }
+
+    freeCMemory((void *)libraries);
+
+    if (file) {
+        if (fclose(file) != 0) {
+            err = -1;
+        }
+
+        // an incomplete imports file would validate a stale DSP
+        if (err) {
+            remove(imports_filepath);
+        }
+    }
+
+    return err;
+}
+
+struct _faust_factories *createFaustFactories(char *directory, char *options, char *target, char *cache_directory) {
     tinydir_dir dir;
     int ret = tinydir_open_sorted(&dir, directory);
 
@@ -21,6 +166,50 @@ struct _faust_factories *createFaustFactories(char *directory) {
 
     char error_msg[4096];
 
+    // compiler arguments
+    const char *argv[FAS_FAUST_MAX_OPTIONS + 1] = { 0 };
+    int argc = 0;
+
+    char *options_copy = NULL;
+    if (options) {
+        size_t options_length = strlen(options);
+        options_copy = (char *)malloc(sizeof(char) * (options_length + 1));
+        if (options_copy == NULL) {
+            printf("createFaustFactories alloc. error.");
+            fflush(stdout);
+
+            // compiled without options (and cached as such)
+            options = NULL;
+        } else {
+            memcpy(options_copy, options, options_length + 1);
+
+            char *arg = strtok(options_copy, " ");
+            while (arg && argc < FAS_FAUST_MAX_OPTIONS) {
+                argv[argc++] = arg;
+
+                arg = strtok(NULL, " ");
+            }
+        }
+    }
+
+    // compiled DSP cache
+    if (cache_directory && cache_directory[0] == '\0') {
+        cache_directory = NULL;
+    }
+
+    if (cache_directory) {
+#if defined(_WIN32) || defined(_WIN64)
+        int mkdir_err = mkdir(cache_directory);
+#else
+        int mkdir_err = mkdir(cache_directory, 0755);
+#endif
+        if (mkdir_err == -1 && errno != EEXIST) {
+            printf("Faust cache directory '%s' cannot be created, cache disabled.\n", cache_directory);
+
+            cache_directory = NULL;
+        }
+    }
+
     tinydir_file file;
 
     unsigned int f = 0;
@@ -49,14 +238,56 @@ struct _faust_factories *createFaustFactories(char *directory) {
                 continue;
             }
 
-            //
-            const char* argv1[1] = { 0 };
+            llvm_dsp_factory *dsp_factory = NULL;
+
+            // unchanged DSP (and imported libraries) are loaded from cache as machine code
+            char *cache_filepath = NULL;
+            char *imports_filepath = NULL;
+
+            uint64_t hash = 0;
+            if (cache_directory && hashFaustSource(filepath, options, target, &hash) == 0) {
+                char cache_filename[32];
+                snprintf(cache_filename, sizeof(cache_filename), "%016" PRIx64 ".fmc", hash);
+
+                cache_filepath = create_filepath(cache_directory, cache_filename);
+
+                snprintf(cache_filename, sizeof(cache_filename), "%016" PRIx64 ".imports", hash);
+
+                imports_filepath = create_filepath(cache_directory, cache_filename);
+                if (imports_filepath == NULL) {
+                    free(cache_filepath);
+                    cache_filepath = NULL;
+                }
+            }
+
+            int cached = 0;
+            if (cache_filepath) {
+                struct stat s;
+                if (stat(cache_filepath, &s) == 0 && checkFaustImports(imports_filepath) == 0) {
+                    dsp_factory = readCDSPFactoryFromMachineFile(cache_filepath, target ? target : "", error_msg);
+
+                    cached = (dsp_factory != NULL);
+                }
+            }
+
+            if (dsp_factory == NULL) {
+                dsp_factory = createCDSPFactoryFromFile(filepath, argc, argv, target ? target : "", error_msg, -1);
+
+                if (dsp_factory && cache_filepath) {
+                    if (!writeCDSPFactoryToMachineFile(dsp_factory, cache_filepath, target ? target : "") ||
+                        writeFaustImports(dsp_factory, imports_filepath) != 0) {
+                        fprintf(stdout, "DSP code '%s' cannot be cached to '%s'.\n", file.name, cache_filepath);
+                    }
+                }
+            }
+
+            free(cache_filepath);
+            free(imports_filepath);
 
-            llvm_dsp_factory *dsp_factory = createCDSPFactoryFromFile(filepath, 0, argv1, "", error_msg, -1);
             if (dsp_factory) {
                 fl->factories[fl->len] = dsp_factory;
 
-                fprintf(stdout, "DSP code %lu '%s' loaded.\n", fl->len, file.name);
+                fprintf(stdout, "DSP code %lu '%s' loaded%s.\n", fl->len, file.name, cached ? " (cache)" : "");
 
                 fl->len += 1;
             } else {
@@ -69,6 +300,7 @@ struct _faust_factories *createFaustFactories(char *directory) {
     }
 
     free(current_dir);
+    free(options_copy);
 
     tinydir_close(&dir);
 
@@ -118,6 +350,23 @@ struct _fas_faust_ui_control *getFaustControl(struct _fas_faust_ui_control *ctrl
     return NULL;
 }
 
+// known controls labels indexed by zone
+static char *fas_faust_zones_labels[FAS_FAUST_ZONES] = {
+    "fs_p0", "fs_p1", "fs_p2", "fs_p3", "fs_p4", "fs_p5", "fs_p6", "fs_p7", "fs_p8", "fs_p9",
+    "fs_freq", "fs_freq_prev", "fs_freq_next", "fs_bw",
+    "fs_pr", "fs_pg", "fs_r", "fs_g", "fs_b", "fs_a"
+};
+
+void resolveFaustZones(struct _fas_faust_dsp *fdsp) {
+    unsigned int i = 0;
+
+    for (i = 0; i < FAS_FAUST_ZONES; i += 1) {
+        struct _fas_faust_ui_control *ctrl = getFaustControl(fdsp->controls, fas_faust_zones_labels[i]);
+
+        fdsp->zones[i] = ctrl ? ctrl->zone : NULL;
+    }
+}
+
 void freeFaustControls(struct _fas_faust_ui_control *ctrl) {
     struct _fas_faust_ui_control *tmp;
 
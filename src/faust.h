@@ -5,6 +5,20 @@
 
 #include "faust/dsp/llvm-c-dsp.h"
 
+// known controls (resolved once per DSP, see resolveFaustZones)
+#define FAS_FAUST_ZONE_P0 0 // fs_p0 ... fs_p9 follow
+#define FAS_FAUST_ZONE_FREQ 10
+#define FAS_FAUST_ZONE_FREQ_PREV 11
+#define FAS_FAUST_ZONE_FREQ_NEXT 12
+#define FAS_FAUST_ZONE_BW 13
+#define FAS_FAUST_ZONE_PR 14
+#define FAS_FAUST_ZONE_PG 15
+#define FAS_FAUST_ZONE_R 16
+#define FAS_FAUST_ZONE_G 17
+#define FAS_FAUST_ZONE_B 18
+#define FAS_FAUST_ZONE_A 19
+#define FAS_FAUST_ZONES 20
+
 struct _fas_faust_ui_control {
     FAUSTFLOAT *zone;
     char label[34];
@@ -79,14 +93,31 @@ struct _fas_faust_dsp {
     llvm_dsp *dsp;
     UIGlue *ui;
     struct _fas_faust_ui_control *controls;
+
+    // known controls zones (NULL when the DSP does not have the control)
+    FAUSTFLOAT *zones[FAS_FAUST_ZONES];
 };
 
+// resolve known controls zones; must be called once the DSP UI is built
+extern void resolveFaustZones(struct _fas_faust_dsp *fdsp);
+
+// set a known control, the zone is only written when the value change
+static inline void setFaustZone(struct _fas_faust_dsp *fdsp, unsigned int zone, FAUSTFLOAT value) {
+    FAUSTFLOAT *z = fdsp->zones[zone];
+
+    if (z && *z != value) {
+        *z = value;
+    }
+}
+
 struct _faust_factories {
     llvm_dsp_factory **factories;
     size_t len;
 };
 
-extern struct _faust_factories *createFaustFactories(char *directory);
+// options are Faust compiler arguments separated by spaces (-vec -vs 32 etc.), target is the LLVM target (empty for host)
+// compiled DSP are saved as machine code into cache_directory (NULL to disable) with a name derived from the source code, options, target and Faust version
+extern struct _faust_factories *createFaustFactories(char *directory, char *options, char *target, char *cache_directory);
 extern void freeFaustFactories(struct _faust_factories *fl);
 
 #endif
\ No newline at end of file
@@ -1,180 +1,310 @@
+#include <stdio.h>
+#include <string.h>
+
 #include "grains.h"
 
 // granular synthesis : grains setup
-// all possible grains (and sub-grains from max_density parameter) are pre-computed in memory
-struct grain *createGrains(struct sample **s, unsigned int samples_count, unsigned int n, FAS_FLOAT base_frequency, unsigned int octaves, unsigned int sample_rate, unsigned int max_instruments, unsigned int max_density) {
-    if (samples_count == 0) {
+// each instrument has a pool of (at most max_grains) active grains, grains state is only allocated once here
+struct _fas_grains *createGrains(unsigned int n, FAS_FLOAT base_frequency, unsigned int octaves, unsigned int sample_rate, unsigned int max_instruments, unsigned int max_grains) {
+    struct _fas_grains *g = (struct _fas_grains *)calloc(1, sizeof(struct _fas_grains));
+
+    if (g == NULL) {
+        printf("createGrains alloc. error.");
+        fflush(stdout);
         return NULL;
     }
 
-    unsigned int grains_count = n * max_density * samples_count;
-    unsigned int y = 0;
+    g->n = n;
+    g->sample_rate = sample_rate;
+    g->base_frequency = base_frequency;
+    g->octave_length = (FAS_FLOAT)n / octaves;
+    g->max_instruments = max_instruments;
+
+    g->pools = (struct _fas_grains_pool *)calloc(max_instruments, sizeof(struct _fas_grains_pool));
+    if (g->pools == NULL) {
+        printf("createGrains alloc. error.");
+        fflush(stdout);
+
+        return freeGrains(&g);
+    }
+
+    unsigned int i = 0;
+    for (i = 0; i < max_instruments; i += 1) {
+        struct _fas_grains_pool *pool = &g->pools[i];
+
+        pool->capacity = max_grains;
+        pool->count = 0;
+
+        pool->frame = (FAS_FLOAT *)calloc(max_grains, sizeof(FAS_FLOAT));
+        pool->speed = (FAS_FLOAT *)calloc(max_grains, sizeof(FAS_FLOAT));
+        pool->env_index = (FAS_FLOAT *)calloc(max_grains, sizeof(FAS_FLOAT));
+        pool->env_step = (FAS_FLOAT *)calloc(max_grains, sizeof(FAS_FLOAT));
+        pool->frames = (unsigned int *)calloc(max_grains, sizeof(unsigned int));
+        pool->osc_index = (unsigned int *)calloc(max_grains, sizeof(unsigned int));
+        pool->smp_index = (unsigned int *)calloc(max_grains, sizeof(unsigned int));
+        pool->note = (unsigned int *)calloc(max_grains, sizeof(unsigned int));
+        pool->fade = (unsigned char *)calloc(max_grains, sizeof(unsigned char));
+        pool->counts = (unsigned int *)calloc(n * 2, sizeof(unsigned int));
+
+        if (pool->frame == NULL || pool->speed == NULL || pool->env_index == NULL || pool->env_step == NULL ||
+            pool->frames == NULL || pool->osc_index == NULL || pool->smp_index == NULL || pool->note == NULL ||
+            pool->fade == NULL || pool->counts == NULL) {
+            printf("createGrains alloc. error.");
+            fflush(stdout);
+
+            return freeGrains(&g);
+        }
+    }
+
+    return g;
+}
+
+// notes of an instrument are ordered by descending oscillator index
+static int findGrainNote(struct note *notes, unsigned int s, unsigned int e, unsigned int osc_index) {
+    unsigned int lo = s, hi = e;
+
+    while (lo < hi) {
+        unsigned int mid = lo + (hi - lo) / 2;
+        unsigned int mid_osc_index = notes[mid].osc_index;
+
+        if (mid_osc_index == osc_index) {
+            return mid;
+        } else if (mid_osc_index > osc_index) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return -1;
+}
+
+static void retireGrain(struct _fas_grains_pool *pool, unsigned int i) {
+    unsigned int last = pool->count - 1;
+
+    pool->frame[i] = pool->frame[last];
+    pool->speed[i] = pool->speed[last];
+    pool->env_index[i] = pool->env_index[last];
+    pool->env_step[i] = pool->env_step[last];
+    pool->frames[i] = pool->frames[last];
+    pool->osc_index[i] = pool->osc_index[last];
+    pool->smp_index[i] = pool->smp_index[last];
+    pool->note[i] = pool->note[last];
+    pool->fade[i] = pool->fade[last];
+
+    pool->count = last;
+}
+
+static void spawnGrains(struct _fas_grains_pool *pool, unsigned int note_index, struct note *n, unsigned int smp_index, unsigned char fade, unsigned int count) {
+    unsigned int d = 0;
+
+    for (d = 0; d < count && pool->count < pool->capacity; d += 1) {
+        unsigned int i = pool->count;
+
+        pool->osc_index[i] = n->osc_index;
+        pool->smp_index[i] = smp_index;
+        pool->note[i] = note_index;
+        pool->fade[i] = fade;
+        // started on first computation
+        pool->env_index[i] = FAS_ENVS_SIZE;
+
+        pool->count += 1;
+    }
+}
+
+void updateGrains(struct _fas_grains_pool *pool, struct note *notes, unsigned int s, unsigned int e) {
+    unsigned int i = 0, j = 0;
 
-    FAS_FLOAT octave_length = (FAS_FLOAT)n / octaves;
+    memset(pool->counts, 0, sizeof(unsigned int) * (e - s) * 2);
 
-    struct sample *samples = *s;
+    while (i < pool->count) {
+        int note_index = findGrainNote(notes, s, e, pool->osc_index[i]);
 
-    struct grain *g = (struct grain *)calloc(grains_count, sizeof(struct grain));
-    for (unsigned int i = 0; i < grains_count; i += samples_count) {
-        for (unsigned int k = 0; k < samples_count; k += 1) {
-            int gr_index = i + k;
+        if (note_index >= 0) {
+            struct note *n = &notes[note_index];
 
-            struct sample *smp = &samples[k];
+            unsigned int *counts = &pool->counts[(note_index - s) * 2];
+            unsigned int smp_index = pool->smp_index[i];
 
-            FAS_FLOAT frequency = base_frequency * pow(2, (n-y) / octave_length);
+            int fade = -1;
+            if (smp_index == n->smp_index && counts[0] < n->density) {
+                counts[0] += 1;
 
-            FAS_FLOAT grain_speed = frequency / smp->pitch / ((FAS_FLOAT)sample_rate / (FAS_FLOAT)smp->samplerate);
+                fade = 0;
+            } else if (smp_index == n->psmp_index && smp_index != n->smp_index && counts[1] < n->density) {
+                counts[1] += 1;
 
-            if (grain_speed <= 0) {
-                grain_speed = 1;
+                fade = 1;
             }
 
-            // channels dependent parameters
-            g[gr_index].frame = calloc(max_instruments, sizeof(FAS_FLOAT));
-            g[gr_index].frames = calloc(max_instruments, sizeof(unsigned int));
-            //g[gr_index].index = calloc(max_instruments, sizeof(unsigned int));
-            g[gr_index].env_index = calloc(max_instruments, sizeof(FAS_FLOAT));
-            g[gr_index].env_step = calloc(max_instruments, sizeof(FAS_FLOAT));
-            g[gr_index].smp_index = calloc(max_instruments, sizeof(unsigned int));
-            g[gr_index].density = calloc(max_instruments, sizeof(unsigned int));
-            g[gr_index].speed = calloc(max_instruments, sizeof(FAS_FLOAT));
-
-            // initialization for each simultaneous channels
-            for (unsigned int j = 0; j < max_instruments; j += 1) {
-                g[gr_index].env_index[j] = FAS_ENVS_SIZE;
-                g[gr_index].smp_index[j] = k;
-                g[gr_index].density[j] = 1;
-                g[gr_index].speed[j] = grain_speed;
+            if (fade >= 0) {
+                pool->note[i] = note_index;
+                pool->fade[i] = fade;
+
+                // force grains creation on note-on or sample change
+                if ((n->previous_volume_l <= 0 && n->previous_volume_r <= 0) || (!fade && n->smp_index != n->psmp_index)) {
+                    pool->env_index[i] = FAS_ENVS_SIZE;
+                }
+
+                i += 1;
+
+                continue;
             }
         }
-        y++;
-        y = y % n;
+
+        retireGrain(pool, i);
     }
 
-    return g;
+    for (j = s; j < e; j += 1) {
+        struct note *n = &notes[j];
+
+        unsigned int *counts = &pool->counts[(j - s) * 2];
+
+        spawnGrains(pool, j, n, n->smp_index, 0, n->density - counts[0]);
+
+        // allow real-time sample change : previous sample grains are cross-faded
+        if (n->psmp_index != n->smp_index) {
+            spawnGrains(pool, j, n, n->psmp_index, 1, n->density - counts[1]);
+        }
+    }
 }
 
-inline void computeGrains(unsigned int channel, struct grain *g, unsigned int grain_index, FAS_FLOAT alpha, unsigned int si, unsigned int density, FAS_FLOAT density_offset, FAS_FLOAT *gr_env, struct sample *samples, unsigned int smp_index, unsigned int sample_rate, FAS_FLOAT min_duration, FAS_FLOAT max_duration, FAS_FLOAT *out_l, FAS_FLOAT *out_r) {
-    struct grain *gr = &g[grain_index];
-    struct sample *smp = &samples[smp_index];
+static void startGrain(struct _fas_grains *g, struct _fas_grains_pool *pool, unsigned int i, FAS_FLOAT alpha, struct sample *smp, FAS_FLOAT density_offset, FAS_FLOAT min_duration, FAS_FLOAT max_duration) {
+    FAS_FLOAT frequency = g->base_frequency * pow(2, (g->n - pool->osc_index[i]) / g->octave_length);
 
-    //unsigned int density_start = density_offset * si;
+    FAS_FLOAT gr_speed = frequency / smp->pitch / ((FAS_FLOAT)g->sample_rate / (FAS_FLOAT)smp->samplerate);
 
-    for (unsigned int d = /*density_start*/0; d < (/*density_start + */si * gr->density[channel]); d += si) {
-        gr = &g[grain_index + d];
+    if (gr_speed <= 0) {
+        gr_speed = 1;
+    }
 
-        FAS_FLOAT env_index = gr->env_index[channel];
+    FAS_FLOAT grain_start = (FAS_FLOAT)smp->frames - 1.0f;
+    FAS_FLOAT grain_position = fabs(alpha);
+    grain_start = roundf(grain_start * fmax(fmin(grain_position, 1.0f), 0.0f) + (grain_start * (density_offset * randf(0.0f, 1.0f))));
 
-        if (env_index >= FAS_ENVS_SIZE) {
-            FAS_FLOAT gr_speed = gr->speed[channel];
+    pool->frames[i] = roundf(fmax(randf(GRAIN_MIN_DURATION + min_duration, max_duration), GRAIN_MIN_DURATION) * (FAS_FLOAT)g->sample_rate);
+    pool->env_step[i] = fmax(((FAS_FLOAT)(FAS_ENVS_SIZE)) / ((FAS_FLOAT)pool->frames[i] / gr_speed), 0.00000001);
+    pool->env_index[i] = 0.0f;
 
-            FAS_FLOAT grain_start = (FAS_FLOAT)smp->frames - 1.0f;
-            FAS_FLOAT grain_position = fabs(alpha);
-            grain_start = roundf(grain_start * fmax(fmin(grain_position, 1.0f), 0.0f) + (grain_start * (density_offset * randf(0.0f, 1.0f))));//(1.0f - randf(0.0f, 1.0f) * floor(fmin(grain_position - 0.0001f, 1.0f))));
+    pool->frame[i] = grain_start + pool->frames[i];
 
-            //gr->index[k] = grain_start;
-            // old algorithm (percent of sample length, no cycles)
-            // roundf(grain_start + fmax(randf(GRAIN_MIN_DURATION + min_duration, max_duration), GRAIN_MIN_DURATION) * (smp->frames - grain_start - 1)) + 1;
-            gr->frames[channel] = roundf(fmax(randf(GRAIN_MIN_DURATION + min_duration, max_duration), GRAIN_MIN_DURATION) * (FAS_FLOAT)sample_rate);
-            gr->env_step[channel] = fmax(((FAS_FLOAT)(FAS_ENVS_SIZE)) / (((FAS_FLOAT)gr->frames[channel]/* - (FAS_FLOAT)grain_start*/) / fabs(gr_speed)), 0.00000001);
-            gr->env_index[channel] = 0.0f;
-            gr->density[channel] = density;
+    if (alpha < 0.0f) {
+        pool->speed[i] = -gr_speed;
+    } else {
+        pool->speed[i] = gr_speed;
 
-            if (alpha < 0.0f) {
-                if (gr_speed > 0.0f) {
-                    gr->speed[channel] = -gr_speed;
-                }
+        if (pool->frame[i] > ((FAS_FLOAT)smp->frames - 1.0f)) {
+            pool->frame[i] -= ((FAS_FLOAT)smp->frames - 1.0f) + 1;
+        }
+    }
+}
 
-                gr->frame[channel] = grain_start + gr->frames[channel];
-            } else {
-                gr->speed[channel] = fabs(gr_speed);
+void computeGrains(struct _fas_grains *g, struct _fas_grains_pool *pool, struct note *notes, unsigned int s, unsigned int e, struct sample *samples, FAS_FLOAT *gr_env, FAS_FLOAT density_offset, FAS_FLOAT min_duration, FAS_FLOAT max_duration, FAS_FLOAT *lerp_t, unsigned int len, FAS_FLOAT *out_l, FAS_FLOAT *out_r) {
+    unsigned int i = 0, b = 0;
 
-                gr->frame[channel] = grain_start + gr->frames[channel];
-                if (gr->frame[channel] > ((FAS_FLOAT)smp->frames - 1.0f)) {
-                    gr->frame[channel] -= ((FAS_FLOAT)smp->frames - 1.0f) + 1;
-                }
-            }
+    for (i = 0; i < pool->count; i += 1) {
+        // grains matched against another frame (instrument type changed mid-frame) wait for the next update
+        if (pool->note[i] < s || pool->note[i] >= e) {
+            continue;
         }
 
-        FAS_FLOAT pos = gr->frame[channel];
+        struct note *n = &notes[pool->note[i]];
+        struct sample *smp = &samples[pool->smp_index[i]];
 
-        unsigned int sample_index = ((unsigned int)pos) % smp->frames;
-        unsigned int sample_index2 = sample_index + 1;
+        FAS_FLOAT last_frame = (FAS_FLOAT)smp->frames - 1.0f;
 
-        FAS_FLOAT smp_l = smp->data_l[sample_index];
-        FAS_FLOAT smp_r = smp->data_r[sample_index];
+        // cross-faded grains (previous sample) use the normalized density and fade out over the frame
+        FAS_FLOAT gain = pool->fade[i] ? n->norm_density : (FAS_FLOAT)n->density;
+        FAS_FLOAT fade = pool->fade[i] ? 1.0f : 0.0f;
 
-        FAS_FLOAT smp_l2 = smp->data_l[sample_index2];
-        FAS_FLOAT smp_r2 = smp->data_r[sample_index2];
+        for (b = 0; b < len; b += 1) {
+            if (pool->env_index[i] >= FAS_ENVS_SIZE) {
+                startGrain(g, pool, i, n->alpha, smp, density_offset, min_duration, max_duration);
+            }
 
-        FAS_FLOAT mu = pos - (FAS_FLOAT)sample_index;
+            FAS_FLOAT pos = pool->frame[i];
+
+            unsigned int sample_index = ((unsigned int)pos) % smp->frames;
+            unsigned int sample_index2 = sample_index + 1;
+
+            FAS_FLOAT smp_l = smp->data_l[sample_index];
+            FAS_FLOAT smp_r = smp->data_r[sample_index];
+
+            FAS_FLOAT smp_l2 = smp->data_l[sample_index2];
+            FAS_FLOAT smp_r2 = smp->data_r[sample_index2];
+
+            FAS_FLOAT mu = pos - (FAS_FLOAT)sample_index;
 
 #ifdef FAS_USE_CUBIC_INTERP
-        unsigned int sample_index3 = sample_index2 + 1;
-        unsigned int sample_index4 = sample_index3 + 1;
+            unsigned int sample_index3 = sample_index2 + 1;
+            unsigned int sample_index4 = sample_index3 + 1;
 
-        FAS_FLOAT smp_l3 = smp->data_l[sample_index3];
-        FAS_FLOAT smp_r3 = smp->data_r[sample_index3];
+            FAS_FLOAT smp_l3 = smp->data_l[sample_index3];
+            FAS_FLOAT smp_r3 = smp->data_r[sample_index3];
 
-        FAS_FLOAT smp_l4 = smp->data_l[sample_index4];
-        FAS_FLOAT smp_r4 = smp->data_r[sample_index4];
+            FAS_FLOAT smp_l4 = smp->data_l[sample_index4];
+            FAS_FLOAT smp_r4 = smp->data_r[sample_index4];
 
-        FAS_FLOAT smp_lv = smp_l2 + 0.5 * mu*(smp_l3 - smp_l + mu*(2.0*smp_l - 5.0*smp_l2 + 4.0*smp_l3 - smp_l4 + mu*(3.0*(smp_l2 - smp_l3) + smp_l4 - smp_l)));
-        FAS_FLOAT smp_rv = smp_r2 + 0.5 * mu*(smp_r3 - smp_r + mu*(2.0*smp_r - 5.0*smp_r2 + 4.0*smp_r3 - smp_r4 + mu*(3.0*(smp_r2 - smp_r3) + smp_r4 - smp_r)));
+            FAS_FLOAT smp_lv = smp_l2 + 0.5 * mu*(smp_l3 - smp_l + mu*(2.0*smp_l - 5.0*smp_l2 + 4.0*smp_l3 - smp_l4 + mu*(3.0*(smp_l2 - smp_l3) + smp_l4 - smp_l)));
+            FAS_FLOAT smp_rv = smp_r2 + 0.5 * mu*(smp_r3 - smp_r + mu*(2.0*smp_r - 5.0*smp_r2 + 4.0*smp_r3 - smp_r4 + mu*(3.0*(smp_r2 - smp_r3) + smp_r4 - smp_r)));
 #else
-        FAS_FLOAT smp_lv = smp_l + mu * (smp_l2 - smp_l);
-        FAS_FLOAT smp_rv = smp_r + mu * (smp_r2 - smp_r);
+            FAS_FLOAT smp_lv = smp_l + mu * (smp_l2 - smp_l);
+            FAS_FLOAT smp_rv = smp_r + mu * (smp_r2 - smp_r);
 #endif
 
-        FAS_FLOAT env = gr_env[(unsigned int)round(env_index)];
+            FAS_FLOAT env = gr_env[(unsigned int)round(pool->env_index[i])] * gain * (1.0f - fade * lerp_t[b]);
 
-        *out_l += smp_lv * env;
-        *out_r += smp_rv * env;
+            FAS_FLOAT vl = n->previous_volume_l + n->diff_volume_l * lerp_t[b];
+            FAS_FLOAT vr = n->previous_volume_r + n->diff_volume_r * lerp_t[b];
 
-        gr->frame[channel] += gr->speed[channel];
+            out_l[b] += vl * smp_lv * env;
+            out_r[b] += vr * smp_rv * env;
 
-        if (gr->frame[channel] < 0) {
-            gr->frame[channel] = ((FAS_FLOAT)smp->frames - 1.0f);
-        }
+            pool->frame[i] += pool->speed[i];
 
-        if (gr->frame[channel] > ((FAS_FLOAT)smp->frames - 1.0f)) {
-            gr->frame[channel] = 0;
-        }
+            if (pool->frame[i] < 0) {
+                pool->frame[i] = last_frame;
+            }
 
-        gr->env_index[channel] += gr->env_step[channel];
-    }
-}
+            if (pool->frame[i] > last_frame) {
+                pool->frame[i] = 0;
+            }
 
-struct grain *freeGrains(struct grain **g, unsigned int samples_count, unsigned int max_instruments, unsigned int n, unsigned int max_density) {
-    if (samples_count == 0) {
-        return NULL;
+            pool->env_index[i] += pool->env_step[i];
+        }
     }
+}
 
-    struct grain *grains = *g;
+struct _fas_grains *freeGrains(struct _fas_grains **g) {
+    struct _fas_grains *grains = *g;
 
     if (grains == NULL) {
         return NULL;
     }
 
-    unsigned int grains_count = n * max_density * samples_count;
-
-    unsigned int y = 0;
-    for (y = 0; y < grains_count; y += samples_count) {
-        for (unsigned int k = 0; k < samples_count; k += 1) {
-            int gr_index = y + k;
-
-            free(grains[gr_index].frame);
-            free(grains[gr_index].frames);
-            //free(grains[gr_index].index);
-            free(grains[gr_index].env_index);
-            free(grains[gr_index].env_step);
-            free(grains[gr_index].smp_index);
-            free(grains[gr_index].density);
-            free(grains[gr_index].speed);
+    if (grains->pools) {
+        unsigned int i = 0;
+        for (i = 0; i < grains->max_instruments; i += 1) {
+            struct _fas_grains_pool *pool = &grains->pools[i];
+
+            free(pool->frame);
+            free(pool->speed);
+            free(pool->env_index);
+            free(pool->env_step);
+            free(pool->frames);
+            free(pool->osc_index);
+            free(pool->smp_index);
+            free(pool->note);
+            free(pool->fade);
+            free(pool->counts);
         }
+
+        free(grains->pools);
     }
 
     free(grains);
 
+    *g = NULL;
+
     return NULL;
 }
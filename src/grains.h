@@ -5,23 +5,55 @@
 
     #include "tools.h"
     #include "samples.h"
+    #include "note.h"
     #include "constants.h"
 
-    typedef struct grain grain;
+    /**
+     * per instrument pool of active grains (structure of arrays); [0, count) are the active grains
+     * grains are spawned / retired in place (swap with the last one) so that mixing is a linear scan
+     **/
+    struct _fas_grains_pool {
+        unsigned int capacity;
+        unsigned int count;
 
-    struct grain {
         FAS_FLOAT *frame; // current sample position
-        unsigned int *frames; // duration
-        //unsigned int *index; // grain position
-        unsigned int *density; // grain density
-        unsigned int *smp_index;
         FAS_FLOAT *speed; // sample-based step
         FAS_FLOAT *env_index;
         FAS_FLOAT *env_step;
+        unsigned int *frames; // duration
+
+        // owner oscillator, sample and note (notes buffer index of the current frame)
+        unsigned int *osc_index;
+        unsigned int *smp_index;
+        unsigned int *note;
+        // 1 when the grain sample is the note previous sample (cross-fade out)
+        unsigned char *fade;
+
+        // grains count per note (current / previous sample) used when matching grains against notes
+        unsigned int *counts;
     };
 
-    extern struct grain *createGrains(struct sample **samples, unsigned int samples_count, unsigned int n, FAS_FLOAT base_frequency, unsigned int octaves, unsigned int sample_rate, unsigned int max_instruments, unsigned int max_density);
-    extern void computeGrains(unsigned int channel, struct grain *g, unsigned int grain_index, FAS_FLOAT alpha, unsigned int si, unsigned int density, FAS_FLOAT density_offset, FAS_FLOAT *gr_env, struct sample *samples, unsigned int smp_index, unsigned int sample_rate, FAS_FLOAT min_duration, FAS_FLOAT max_duration, FAS_FLOAT *out_l, FAS_FLOAT *out_r);
-    extern struct grain *freeGrains(struct grain **g, unsigned int samples_count, unsigned int max_instruments, unsigned int n, unsigned int max_density);
+    struct _fas_grains {
+        unsigned int n;
+        unsigned int sample_rate;
+        FAS_FLOAT base_frequency;
+        FAS_FLOAT octave_length;
+
+        unsigned int max_instruments;
+        struct _fas_grains_pool *pools;
+    };
+
+    extern struct _fas_grains *createGrains(unsigned int n, FAS_FLOAT base_frequency, unsigned int octaves, unsigned int sample_rate, unsigned int max_instruments, unsigned int max_grains);
+
+    /**
+     * match pool grains against an instrument notes [s, e) (once per frame) : retire orphan / extra grains then spawn missing ones
+     **/
+    extern void updateGrains(struct _fas_grains_pool *pool, struct note *notes, unsigned int s, unsigned int e);
+
+    /**
+     * mix an instrument active grains over a block; grains are (re)started in place when their envelope end
+     **/
+    extern void computeGrains(struct _fas_grains *g, struct _fas_grains_pool *pool, struct note *notes, unsigned int s, unsigned int e, struct sample *samples, FAS_FLOAT *gr_env, FAS_FLOAT density_offset, FAS_FLOAT min_duration, FAS_FLOAT max_duration, FAS_FLOAT *lerp_t, unsigned int len, FAS_FLOAT *out_l, FAS_FLOAT *out_r);
+    extern struct _fas_grains *freeGrains(struct _fas_grains **g);
 
 #endif
@@ -0,0 +1,65 @@
+#ifndef _FAS_HALF_H_
+#define _FAS_HALF_H_
+
+    #include <stdint.h>
+    #include <string.h>
+
+    // IEEE half float conversion (FAS_FRAME_DATA_HALF frames), hardware conversion when the target has it
+#if defined(__F16C__)
+    #include <immintrin.h>
+
+    #define FAS_HALF_F16C
+#elif defined(USE_NEON) && (defined(__ARM_NEON) || defined(__NEON__)) && defined(__ARM_FP) && (__ARM_FP & 2)
+    #include <arm_neon.h>
+
+    #define FAS_HALF_NEON
+#endif
+
+    static inline float halfToFloat(uint16_t h) {
+        uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+        uint32_t exponent = (h >> 10) & 0x1f;
+        uint32_t mantissa = h & 0x3ff;
+        uint32_t bits;
+
+        if (exponent == 0) {
+            if (mantissa == 0) {
+                bits = sign;
+            } else {
+                // subnormal; normalized as a float
+                exponent = 127 - 15 + 1;
+
+                while ((mantissa & 0x400) == 0) {
+                    mantissa <<= 1;
+                    exponent -= 1;
+                }
+
+                bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+            }
+        } else if (exponent == 0x1f) {
+            // inf / nan
+            bits = sign | 0x7f800000 | (mantissa << 13);
+        } else {
+            bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+        }
+
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+
+        return f;
+    }
+
+    // convert one RGBA row
+    static inline void halfToFloat4(const uint16_t *src, float *dst) {
+#if defined(FAS_HALF_F16C)
+        _mm_storeu_ps(dst, _mm_cvtph_ps(_mm_loadl_epi64((const __m128i *)src)));
+#elif defined(FAS_HALF_NEON)
+        vst1q_f32(dst, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(src))));
+#else
+        dst[0] = halfToFloat(src[0]);
+        dst[1] = halfToFloat(src[1]);
+        dst[2] = halfToFloat(src[2]);
+        dst[3] = halfToFloat(src[3]);
+#endif
+    }
+
+#endif
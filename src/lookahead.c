@@ -0,0 +1,140 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "lookahead.h"
+#include "tools.h"
+
+struct _lookahead_ring *createLookaheadRing(unsigned int frames, unsigned int channels) {
+    struct _lookahead_ring *ring = (struct _lookahead_ring *)alignedCalloc(FAS_CACHE_LINE_SIZE, sizeof(struct _lookahead_ring));
+    if (ring == NULL) {
+        printf("createLookaheadRing alloc. error.");
+        fflush(stdout);
+        return NULL;
+    }
+
+    // power of two capacity so positions can simply wrap around
+    unsigned int capacity = 1;
+    while (capacity < frames) {
+        capacity <<= 1;
+    }
+
+    ring->channels = channels;
+    ring->frames = capacity;
+
+    ring->data = (float *)calloc(capacity * channels, sizeof(float));
+    ring->block = (float *)calloc(FAS_BLOCK_SIZE * channels, sizeof(float));
+    ring->block_channels = (float **)calloc(channels, sizeof(float *));
+
+    if (ring->data == NULL || ring->block == NULL || ring->block_channels == NULL) {
+        printf("createLookaheadRing alloc. error.");
+        fflush(stdout);
+
+        return freeLookaheadRing(&ring);
+    }
+
+    unsigned int c = 0;
+    for (c = 0; c < channels; c += 1) {
+        ring->block_channels[c] = &ring->block[c * FAS_BLOCK_SIZE];
+    }
+
+    atomic_init(&ring->write_position, 0);
+    atomic_init(&ring->read_position, 0);
+
+    return ring;
+}
+
+unsigned int lookaheadReadable(struct _lookahead_ring *ring) {
+    unsigned int write_position = atomic_load_explicit(&ring->write_position, memory_order_acquire);
+    unsigned int read_position = atomic_load_explicit(&ring->read_position, memory_order_relaxed);
+
+    return write_position - read_position;
+}
+
+unsigned int lookaheadWritable(struct _lookahead_ring *ring) {
+    unsigned int write_position = atomic_load_explicit(&ring->write_position, memory_order_relaxed);
+    unsigned int read_position = atomic_load_explicit(&ring->read_position, memory_order_acquire);
+
+    return ring->frames - (write_position - read_position);
+}
+
+void writeLookahead(struct _lookahead_ring *ring, float *src, unsigned int count) {
+    unsigned int position = atomic_load_explicit(&ring->write_position, memory_order_relaxed);
+    unsigned int mask = ring->frames - 1;
+    unsigned int i, c;
+
+    for (i = 0; i < count; i += 1) {
+        float *frame = &ring->data[((position + i) & mask) * ring->channels];
+
+        for (c = 0; c < ring->channels; c += 1) {
+            frame[c] = src[i * ring->channels + c];
+        }
+    }
+
+    atomic_store_explicit(&ring->write_position, position + count, memory_order_release);
+}
+
+void writeLookaheadPlanar(struct _lookahead_ring *ring, float **src, unsigned int count) {
+    unsigned int position = atomic_load_explicit(&ring->write_position, memory_order_relaxed);
+    unsigned int mask = ring->frames - 1;
+    unsigned int i, c;
+
+    for (i = 0; i < count; i += 1) {
+        float *frame = &ring->data[((position + i) & mask) * ring->channels];
+
+        for (c = 0; c < ring->channels; c += 1) {
+            frame[c] = src[c][i];
+        }
+    }
+
+    atomic_store_explicit(&ring->write_position, position + count, memory_order_release);
+}
+
+void readLookahead(struct _lookahead_ring *ring, float *dst, unsigned int count) {
+    unsigned int position = atomic_load_explicit(&ring->read_position, memory_order_relaxed);
+    unsigned int mask = ring->frames - 1;
+    unsigned int i, c;
+
+    for (i = 0; i < count; i += 1) {
+        float *frame = &ring->data[((position + i) & mask) * ring->channels];
+
+        for (c = 0; c < ring->channels; c += 1) {
+            dst[i * ring->channels + c] = frame[c];
+        }
+    }
+
+    atomic_store_explicit(&ring->read_position, position + count, memory_order_release);
+}
+
+void readLookaheadPlanar(struct _lookahead_ring *ring, float **dst, unsigned int count) {
+    unsigned int position = atomic_load_explicit(&ring->read_position, memory_order_relaxed);
+    unsigned int mask = ring->frames - 1;
+    unsigned int i, c;
+
+    for (i = 0; i < count; i += 1) {
+        float *frame = &ring->data[((position + i) & mask) * ring->channels];
+
+        for (c = 0; c < ring->channels; c += 1) {
+            dst[c][i] = frame[c];
+        }
+    }
+
+    atomic_store_explicit(&ring->read_position, position + count, memory_order_release);
+}
+
+struct _lookahead_ring *freeLookaheadRing(struct _lookahead_ring **r) {
+    struct _lookahead_ring *ring = *r;
+
+    if (ring == NULL) {
+        return NULL;
+    }
+
+    free(ring->data);
+    free(ring->block);
+    free(ring->block_channels);
+
+    alignedFree(ring);
+
+    *r = NULL;
+
+    return NULL;
+}
@@ -0,0 +1,50 @@
+#ifndef _FAS_LOOKAHEAD_H_
+#define _FAS_LOOKAHEAD_H_
+
+    #include <stdatomic.h>
+
+    #include "constants.h"
+
+    /**
+     * lock-free single producer / single consumer ring of interleaved audio frames
+     *
+     * used by the look-ahead mode : a render thread produce blocks ahead of the device callback which only copy them
+     * (and the other way around for the input frames)
+     **/
+    struct _lookahead_ring {
+        unsigned int channels;
+
+        // capacity in frames (power of two)
+        unsigned int frames;
+
+        float *data;
+
+        // render thread scratch block of FAS_BLOCK_SIZE frames; interleaved (block) or planar (block_channels) views of the same memory
+        float *block;
+        float **block_channels;
+
+        // frames counters (wrap around); each one is only modified by one side
+        _Alignas(FAS_CACHE_LINE_SIZE) atomic_uint write_position;
+        _Alignas(FAS_CACHE_LINE_SIZE) atomic_uint read_position;
+    };
+
+    /**
+     * create a ring which can hold at least frames frames of channels channels
+     **/
+    extern struct _lookahead_ring *createLookaheadRing(unsigned int frames, unsigned int channels);
+
+    // frames which can be read (consumer side) / written (producer side)
+    extern unsigned int lookaheadReadable(struct _lookahead_ring *ring);
+    extern unsigned int lookaheadWritable(struct _lookahead_ring *ring);
+
+    /**
+     * write / read count frames (at most lookaheadWritable / lookaheadReadable) from interleaved or planar buffers
+     **/
+    extern void writeLookahead(struct _lookahead_ring *ring, float *src, unsigned int count);
+    extern void writeLookaheadPlanar(struct _lookahead_ring *ring, float **src, unsigned int count);
+    extern void readLookahead(struct _lookahead_ring *ring, float *dst, unsigned int count);
+    extern void readLookaheadPlanar(struct _lookahead_ring *ring, float **dst, unsigned int count);
+
+    extern struct _lookahead_ring *freeLookaheadRing(struct _lookahead_ring **ring);
+
+#endif
@@ -154,8 +154,8 @@ void doSynthCommands() {
     fflush(stdout);
 #endif
 
-            struct oscillator *osc = &curr_synth.oscillators[osc_index];
-            osc->triggered[instrument_index] = 1;
+            struct oscillators_state *state = &curr_synth.oscillators_state[instrument_index];
+            state->triggered[osc_index] = 1;
         } else if (synth_command->type == FAS_CMD_CHN_FX_SETTINGS) {
             uint32_t chn = synth_command->value[0];
             uint32_t slot = synth_command->value[1];
@@ -193,7 +193,8 @@ void doSynthCommands() {
                                 }
                             }
 
-                            struct _synth_fx_settings *fx_settings_tail = &chn_settings->fx[FAS_MAX_FX_SLOTS - 1];
+                            // last shifted slot
+                            struct _synth_fx_settings *fx_settings_tail = &chn_settings->fx[i];
                             fx_settings_tail->fx_id = -1;
                         }
                     } else if (target == 1) {
@@ -216,6 +217,11 @@ void doSynthCommands() {
 #endif  
                         }
                     }
+
+                    // the compiled chain only depends on slots effect and bypass
+                    if (target <= 1) {
+                        compileEffectsChain(synth_fx[chn], chn_settings);
+                    }
                 } else {
 #ifdef DEBUG
     printf("CMD CHN_SETTINGS : fx slot does not exist \n");
@@ -236,1266 +242,1917 @@ void doSynthCommands() {
     }
 }
 
-#ifdef INTERLEAVED_SAMPLE_FORMAT
-static int audioCallback(float *inputBuffer, float *outputBuffer, unsigned long nframes) {
-#else
-static int audioCallback(float **inputBuffer, float **outputBuffer, unsigned long nframes) {
-#endif
-    LFDS720_MISC_MAKE_VALID_ON_CURRENT_LOGICAL_CORE_INITS_COMPLETED_BEFORE_NOW_ON_ANY_OTHER_PHYSICAL_CORE;
+/**
+ * Instruments reading another instrument or channel output selected by notes blue component (integer part is the source index, channel when there is a fractional part)
+ **/
+static int hasNotesInput(unsigned int k) {
+    struct _synth_instrument *instrument = &curr_synth.instruments[k];
+    int synthesis_method = instrument->type;
+
+    if (synthesis_method == FAS_BANDPASS ||
+        synthesis_method == FAS_STRING_RESON ||
+        synthesis_method == FAS_MODAL_SYNTH ||
+        synthesis_method == FAS_PHASE_DISTORSION) {
+        return 1;
+    }
 
-#ifdef INTERLEAVED_SAMPLE_FORMAT
-    float *audio_out = outputBuffer;
-    float *audio_in = inputBuffer;
+#ifdef WITH_FAUST
+    if (synthesis_method == FAS_FAUST && fas_faust_voices) {
+        return fas_faust_voices->inputs[instrument->p0 % fas_faust_voices->factories_count] >= 1;
+    }
 #endif
-    unsigned int i, j, k, d, s, e, w;
 
-    struct _freelist_frames_data *freelist_frames_data;
-
-    doSynthCommands();
+    return 0;
+}
 
-    int read_status = 0;
-    void *key;
+#if defined(WITH_SOUNDPIPE) || defined(WITH_FAUST)
+/**
+ * Get instrument k input selected by a note : source instrument output block (read at b * step) or channel last sample (step is 0)
+ **/
+static unsigned int getRoutingInput(unsigned int k, double bint, FAS_FLOAT bflt, FAS_FLOAT **in_l, FAS_FLOAT **in_r) {
+    if (bflt > 0) {
+        int chn = (int)bint % fas_max_channels;
+        struct _synth_chn_settings *input_chn_settings = &curr_synth.chn_settings[chn];
 
-    // audio callback commands
-    if (audio_thread_state == FAS_AUDIO_DO_PAUSE) {
-        last_gain_lr = curr_synth.settings->gain_lr;
+        *in_l = &input_chn_settings->last_sample_l;
+        *in_r = &input_chn_settings->last_sample_r;
 
-        audio_thread_state = FAS_AUDIO_PAUSE;
-    } else if (audio_thread_state == FAS_AUDIO_DO_PLAY) {
-        audio_thread_state = FAS_AUDIO_PLAY;
-    } else if (audio_thread_state == FAS_AUDIO_DO_FLUSH_THEN_PAUSE) {
-        // flush away callback data
-        if (curr_notes != dummy_notes) {
-            LFDS720_FREELIST_N_SET_VALUE_IN_ELEMENT(curr_freelist_frames_data->fe, curr_freelist_frames_data);
-            lfds720_freelist_n_threadsafe_push(&freelist_frames, NULL, &curr_freelist_frames_data->fe);
-        }
+        return 0;
+    }
 
-        curr_notes = dummy_notes;
+    unsigned int instrument_index = (int)bint % fas_max_instruments;
+    struct _synth_instrument *instrument = &curr_synth.instruments[instrument_index];
 
-        last_gain_lr = curr_synth.settings->gain_lr;
+    if (instrument_index == k) {
+        *in_l = &instrument->last_sample_l;
+        *in_r = &instrument->last_sample_r;
 
-        audio_thread_state = FAS_AUDIO_PAUSE;
+        return 0;
     }
 
-    if (audio_thread_state == FAS_AUDIO_PAUSE) {
-        // paused audio
-        for (i = 0; i < nframes; i += 1) {
-#ifdef INTERLEAVED_SAMPLE_FORMAT
-            for (j = 0; j < fas_max_channels; j += 1) {
-                struct _synth_chn_settings *chn_settings = &curr_synth.chn_settings[j];
-
-                if (chn_settings->output_chn >= 0) {
-                    audio_out[i * 2 * frame_data_count + chn_settings->output_chn * 2] += chn_settings->last_sample_l * (1.0f - curr_synth.lerp_t) * last_gain_lr;
-                    audio_out[i * 2 * frame_data_count + 1 + chn_settings->output_chn * 2] += chn_settings->last_sample_r * (1.0f - curr_synth.lerp_t) * last_gain_lr;
-                }
-            }
-#else
-            for (j = 0; j < fas_max_channels; j += 1) {
-                struct _synth_chn_settings *chn_settings = &curr_synth.chn_settings[j];
+    // source is rendered before (block) or it is its latest sample (per-sample)
+    *in_l = instrument->output_l;
+    *in_r = instrument->output_r;
 
-                if (chn_settings->output_chn >= 0) {
-                    int output_chn = chn_settings->output_chn * 2;
-                    outputBuffer[output_chn][i] += chn_settings->last_sample_l * (1.0f - curr_synth.lerp_t) * last_gain_lr;
-                    outputBuffer[output_chn + 1][i] += chn_settings->last_sample_r * (1.0f - curr_synth.lerp_t) * last_gain_lr;
-                }
-            }
+    return 1;
+}
 #endif
-            curr_synth.lerp_t += (1.0f / (FAS_FLOAT)nframes);
-            curr_synth.lerp_t = fmin(curr_synth.lerp_t, 1.0f);
-        }
-
-        curr_synth.lerp_t = 0.0;
-        curr_synth.curr_sample = 0;
-
-        lerp_t_step = 1 / note_time_samples;
 
-        return 0;
-    }
+/**
+ * Set instruments notes range of the current block and build the instruments dependency graph from instruments settings and notes
+ *
+ * a source instrument must be rendered before the instrument reading it and a modulation instrument before its target (modulations keep their order),
+ * channel inputs, self inputs or cycles need per-sample processing (one sample latency feedback)
+ **/
+static void scheduleInstruments(struct _instruments_graph *graph) {
+    unsigned int k, j;
 
-    // synth core - critical part :)
-    struct note *_notes;
     unsigned int note_buffer_len = 0, pv_note_buffer_len = 0;
+    unsigned int instruments_count = 0;
 
-    for (i = 0; i < nframes; i += 1) {
-        note_buffer_len = 0;
-        pv_note_buffer_len = 0;
-
-        for (k = 0; k < fas_max_instruments; k += 1) {
-            pv_note_buffer_len += note_buffer_len;
-            note_buffer_len = curr_notes[pv_note_buffer_len].osc_index;
-            pv_note_buffer_len += 1;
-            s = pv_note_buffer_len;
-            e = s + note_buffer_len;
+    for (k = 0; k < fas_max_instruments; k += 1) {
+        pv_note_buffer_len += note_buffer_len;
+        note_buffer_len = curr_notes[pv_note_buffer_len].osc_index;
+        pv_note_buffer_len += 1;
 
-            struct _synth_instrument *instrument = &curr_synth.instruments[k];
-            int synthesis_method = instrument->type;
+        struct _synth_instrument *instrument = &curr_synth.instruments[k];
 
-            struct _synth_chn_settings *chn_settings = &curr_synth.chn_settings[instrument->output_channel];
+        if (instrument->type == FAS_VOID) {
+            break;
+        }
 
-            FAS_FLOAT output_l = 0;
-            FAS_FLOAT output_r = 0;
+        instrument->notes_start = pv_note_buffer_len;
+        instrument->notes_end = pv_note_buffer_len + note_buffer_len;
 
-            if (synthesis_method == FAS_ADDITIVE) {
-                for (j = s; j < e; j += 1) {
-                    struct note *n = &curr_notes[j];
+        instruments_count += 1;
+    }
 
-                    struct oscillator *osc = &curr_synth.oscillators[n->osc_index];
+    resetInstrumentsGraph(graph, instruments_count);
 
-#ifdef MAGIC_CIRCLE
-                    osc->mc_x[k] = osc->mc_x[k] + osc->mc_eps * osc->mc_y[k];
-                    osc->mc_y[k] = -osc->mc_eps * osc->mc_x[k] + osc->mc_y[k];
+    int last_modulation = -1;
 
-                    FAS_FLOAT smp = osc->mc_y[k];
-#else
-                    // linear interpolation sampling
-                    FAS_FLOAT phase_index = osc->phase_index[k];
-                    int phase_index1 = (int)phase_index;
-                    int phase_index2 = phase_index1 + 1;
+    for (k = 0; k < instruments_count; k += 1) {
+        struct _synth_instrument *instrument = &curr_synth.instruments[k];
+        int synthesis_method = instrument->type;
 
-                    FAS_FLOAT smp1 = fas_sine_wavetable[phase_index1];
-                    FAS_FLOAT smp2 = fas_sine_wavetable[phase_index2];
+        if (synthesis_method == FAS_MODULATION) {
+            if (last_modulation >= 0) {
+                addInstrumentsEdge(graph, last_modulation, k);
+            }
 
-                    FAS_FLOAT mu = phase_index - (FAS_FLOAT)phase_index1;
+            last_modulation = k;
 
-                    FAS_FLOAT smp = smp1 + mu * (smp2 - smp1);
-                    //
-#endif
-                    FAS_FLOAT vl = n->previous_volume_l + n->diff_volume_l * curr_synth.lerp_t;
-                    FAS_FLOAT vr = n->previous_volume_r + n->diff_volume_r * curr_synth.lerp_t;
+            if (instrument->p0 == 1) {
+                int instrument_index = ((int)floor(instrument->p1)) % fas_max_instruments;
 
-#ifdef PARTIAL_FX
-                    int fx = (int)osc->fp1[k][0] % SP_OSC_MODS;
-#ifdef WITH_SOUNDPIPE
-                    if (fx == SP_CRUSH_MODS) {
-                        sp_bitcrush *crush = (sp_bitcrush *)osc->sp_mods[k][SP_CRUSH_MODS];
-                        
-                        crush->bitdepth = 1.f + (osc->fp1[k][1] * 15.f);
-                        crush->srate = n->res * (FAS_FLOAT)fas_sample_rate;
+                if (instrument_index >= 0 && (unsigned int)instrument_index != k) {
+                    int target_type = curr_synth.instruments[instrument_index].type;
 
-                        sp_bitcrush_compute(sp, (sp_bitcrush *)osc->sp_mods[k][SP_CRUSH_MODS], &smp, &smp); 
-                    } else if (fx == SP_PD_MODS) {
-                        sp_pdhalf *pdh = (sp_pdhalf *)osc->sp_gens[k][SP_PD_GENERATOR];
-                        
-                        pdh->amount = (0.5f - n->res) * 2.f;
+                    // modulated parameters may select another source
+                    if (target_type == FAS_SPECTRAL || target_type == FAS_FAUST) {
+                        graph->per_sample = 1;
+                    }
 
-                        sp_pdhalf_compute(sp, (sp_pdhalf *)osc->sp_gens[k][SP_PD_GENERATOR], &smp, &smp); 
-                    } else if (fx == SP_WAVSH_MODS) {
-                        sp_dist *dist = (sp_dist *)osc->sp_mods[k][SP_WAVSH_MODS];
-                        
-                        dist->shape1 = osc->fp1[k][1];
-                        dist->shape2 = n->alpha;
+                    addInstrumentsEdge(graph, k, instrument_index);
+                }
+            }
+        } else if (synthesis_method == FAS_SPECTRAL) {
+            if (instrument->p3) {
+                unsigned int input_instrument = instrument->p0 % fas_max_instruments;
+
+                if (input_instrument >= instruments_count) {
+                    graph->per_sample = 1;
+                } else if (k != input_instrument) {
+                    addInstrumentsEdge(graph, input_instrument, k);
+                }
+            } else if (instrument->output_channel != (instrument->p0 % fas_max_channels)) {
+                graph->per_sample = 1;
+            }
+        } else if (synthesis_method == FAS_FORMANT_SYNTH) {
+            if (instrument->notes_end > instrument->notes_start) {
+                graph->per_sample = 1;
+            }
+        } else if (hasNotesInput(k)) {
+            for (j = instrument->notes_start; j < instrument->notes_end; j += 1) {
+                struct note *n = &curr_notes[j];
 
-                        sp_dist_compute(sp, (sp_dist *)osc->sp_mods[k][SP_WAVSH_MODS], &smp, &smp); 
-                    } else if (fx == SP_FOLD_MODS) {
-                        sp_fold *fold = (sp_fold *)osc->sp_mods[k][SP_FOLD_MODS];
-                        
-                        fold->incr = n->alpha;
+                double bint = 0;
+                FAS_FLOAT bflt = modf(fabs(n->blue), &bint);
 
-                        sp_fold_compute(sp, (sp_fold *)osc->sp_mods[k][SP_FOLD_MODS], &smp, &smp); 
-                    } else if (fx == SP_CONV_MODS) {
-                        sp_conv_compute(sp, (sp_conv *)osc->sp_mods[k][SP_CONV_MODS], &smp, &smp); 
-                    } else if (fx == NOISE_MODS) {
-#ifndef MAGIC_CIRCLE
-                        osc->phase_index[k] += osc->phase_step * (1.0f + (fas_white_noise_table[osc->noise_index[k]++] * fas_noise_amount) * n->alpha);
-#endif
-                    }
-#endif
-#endif
+                unsigned int instrument_index = (int)bint % fas_max_instruments;
 
-                    output_l += vl * smp;
-                    output_r += vr * smp;
+                if (bflt > 0 || instrument_index == k || instrument_index >= instruments_count) {
+                    graph->per_sample = 1;
 
-#ifndef MAGIC_CIRCLE
-                    osc->phase_index[k] += osc->phase_step;
-                    osc->phase_index[k] = fmod(osc->phase_index[k], fas_wavetable_size);
-#endif
+                    break;
                 }
-            } else if (synthesis_method == FAS_SPECTRAL) {
-                struct _synth_instrument_states *instruments_states = &fas_instrument_states[k];
 
-                // accumulate frames until there is enough for a STFT frame
-                if (instrument->p3) { // instrument
-                    unsigned int input_instrument = instrument->p0 % fas_max_instruments;
+                addInstrumentsEdge(graph, instrument_index, k);
+            }
+        }
 
-                    if (k != input_instrument) {
-                        struct _synth_instrument *instrument = &curr_synth.instruments[input_instrument];
-                        instruments_states->in[0][instruments_states->position] = instrument->last_sample_l;
-                        instruments_states->in[1][instruments_states->position] = instrument->last_sample_r;
+        if (graph->per_sample) {
+            break;
+        }
+    }
 
-                        instruments_states->position += 1;
-                    }
-                } else { // channel
-                    unsigned int input_channel = instrument->p0 % fas_max_channels;
+    sortInstrumentsGraph(graph);
+}
 
-                    if (instrument->output_channel != input_channel) {
-                        struct _synth_chn_settings *input_chn_settings = &curr_synth.chn_settings[input_channel];
-                        instruments_states->in[0][instruments_states->position] = input_chn_settings->last_sample_l;
-                        instruments_states->in[1][instruments_states->position] = input_chn_settings->last_sample_r;
+/**
+ * Instruments rendering kernels; render len samples of instrument k notes (s to e), output is accumulated into out_l / out_r
+ * i is the callback buffer position of the first sample and lerp_t hold the notes interpolation factor of each samples
+ *
+ * there is one kernel per synthesis method (and sub-mode), it is selected once per block (see selectRenderKernel)
+ **/
+#ifdef INTERLEAVED_SAMPLE_FORMAT
+#define FAS_KERNEL_ARGS unsigned int k, unsigned int s, unsigned int e, float *audio_in, unsigned long i, FAS_FLOAT *lerp_t, unsigned int len, FAS_FLOAT *out_l, FAS_FLOAT *out_r
+#else
+#define FAS_KERNEL_ARGS unsigned int k, unsigned int s, unsigned int e, float **inputBuffer, unsigned long i, FAS_FLOAT *lerp_t, unsigned int len, FAS_FLOAT *out_l, FAS_FLOAT *out_r
+#endif
 
-                        instruments_states->position += 1;
-                    }
-                }
+/**
+ * notes kernel; render len samples of note n into out_l / out_r
+ **/
+typedef void (*fas_note_kernel)(unsigned int k, struct note *n, struct oscillators_state *state, FAS_FLOAT *lerp_t, unsigned int len, FAS_FLOAT *out_l, FAS_FLOAT *out_r);
 
-                if (instruments_states->position >= instruments_states->hop_size) {
-                    if (instrument->p2 != 1) {
-                        afSTFTforward(instruments_states->afSTFT_handle, instruments_states->in, instruments_states->stft_result);
-                    }
+#ifdef PARTIAL_FX
+/**
+ * Additive partials with an effect are computed individually; kernels are specialised by effect (partial fp1[0])
+ * so that the samples loop has no branches
+ **/
+static inline FAS_FLOAT partialSample(struct oscillator *osc, struct oscillators_state *state, unsigned int y) {
+#ifdef MAGIC_CIRCLE
+    state->mc_x[y] = state->mc_x[y] + osc->mc_eps * state->mc_y[y];
+    state->mc_y[y] = -osc->mc_eps * state->mc_x[y] + state->mc_y[y];
 
-                    // empty processing buffer
-                    for (d = 0; d < 2; d += 1) {
-                        for (w = 0; w < instruments_states->hop_size / 2; w += 1) {
-                            instruments_states->stft_temp[d].re[w] = 0;
-                            instruments_states->stft_temp[d].im[w] = 0;
-                        }
-                    }
+    return state->mc_y[y];
+#else
+    // linear interpolation sampling
+    FAS_FLOAT phase_index = state->phase_index[y];
+    int phase_index1 = (int)phase_index;
+    int phase_index2 = phase_index1 + 1;
 
-                    // process incoming data
-                    for (j = s; j < e; j += 1) {
-                        struct note *n = &curr_notes[j];
+    FAS_FLOAT smp1 = fas_sine_wavetable[phase_index1];
+    FAS_FLOAT smp2 = fas_sine_wavetable[phase_index2];
 
-                        struct oscillator *osc = &curr_synth.oscillators[n->osc_index];
+    FAS_FLOAT mu = phase_index - (FAS_FLOAT)phase_index1;
 
-                        FAS_FLOAT vl = n->previous_volume_l + n->diff_volume_l * curr_synth.lerp_t;
-                        FAS_FLOAT vr = n->previous_volume_r + n->diff_volume_r * curr_synth.lerp_t;
+    return smp1 + mu * (smp2 - smp1);
+#endif
+}
 
-                        FAS_FLOAT v[2] = { vl, vr };
-                        FAS_FLOAT p[2] = { n->blue, n->alpha };
+static inline void partialAdvance(struct oscillator *osc, struct oscillators_state *state, unsigned int y) {
+#ifndef MAGIC_CIRCLE
+    state->phase_index[y] += osc->phase_step;
+    state->phase_index[y] = fmod(state->phase_index[y], fas_wavetable_size);
+#endif
+}
 
-                        FAS_FLOAT bin_delta = ((FAS_FLOAT)(fas_sample_rate / 2) / instruments_states->hop_size);
-                        FAS_FLOAT bin = osc->freq / bin_delta;
+static inline FAS_FLOAT partialNone(unsigned int k, struct oscillator *osc, struct oscillators_state *state, struct note *n, FAS_FLOAT smp) {
+    return smp;
+}
 
-                        int ibin = round(bin);
+#ifdef WITH_SOUNDPIPE
+static inline FAS_FLOAT partialCrush(unsigned int k, struct oscillator *osc, struct oscillators_state *state, struct note *n, FAS_FLOAT smp) {
+    sp_bitcrush *crush = (sp_bitcrush *)osc->sp_mods[k][SP_CRUSH_MODS];
 
-                        // stereo spectral processing
-                        for (d = 0; d < 2; d += 1) {                                
-                            if (instrument->p2 == 1) {
-                                instruments_states->stft_temp[d].re[ibin] = v[d];
-                                instruments_states->stft_temp[d].im[ibin] = p[d];
-                            } else {
-                                FAS_FLOAT real = instruments_states->stft_result[d].re[ibin];
-                                FAS_FLOAT imag = instruments_states->stft_result[d].im[ibin];
+    crush->bitdepth = 1.f + (state->fp1[n->osc_index][1] * 15.f);
+    crush->srate = n->res * (FAS_FLOAT)fas_sample_rate;
 
-                                // polar
-                                FAS_FLOAT mag = sqrtf(real * real + imag * imag);
-                                FAS_FLOAT pha = atan2f(imag, real);
+    sp_bitcrush_compute(&fas_instruments_sp[k], crush, &smp, &smp);
 
-                                mag *= v[d];
-                                pha *= p[d];
+    return smp;
+}
 
-                                // rectangular
-                                FAS_FLOAT creal = mag * cosf(pha);
-                                FAS_FLOAT cimag = mag * sinf(pha);
+static inline FAS_FLOAT partialPd(unsigned int k, struct oscillator *osc, struct oscillators_state *state, struct note *n, FAS_FLOAT smp) {
+    sp_pdhalf *pdh = (sp_pdhalf *)osc->sp_gens[k][SP_PD_GENERATOR];
 
-                                instruments_states->stft_temp[d].re[ibin] = creal;
-                                instruments_states->stft_temp[d].im[ibin] = cimag;
-                            }
-                        }
-                    }
+    pdh->amount = (0.5f - n->res) * 2.f;
 
-                    // copy processing result
-                    for (d = 0; d < 2; d += 1) {
-                        for (w = 0; w < instruments_states->hop_size / 2; w += 1) {
-                            FAS_FLOAT re = instruments_states->stft_temp[d].re[w];
-                            FAS_FLOAT im = instruments_states->stft_temp[d].im[w];
+    sp_pdhalf_compute(&fas_instruments_sp[k], pdh, &smp, &smp);
 
-                            instruments_states->stft_result[d].re[w] = re;
-                            instruments_states->stft_result[d].im[w] = im;
-                        }
-                    }
+    return smp;
+}
 
-                    afSTFTinverse(instruments_states->afSTFT_handle, instruments_states->stft_result, instruments_states->out);
+static inline FAS_FLOAT partialWavsh(unsigned int k, struct oscillator *osc, struct oscillators_state *state, struct note *n, FAS_FLOAT smp) {
+    sp_dist *dist = (sp_dist *)osc->sp_mods[k][SP_WAVSH_MODS];
 
-                    instruments_states->position = 0;
-                }
+    dist->shape1 = state->fp1[n->osc_index][1];
+    dist->shape2 = n->alpha;
 
-                output_l += instruments_states->out[0][instruments_states->position];
-                output_r += instruments_states->out[1][instruments_states->position];
-            } else if (synthesis_method == FAS_GRANULAR) {
-                int env_type = instrument->p0;
-                FAS_FLOAT *gr_env = grain_envelope[env_type];
+    sp_dist_compute(&fas_instruments_sp[k], dist, &smp, &smp);
 
-                for (j = s; j < e; j += 1) {
-                    struct note *n = &curr_notes[j];
+    return smp;
+}
 
-                    struct oscillator *osc = &curr_synth.oscillators[n->osc_index];
+static inline FAS_FLOAT partialFold(unsigned int k, struct oscillator *osc, struct oscillators_state *state, struct note *n, FAS_FLOAT smp) {
+    sp_fold *fold = (sp_fold *)osc->sp_mods[k][SP_FOLD_MODS];
 
-                    FAS_FLOAT vl = n->previous_volume_l + n->diff_volume_l * curr_synth.lerp_t;
-                    FAS_FLOAT vr = n->previous_volume_r + n->diff_volume_r * curr_synth.lerp_t;
+    fold->incr = n->alpha;
 
-                    unsigned int grain_index = n->osc_index * samples_count + n->psmp_index;
-                    unsigned int si = curr_synth.bank_settings->h * samples_count;
+    sp_fold_compute(&fas_instruments_sp[k], fold, &smp, &smp);
 
-                    struct grain *gr = &curr_synth.grains[grain_index];
+    return smp;
+}
 
-                    FAS_FLOAT gr_out_l = 0, gr_out_r = 0;
-                    computeGrains(k, curr_synth.grains, grain_index, n->alpha, si, n->density, instrument->p3, gr_env, samples, n->psmp_index, fas_sample_rate, instrument->p1, instrument->p2, &gr_out_l, &gr_out_r);
-/*
-                    // WIP :  allow real-time density change
-                    unsigned density_difference = n->density - n->pdensity;
-                    if (density_difference < 0) {
-                        gr->density[k] = -density_difference;
+static inline FAS_FLOAT partialConv(unsigned int k, struct oscillator *osc, struct oscillators_state *state, struct note *n, FAS_FLOAT smp) {
+    // NULL when the convolvers pool is exhausted
+    struct _fas_convolver *conv = getConvolverVoice(fas_conv_voices, k, n->osc_index);
 
-                        computeGrains(k, curr_synth.grains, grain_index, n->alpha, si, n->density, n->density, gr_env, samples, n->psmp_index, instrument->p1, instrument->p2, &gr_out_l, &gr_out_r);
+    if (conv == NULL) {
+        return smp;
+    }
 
-                        output_l += (vl * gr->density[k]) * gr_out_l * (1.0f - curr_synth.lerp_t);
-                        output_r += (vr * gr->density[k]) * gr_out_r * (1.0f - curr_synth.lerp_t);
+    return computeConvolver(conv, smp);
+}
 
-                        gr->density[k] = n->density;
+static inline FAS_FLOAT partialNoise(unsigned int k, struct oscillator *osc, struct oscillators_state *state, struct note *n, FAS_FLOAT smp) {
+#ifndef MAGIC_CIRCLE
+    state->phase_index[n->osc_index] += osc->phase_step * (1.0f + (fas_white_noise_table[state->noise_index[n->osc_index]++] * fas_noise_amount) * n->alpha);
+#endif
 
-                        gr_out_l = 0; gr_out_r = 0;
-                        computeGrains(k, curr_synth.grains, grain_index, n->alpha, si, n->density, 0, gr_env, samples, n->psmp_index, instrument->p1, instrument->p2, &gr_out_l, &gr_out_r);
-                    } else {
-                        computeGrains(k, curr_synth.grains, grain_index, n->alpha, si, n->density, 0, gr_env, samples, n->psmp_index, instrument->p1, instrument->p2, &gr_out_l, &gr_out_r);
-                    }
-*/
-                    // allow real-time sample change : cross-fade between old & new on a sudden sample change
-                    if (n->psmp_index != n->smp_index) {
-                        output_l += (vl * n->norm_density) * gr_out_l * (1.0f - curr_synth.lerp_t);
-                        output_r += (vr * n->norm_density) * gr_out_r * (1.0f - curr_synth.lerp_t);
+    return smp;
+}
+#endif
 
-                        grain_index = n->osc_index * samples_count + n->smp_index;
+#define FAS_PARTIAL_KERNEL(FX) \
+static void additive##FX(unsigned int k, struct note *n, struct oscillators_state *state, FAS_FLOAT *lerp_t, unsigned int len, FAS_FLOAT *out_l, FAS_FLOAT *out_r) { \
+    struct oscillator *osc = &curr_synth.oscillators[n->osc_index]; \
+    unsigned int y = n->osc_index; \
+    unsigned int b; \
+    \
+    for (b = 0; b < len; b += 1) { \
+        FAS_FLOAT smp = partialSample(osc, state, y); \
+        \
+        FAS_FLOAT vl = n->previous_volume_l + n->diff_volume_l * lerp_t[b]; \
+        FAS_FLOAT vr = n->previous_volume_r + n->diff_volume_r * lerp_t[b]; \
+        \
+        smp = partial##FX(k, osc, state, n, smp); \
+        \
+        out_l[b] += vl * smp; \
+        out_r[b] += vr * smp; \
+        \
+        partialAdvance(osc, state, y); \
+    } \
+}
 
-                        gr_out_l = 0; gr_out_r = 0;
-                        computeGrains(k, curr_synth.grains, grain_index, n->alpha, si, n->density, instrument->p3, gr_env, samples, n->smp_index, fas_sample_rate, instrument->p1, instrument->p2, &gr_out_l, &gr_out_r);
+FAS_PARTIAL_KERNEL(None)
 
-                        output_l += (vl * n->density) * gr_out_l;
-                        output_r += (vr * n->density) * gr_out_r;
-                    } else {
-                        output_l += (vl * n->density) * gr_out_l;
-                        output_r += (vr * n->density) * gr_out_r;
-                    }
-                }
-            } else if (synthesis_method == FAS_FM) {
-                for (j = s; j < e; j += 1) {
-                    struct note *n = &curr_notes[j];
+#ifdef WITH_SOUNDPIPE
+FAS_PARTIAL_KERNEL(Crush)
+FAS_PARTIAL_KERNEL(Pd)
+FAS_PARTIAL_KERNEL(Wavsh)
+FAS_PARTIAL_KERNEL(Fold)
+FAS_PARTIAL_KERNEL(Conv)
+FAS_PARTIAL_KERNEL(Noise)
+
+// indexed by effect id, empty partials go to the vectorized kernel
+static const fas_note_kernel fas_partial_kernels[SP_OSC_MODS] = {
+    NULL,
+    additiveCrush,
+    additivePd,
+    additiveWavsh,
+    additiveFold,
+    additiveConv,
+    additiveNoise
+};
+#else
+static const fas_note_kernel fas_partial_kernels[SP_OSC_MODS] = {
+    NULL,
+    additiveNone,
+    additiveNone,
+    additiveNone,
+    additiveNone,
+    additiveNone,
+    additiveNone
+};
+#endif
+#endif
 
-                    struct oscillator *osc = &curr_synth.oscillators[n->osc_index];
+static void renderAdditive(FAS_KERNEL_ARGS) {
+    unsigned int j;
 
-                    FAS_FLOAT mod_phase_step = osc->fp1[k][4];
-                    FAS_FLOAT car_wav_size = osc->fp2[k][0];
-                    FAS_FLOAT mod_wav_size = osc->fp2[k][1];
+    struct _synth_instrument *instrument = &curr_synth.instruments[k];
+    struct oscillators_state *state = &curr_synth.oscillators_state[k];
 
-                    FAS_FLOAT fbf = (osc->fp1[k][0] + osc->fp1[k][1]) / 2; // 'anti-hunting' filter (simple low-pass)
-                    FAS_FLOAT fb = fbf * (floor(n->blue) / 65536.0);
-                    
-                    FAS_FLOAT ph2 = fmod(osc->phase_index2[k] + (fb * mod_wav_size), mod_wav_size);
+    // instrument notes may be rendered by ranges (see renderInstruments) which use disjoint parts of the packed partials
+    struct _additive_bank additive_bank_slice;
+    struct _additive_bank *additive_bank = &additive_bank_slice;
 
-                    FAS_FLOAT smp_mod = osc->wav2[k][(int)ph2];
-                    FAS_FLOAT mod = (((FAS_FLOAT)smp_mod * osc->fp3[k][0]) * car_wav_size);
-                    FAS_FLOAT ph1 = fmod(osc->phase_index[k] + mod, car_wav_size);
+    sliceAdditiveBank(&curr_synth.additive_banks[k], s - instrument->notes_start, additive_bank);
 
-                    int phase_index1 = (int)ph1;
-                    int phase_index2 = phase_index1 + 1;
+    for (j = s; j < e; j += 1) {
+        struct note *n = &curr_notes[j];
 
-                    FAS_FLOAT smp1 = osc->wav1[k][phase_index1];
-                    FAS_FLOAT smp2 = osc->wav1[k][phase_index2];
+        struct oscillator *osc = &curr_synth.oscillators[n->osc_index];
 
-                    FAS_FLOAT mu = ph1 - (FAS_FLOAT)phase_index1;
-                    FAS_FLOAT smp = smp1 + mu * (smp2 - smp1);
+#ifdef PARTIAL_FX
+        int fx = (int)state->fp1[n->osc_index][0] % SP_OSC_MODS;
 
-                    FAS_FLOAT vl = n->previous_volume_l + n->diff_volume_l * curr_synth.lerp_t;
-                    FAS_FLOAT vr = n->previous_volume_r + n->diff_volume_r * curr_synth.lerp_t;
+        // partials with an effect are computed individually
+        if (fx != SP_EMPTY_MODS) {
+            fas_note_kernel partial_kernel = (fx > 0) ? fas_partial_kernels[fx] : additiveNone;
 
-                    // dc filter (due to feedback there is a 0Hz component)
-                    FAS_FLOAT dc_filtered_smp = smp - osc->pvalue[k] + (0.99 * osc->fp1[k][2]);
-                    osc->pvalue[k] = smp;
-                    osc->fp1[k][2] = dc_filtered_smp;
+            partial_kernel(k, n, state, lerp_t, len, out_l, out_r);
 
-                    output_l += vl * dc_filtered_smp;
-                    output_r += vr * dc_filtered_smp;
+            continue;
+        }
+#endif
 
-                    osc->phase_index[k] += osc->fp1[k][3];
-                    osc->phase_index2[k] += mod_phase_step;
+        // pack partial state for the vectorized kernel
+        unsigned int p = additive_bank->partials;
 
-                    // feedback
-                    osc->fp1[k][0] = osc->fp1[k][1];
-                    osc->fp1[k][1] = vl * smp_mod;
-                }
-            } else if (synthesis_method == FAS_SUBTRACTIVE) {
-                int filter_type = instrument->p0;
-                for (j = s; j < e; j += 1) {
-                    struct note *n = &curr_notes[j];
-
-                    struct oscillator *osc = &curr_synth.oscillators[n->osc_index];
-
-                    // implementation from http://www.martin-finke.de/blog/articles/audio-plugins-018-polyblep-oscillator/
-                    FAS_FLOAT smp;
-                    FAS_FLOAT t = osc->fphase[k] / M_PI2;
-
-                    int waveform = ((int)fabs(floor(n->alpha))) % 6;
-
-                    switch (waveform) {
-                        case 0:
-                            smp = raw_waveform(osc->fphase[k], 1);
-                            smp -= poly_blep(osc->phase_increment, t);
-                            break;
-                        case 1:
-                            smp = raw_waveform(osc->fphase[k], 2);
-                            smp += poly_blep(osc->phase_increment, t);
-                            smp -= poly_blep(osc->phase_increment, fmod(t + 0.5, 1.0));
-                            break;
-                        case 2:
-                            smp = raw_waveform(osc->fphase[k], 3);
-                            smp += poly_blep(osc->phase_increment, t);
-                            smp -= poly_blep(osc->phase_increment, fmod(t + 0.5, 1.0));
-                            smp = osc->phase_increment * smp + (1.0 - osc->phase_increment) * osc->pvalue[k];
-                            osc->pvalue[k] = smp;
-                            break;
-                        case 3: // white noise
-#ifdef WITH_SOUNDPIPE
-                            sp_noise_compute(sp, (sp_noise *)osc->sp_gens[k][SP_WHITE_NOISE_GENERATOR], NULL, &smp);
+        additive_bank->osc_index[p] = n->osc_index;
+#ifdef MAGIC_CIRCLE
+        additive_bank->eps[p] = osc->mc_eps;
+        additive_bank->x[p] = state->mc_x[n->osc_index];
+        additive_bank->y[p] = state->mc_y[n->osc_index];
 #else
-                            smp = fas_white_noise_table[(int)osc->phase_index[k]];
-
-                            osc->phase_index[k] += osc->phase_step;
-                            osc->phase_index[k] = fmod(osc->phase_index[k], fas_wavetable_size);
+        additive_bank->phase_index[p] = state->phase_index[n->osc_index];
+        additive_bank->phase_step[p] = osc->phase_step;
 #endif
-                            break;
-#ifdef WITH_SOUNDPIPE
-                        case 4: // pink noise
-                            sp_pinknoise_compute(sp, (sp_pinknoise *)osc->sp_gens[k][SP_PINK_NOISE_GENERATOR], NULL, &smp);
-                            break;
-                        case 5: // brown noise
-                            sp_brown_compute(sp, (sp_brown *)osc->sp_gens[k][SP_BROWN_NOISE_GENERATOR], NULL, &smp);
-                            break;
-#endif
-                        default:
-                            break;
-                    }
+        additive_bank->pvl[p] = n->previous_volume_l;
+        additive_bank->pvr[p] = n->previous_volume_r;
+        additive_bank->dvl[p] = n->diff_volume_l;
+        additive_bank->dvr[p] = n->diff_volume_r;
 
-                    osc->fphase[k] += osc->phase_increment;
-                    while (osc->fphase[k] >= M_PI2) {
-                        osc->fphase[k] -= M_PI2;
-                    }
+        additive_bank->partials += 1;
+    }
 
-                    FAS_FLOAT vl = n->previous_volume_l + n->diff_volume_l * curr_synth.lerp_t;
-                    FAS_FLOAT vr = n->previous_volume_r + n->diff_volume_r * curr_synth.lerp_t;
+    padAdditiveBank(additive_bank);
 
-#ifdef WITH_SOUNDPIPE
-                    if (filter_type == 0) {
-                        sp_moogladder_compute(sp, (sp_moogladder *)osc->sp_filters[k][SP_MOOG_FILTER], &smp, &smp); 
-                    } else if (filter_type == 1) {
-                        sp_diode_compute(sp, (sp_diode *)osc->sp_filters[k][SP_DIODE_FILTER], &smp, &smp);
-                    } else if (filter_type == 2) {
-                        sp_wpkorg35_compute(sp, (sp_wpkorg35 *)osc->sp_filters[k][SP_KORG35_FILTER], &smp, &smp);
-                    } else if (filter_type == 3) {
-                        sp_lpf18_compute(sp, (sp_lpf18 *)osc->sp_filters[k][SP_LPF18_FILTER], &smp, &smp);
-                    }
+    computeAdditiveBank(additive_bank, fas_sine_wavetable, fas_wavetable_size, lerp_t, len, out_l, out_r);
+
+    // write back oscillators state
+    for (j = 0; j < additive_bank->partials; j += 1) {
+        unsigned int y = additive_bank->osc_index[j];
+
+#ifdef MAGIC_CIRCLE
+        state->mc_x[y] = additive_bank->x[j];
+        state->mc_y[y] = additive_bank->y[j];
 #else
-                    smp = huovilainen_moog(smp, n->cutoff, n->res, osc->fp1[k], osc->fp2[k], osc->fp3[k], 2);
+        state->phase_index[y] = additive_bank->phase_index[j];
 #endif
+    }
+}
 
-                    output_l += vl * smp;
-                    output_r += vr * smp;
-                }
-            } else if (synthesis_method == FAS_PHYSICAL_MODELLING) {
-                int model_type = instrument->p0;
-                for (j = s; j < e; j += 1) {
-                    struct note *n = &curr_notes[j];
-
-                    struct oscillator *osc = &curr_synth.oscillators[n->osc_index];
+static void renderSpectral(FAS_KERNEL_ARGS) {
+    unsigned int j, d, w, b;
 
-                    FAS_FLOAT vl = n->previous_volume_l + n->diff_volume_l * curr_synth.lerp_t;
-                    FAS_FLOAT vr = n->previous_volume_r + n->diff_volume_r * curr_synth.lerp_t;
+    struct _synth_instrument *instrument = &curr_synth.instruments[k];
 
-#ifdef WITH_SOUNDPIPE
-                    if (model_type == 2) {
-                        FAS_FLOAT trigger_l = ((n->previous_volume_l <= 0) || osc->triggered[k]) ? 1.f : 0.f;
-                        FAS_FLOAT trigger_r = ((n->previous_volume_r <= 0) || osc->triggered[k]) ? 1.f : 0.f;
-                        FAS_FLOAT bar_out_l = 0.;
-                        FAS_FLOAT bar_out_r = 0.;
+    struct _synth_instrument_states *instruments_states = &fas_instrument_states[k];
 
-                        sp_bar_compute(sp, (sp_bar *)osc->sp_gens[k][SP_BAR_GENERATOR], &trigger_l, &bar_out_l);
-                        sp_bar_compute(sp, (sp_bar *)osc->sp_gens[k][SP_BAR_GENERATOR], &trigger_r, &bar_out_r);
+    for (b = 0; b < len; b += 1) {
+        // accumulate frames until there is enough for a STFT frame
+        if (instrument->p3) { // instrument
+            unsigned int input_instrument = instrument->p0 % fas_max_instruments;
 
-                        output_l += vl * bar_out_l;
-                        output_r += vr * bar_out_r;
+            if (k != input_instrument) {
+                struct _synth_instrument *instrument = &curr_synth.instruments[input_instrument];
+                instruments_states->in[0][instruments_states->position] = instrument->output_l[b];
+                instruments_states->in[1][instruments_states->position] = instrument->output_r[b];
 
-                        if (osc->triggered[k]) {
-                            osc->triggered[k] = 0;
-                        }
-                    } else if (model_type == 1) {
-                        FAS_FLOAT trigger_l = ((n->previous_volume_l <= 0) || osc->triggered[k]) ? 1.f : 0.f;
-                        FAS_FLOAT trigger_r = ((n->previous_volume_r <= 0) || osc->triggered[k]) ? 1.f : 0.f;
-                        FAS_FLOAT drip_out_l = 0.;
-                        FAS_FLOAT drip_out_r = 0.;
+                instruments_states->position += 1;
+            }
+        } else { // channel
+            unsigned int input_channel = instrument->p0 % fas_max_channels;
 
-                        sp_drip_compute(sp, (sp_drip *)osc->sp_gens[k][SP_DRIP_GENERATOR], &trigger_l, &drip_out_l);
-                        sp_drip_compute(sp, (sp_drip *)osc->sp_gens[k][SP_DRIP_GENERATOR], &trigger_r, &drip_out_r);
+            if (instrument->output_channel != input_channel) {
+                struct _synth_chn_settings *input_chn_settings = &curr_synth.chn_settings[input_channel];
+                instruments_states->in[0][instruments_states->position] = input_chn_settings->last_sample_l;
+                instruments_states->in[1][instruments_states->position] = input_chn_settings->last_sample_r;
 
-                        output_l += vl * drip_out_l;
-                        output_r += vr * drip_out_r;
+                instruments_states->position += 1;
+            }
+        }
 
-                        if (osc->triggered[k]) {
-                            osc->triggered[k] = 0;
-                        }
-                    } else if (model_type == 0) {
-#endif
-                    FAS_FLOAT phase_step = osc->freq / (FAS_FLOAT)fas_sample_rate * (osc->buffer_len + 0.5);
+        if (instruments_states->position >= instruments_states->hop_size) {
+            if (instrument->p2 != 1) {
+                afSTFTforward(instruments_states->afSTFT_handle, instruments_states->in, instruments_states->stft_result);
+            }
 
-                    unsigned int curr_sample_index = osc->fphase[k];
-                    unsigned int curr_sample_index2 = curr_sample_index + 1;
+            // empty processing buffer
+            for (d = 0; d < 2; d += 1) {
+                for (w = 0; w < instruments_states->hop_size / 2; w += 1) {
+                    instruments_states->stft_temp[d].re[w] = 0;
+                    instruments_states->stft_temp[d].im[w] = 0;
+                }
+            }
 
-                    FAS_FLOAT mu = osc->fphase[k] - (FAS_FLOAT)curr_sample_index;
+            // process incoming data
+            for (j = s; j < e; j += 1) {
+                struct note *n = &curr_notes[j];
 
-                    unsigned int si = k * osc->buffer_len;
+                struct oscillator *osc = &curr_synth.oscillators[n->osc_index];
 
-                    unsigned int curr_sample = si + (curr_sample_index % osc->buffer_len);
-                    unsigned int curr_sample2 = si + (curr_sample_index2 % osc->buffer_len);
+                FAS_FLOAT vl = n->previous_volume_l + n->diff_volume_l * lerp_t[b];
+                FAS_FLOAT vr = n->previous_volume_r + n->diff_volume_r * lerp_t[b];
 
-                    FAS_FLOAT smp = osc->buffer[curr_sample];
+                FAS_FLOAT v[2] = { vl, vr };
+                FAS_FLOAT p[2] = { n->blue, n->alpha };
 
-                    FAS_FLOAT stretch = osc->fp1[k][0];
-                    FAS_FLOAT in = 0.0f;
-                    if (stretch <= randf(0.f, 1.f)) {
-                        in = 0.5f * ((smp + mu * (osc->buffer[curr_sample2] - smp)) + osc->pvalue[k]);
-                    } else {
-                        in = smp;
-                    }
+                FAS_FLOAT bin_delta = ((FAS_FLOAT)(fas_sample_rate / 2) / instruments_states->hop_size);
+                FAS_FLOAT bin = osc->freq / bin_delta;
 
-                    // allpass
-                    FAS_FLOAT delay = fabs((FAS_FLOAT)osc->buffer_len - ((FAS_FLOAT)fas_sample_rate / osc->freq));
-                    FAS_FLOAT c = (1.0f - delay) / (1.0f + delay);
+                int ibin = round(bin);
 
-                    osc->buffer[curr_sample] = osc->fp4[k][0] + c * in;
-                    osc->fp4[k][0] = in - c * osc->buffer[curr_sample];
+                // stereo spectral processing
+                for (d = 0; d < 2; d += 1) {
+                    if (instrument->p2 == 1) {
+                        instruments_states->stft_temp[d].re[ibin] = v[d];
+                        instruments_states->stft_temp[d].im[ibin] = p[d];
+                    } else {
+                        FAS_FLOAT real = instruments_states->stft_result[d].re[ibin];
+                        FAS_FLOAT imag = instruments_states->stft_result[d].im[ibin];
 
-                    FAS_FLOAT ol = osc->buffer[curr_sample];
+                        // polar
+                        FAS_FLOAT mag = sqrtf(real * real + imag * imag);
+                        FAS_FLOAT pha = atan2f(imag, real);
 
-                    osc->pvalue[k] = ol;
+                        mag *= v[d];
+                        pha *= p[d];
 
-                    output_l += vl * ol;
-                    output_r += vr * ol;
+                        // rectangular
+                        FAS_FLOAT creal = mag * cosf(pha);
+                        FAS_FLOAT cimag = mag * sinf(pha);
 
-                    osc->fphase[k] += phase_step;
-#ifdef WITH_SOUNDPIPE
+                        instruments_states->stft_temp[d].re[ibin] = creal;
+                        instruments_states->stft_temp[d].im[ibin] = cimag;
                     }
-#endif
                 }
-            } else if (synthesis_method == FAS_WAVETABLE_SYNTH) {
-                for (j = s; j < e; j += 1) {
-                    struct note *n = &curr_notes[j];
+            }
 
-                    struct oscillator *osc = &curr_synth.oscillators[n->osc_index];
+            // copy processing result
+            for (d = 0; d < 2; d += 1) {
+                for (w = 0; w < instruments_states->hop_size / 2; w += 1) {
+                    FAS_FLOAT re = instruments_states->stft_temp[d].re[w];
+                    FAS_FLOAT im = instruments_states->stft_temp[d].im[w];
 
-                    struct sample *smp = &waves[(int)osc->fp1[k][0]];
+                    instruments_states->stft_result[d].re[w] = re;
+                    instruments_states->stft_result[d].im[w] = im;
+                }
+            }
 
-                    unsigned int curr_sample_index = osc->fp1[k][1];
-                    unsigned int curr_sample_index2 = curr_sample_index + 1;
+            afSTFTinverse(instruments_states->afSTFT_handle, instruments_states->stft_result, instruments_states->out);
 
-                    FAS_FLOAT mu = osc->fp1[k][1] - (FAS_FLOAT)curr_sample_index;
+            instruments_states->position = 0;
+        }
 
-                    FAS_FLOAT wsmp = smp->data_l[curr_sample_index] + mu * (smp->data_l[curr_sample_index2] - smp->data_l[curr_sample_index]);
+        out_l[b] += instruments_states->out[0][instruments_states->position];
+        out_r[b] += instruments_states->out[1][instruments_states->position];
+    }
+}
 
-                    FAS_FLOAT vl = n->previous_volume_l + n->diff_volume_l * curr_synth.lerp_t;
-                    FAS_FLOAT vr = n->previous_volume_r + n->diff_volume_r * curr_synth.lerp_t;
+static void renderGranular(FAS_KERNEL_ARGS) {
+    struct _synth_instrument *instrument = &curr_synth.instruments[k];
 
-                    FAS_FLOAT fsmp = 0;
-                    if (n->res > 0) {
-                        // next sample interpolation
-                        struct sample *nsmp = &waves[(int)osc->fp2[k][0]];
+    int env_type = instrument->p0;
+    FAS_FLOAT *gr_env = grain_envelope[env_type];
 
-                        unsigned int nsample_index = osc->fp2[k][1];
-                        unsigned int nsample_index2 = nsample_index + 1;
-                        FAS_FLOAT nmu = osc->fp2[k][1] - (FAS_FLOAT)nsample_index;
-                        FAS_FLOAT nwsmp = nsmp->data_l[nsample_index] + nmu * (nsmp->data_l[nsample_index2] - nsmp->data_l[nsample_index]);
-                        //
+    if (s == e) {
+        return;
+    }
 
-                        fsmp = wsmp + fmin(osc->fp1[k][3], 1.0) * (nwsmp - wsmp);
+    computeGrains(curr_synth.grains, &curr_synth.grains->pools[k], curr_notes, s, e, samples, gr_env, instrument->p3, instrument->p1, instrument->p2, lerp_t, len, out_l, out_r);
+}
 
-                        osc->fp2[k][1] += osc->fp2[k][2];
- 
-                        osc->fp2[k][1] = fmod(osc->fp2[k][1], nsmp->frames);
-                    } else {
-                        fsmp = wsmp;
-                    }
+static void renderFM(FAS_KERNEL_ARGS) {
+    unsigned int j, b;
 
-                    output_l += vl * fsmp;
-                    output_r += vr * fsmp;
+    struct oscillators_state *state = &curr_synth.oscillators_state[k];
 
-                    osc->fp1[k][1] += osc->fp1[k][2];
-                    if (osc->fp1[k][1] >= smp->frames) {
-                        osc->fp1[k][1] = fmod(osc->fp1[k][1], smp->frames);
+    for (j = s; j < e; j += 1) {
+        struct note *n = &curr_notes[j];
 
-                        if (osc->fp1[k][3] >= 1) {
-                            unsigned int start_index = abs((int)round(n->blue)) % waves_count;
-                            unsigned int stop_index = abs((int)round(n->alpha)) % waves_count;
+        struct oscillator *osc = &curr_synth.oscillators[n->osc_index];
 
-                            unsigned int next_start_index = start_index;
+        FAS_FLOAT mod_phase_step = state->fp1[n->osc_index][4];
+        FAS_FLOAT car_wav_size = state->fp2[n->osc_index][0];
+        FAS_FLOAT mod_wav_size = state->fp2[n->osc_index][1];
 
-                            if (n->blue < 0) {
-                                osc->fp1[k][0] -= 1;
-                                next_start_index = stop_index;
-                            } else {
-                                osc->fp1[k][0] += 1;
-                            }
+        FAS_FLOAT fb_amount = floor(n->blue) / 65536.0;
 
-                            unsigned int current_index = osc->fp1[k][0];
+        for (b = 0; b < len; b += 1) {
+            FAS_FLOAT fbf = (state->fp1[n->osc_index][0] + state->fp1[n->osc_index][1]) / 2; // 'anti-hunting' filter (simple low-pass)
+            FAS_FLOAT fb = fbf * fb_amount;
 
-                            if (current_index < start_index) {
-                                osc->fp1[k][0] = next_start_index;
-                            }
+            FAS_FLOAT ph2 = fmod(state->phase_index2[n->osc_index] + (fb * mod_wav_size), mod_wav_size);
 
-                            if (current_index > stop_index) {
-                                osc->fp1[k][0] = next_start_index;
-                            }
+            FAS_FLOAT smp_mod = state->wav2[n->osc_index][(int)ph2];
+            FAS_FLOAT mod = (((FAS_FLOAT)smp_mod * state->fp3[n->osc_index][0]) * car_wav_size);
+            FAS_FLOAT ph1 = fmod(state->phase_index[n->osc_index] + mod, car_wav_size);
 
-                            if (n->blue > 0) {
-                                osc->fp2[k][0] = (unsigned int)(osc->fp1[k][0] + 1) % waves_count;
-                            } else {
-                                osc->fp2[k][0] = osc->fp1[k][0] - 1;
-                                if (osc->fp2[k][0] < 0) {
-                                    osc->fp2[k][0] = start_index;
-                                }
-                            }
+            int phase_index1 = (int)ph1;
+            int phase_index2 = phase_index1 + 1;
 
-                            struct sample *smp = &waves[(int)osc->fp1[k][0]];
-                            osc->fp1[k][2] = osc->freq / smp->pitch / ((FAS_FLOAT)fas_sample_rate / (FAS_FLOAT)smp->samplerate);
-                            osc->fp1[k][3] = 0;
+            FAS_FLOAT smp1 = state->wav1[n->osc_index][phase_index1];
+            FAS_FLOAT smp2 = state->wav1[n->osc_index][phase_index2];
 
-                            struct sample *nsmp = &waves[(int)osc->fp2[k][0]];
-                            osc->fp2[k][2] = osc->freq / nsmp->pitch / ((FAS_FLOAT)fas_sample_rate / (FAS_FLOAT)nsmp->samplerate);
+            FAS_FLOAT mu = ph1 - (FAS_FLOAT)phase_index1;
+            FAS_FLOAT smp = smp1 + mu * (smp2 - smp1);
 
-                            osc->fp1[k][1] = 0;
-                        }
-                    }
+            FAS_FLOAT vl = n->previous_volume_l + n->diff_volume_l * lerp_t[b];
+            FAS_FLOAT vr = n->previous_volume_r + n->diff_volume_r * lerp_t[b];
 
-                    osc->fp1[k][3] += osc->fp3[k][0];
-                }
-            } else if (synthesis_method == FAS_MODULATION) {
-                for (j = s; j < e; j += 1) {
-                    struct note *n = &curr_notes[j];
+            // dc filter (due to feedback there is a 0Hz component)
+            FAS_FLOAT dc_filtered_smp = smp - state->pvalue[n->osc_index] + (0.99 * state->fp1[n->osc_index][2]);
+            state->pvalue[n->osc_index] = smp;
+            state->fp1[n->osc_index][2] = dc_filtered_smp;
 
-                    if (instrument->p0 == 0) {
-                        // fx modulation
-                        int chn = ((int)floor(instrument->p1)) % fas_max_channels;
-                        int slot = ((int)floor(instrument->p2)) % FAS_MAX_FX_SLOTS;
-                        int target = 2 + ((int)floor(instrument->p3)) % FAS_MAX_FX_PARAMETERS;
-                        int easing_type = (int)instrument->p4 % (FAS_EASING_COUNT + 1);
+            out_l[b] += vl * dc_filtered_smp;
+            out_r[b] += vr * dc_filtered_smp;
 
-                        if (chn >= 0 && slot >= 0 && target >= 0) {
-                            struct _synth_chn_settings *target_chn_settings = &curr_synth.chn_settings[chn];
+            state->phase_index[n->osc_index] += state->fp1[n->osc_index][3];
+            state->phase_index2[n->osc_index] += mod_phase_step;
 
-                            FAS_FLOAT value = lerp(n->palpha, n->alpha, applyEasing(easing_type, curr_synth.lerp_t));
+            // feedback
+            state->fp1[n->osc_index][0] = state->fp1[n->osc_index][1];
+            state->fp1[n->osc_index][1] = vl * smp_mod;
+        }
+    }
+}
 
-                            updateEffectParameter(
-#ifdef WITH_SOUNDPIPE
-                                sp,
-#endif                    
-                                synth_fx[chn], target_chn_settings, slot, target, value);
-                        }
-                    } else if (instrument->p0 == 1) {
-                        // chn settings modulation
-                        int instrument_index = ((int)floor(instrument->p1)) % fas_max_instruments;
-                        int param = ((int)floor(instrument->p2)) % 6;
-                        int easing_type = ((int)floor(instrument->p4)) % (FAS_EASING_COUNT + 1);
-
-                        if (instrument_index >= 0 && param >= 0) {
-                            FAS_FLOAT value = lerp(n->palpha, n->alpha, applyEasing(easing_type, curr_synth.lerp_t));
-                            
-                            struct _synth_instrument *target_instrument = &curr_synth.instruments[instrument_index];
-                            if (param == 0) {
-                                target_instrument->p0 = value;
-                            } else if (param == 1) {
-                                target_instrument->p1 = value;
-                            } else if (param == 2) {
-                                target_instrument->p2 = value;
-                            } else if (param == 3) {
-                                target_instrument->p3 = value;
-                            } else if (param == 4) {
-                                target_instrument->p4 = value;
-                            }
-                        }
-                    }
-                }
-            } else if (synthesis_method == FAS_INPUT) {
-                for (j = s; j < e; j += 1) {
-                    struct note *n = &curr_notes[j];
+/**
+ * Subtractive synthesis kernels; they are specialised by waveform (note alpha) and filter (instrument p0)
+ * so that the samples loop has no branches, a note kernel is picked once per block
+ **/
+// waveforms; implementation from http://www.martin-finke.de/blog/articles/audio-plugins-018-polyblep-oscillator/
+static inline FAS_FLOAT waveformSaw(unsigned int k, struct oscillator *osc, struct oscillators_state *state, unsigned int y) {
+    FAS_FLOAT t = state->fphase[y] / M_PI2;
 
-                    struct oscillator *osc = &curr_synth.oscillators[n->osc_index];
+    FAS_FLOAT smp = raw_waveform(state->fphase[y], 1);
+    smp -= poly_blep(osc->phase_increment, t);
 
-                    FAS_FLOAT vl = n->previous_volume_l + n->diff_volume_l * curr_synth.lerp_t;
-                    FAS_FLOAT vr = n->previous_volume_r + n->diff_volume_r * curr_synth.lerp_t;
+    return smp;
+}
 
-                    int chn_count = fas_input_channels / 2;
-                    int chn = abs((int)n->blue) % chn_count;
+static inline FAS_FLOAT waveformSquare(unsigned int k, struct oscillator *osc, struct oscillators_state *state, unsigned int y) {
+    FAS_FLOAT t = state->fphase[y] / M_PI2;
 
-#ifdef INTERLEAVED_SAMPLE_FORMAT
-                    output_l += audio_in[i * 2 * chn_count + chn * 2] * vl;
-                    output_r += audio_in[i * 2 * chn_count + 1 + chn * 2] * vr;
-#else
-                    output_l += inputBuffer[chn][i] * vl;
-                    output_r += inputBuffer[chn][i] * vr;
-#endif
-                }
-            }
-#ifdef WITH_SOUNDPIPE
-            else if (synthesis_method == FAS_BANDPASS) {
-                for (j = s; j < e; j += 1) {
-                    struct note *n = &curr_notes[j];
+    FAS_FLOAT smp = raw_waveform(state->fphase[y], 2);
+    smp += poly_blep(osc->phase_increment, t);
+    smp -= poly_blep(osc->phase_increment, fmod(t + 0.5, 1.0));
 
-                    struct oscillator *osc = &curr_synth.oscillators[n->osc_index];
+    return smp;
+}
 
-                    FAS_FLOAT vl = n->previous_volume_l + n->diff_volume_l * curr_synth.lerp_t;
-                    FAS_FLOAT vr = n->previous_volume_r + n->diff_volume_r * curr_synth.lerp_t;
+static inline FAS_FLOAT waveformTriangle(unsigned int k, struct oscillator *osc, struct oscillators_state *state, unsigned int y) {
+    FAS_FLOAT t = state->fphase[y] / M_PI2;
 
-                    double bint = 0;
-                    FAS_FLOAT bflt = modf(fabs(n->blue), &bint);
+    FAS_FLOAT smp = raw_waveform(state->fphase[y], 3);
+    smp += poly_blep(osc->phase_increment, t);
+    smp -= poly_blep(osc->phase_increment, fmod(t + 0.5, 1.0));
+    smp = osc->phase_increment * smp + (1.0 - osc->phase_increment) * state->pvalue[y];
+    state->pvalue[y] = smp;
 
-                    FAS_FLOAT il;
-                    FAS_FLOAT ir;
+    return smp;
+}
 
-                    if (bflt > 0) {
-                        int chn = (int)bint % fas_max_channels;
-                        struct _synth_chn_settings *input_chn_settings = &curr_synth.chn_settings[chn];
+static inline FAS_FLOAT waveformWhiteNoise(unsigned int k, struct oscillator *osc, struct oscillators_state *state, unsigned int y) {
+    FAS_FLOAT smp;
 
-                        il = input_chn_settings->last_sample_l * vl;
-                        ir = input_chn_settings->last_sample_r * vr;
-                    } else {
-                        int instrument_index = (int)bint % fas_max_instruments;
-                        struct _synth_instrument *instrument = &curr_synth.instruments[instrument_index];
+#ifdef WITH_SOUNDPIPE
+    sp_noise_compute(&fas_instruments_sp[k], (sp_noise *)osc->sp_gens[k][SP_WHITE_NOISE_GENERATOR], NULL, &smp);
+#else
+    smp = fas_white_noise_table[(int)state->phase_index[y]];
 
-                        il = instrument->last_sample_l * vl;
-                        ir = instrument->last_sample_r * vr; 
-                    }
+    state->phase_index[y] += osc->phase_step;
+    state->phase_index[y] = fmod(state->phase_index[y], fas_wavetable_size);
+#endif
 
-                    FAS_FLOAT sl = 0.0f;
-                    FAS_FLOAT sr = 0.0f;
+    return smp;
+}
 
-                    sp_butbp_compute(sp, (sp_butbp *)osc->sp_filters[k][SP_BANDPASS_FILTER_L], &il, &sl);
-                    sp_butbp_compute(sp, (sp_butbp *)osc->sp_filters[k][SP_BANDPASS_FILTER_R], &ir, &sr);
+#ifdef WITH_SOUNDPIPE
+static inline FAS_FLOAT waveformPinkNoise(unsigned int k, struct oscillator *osc, struct oscillators_state *state, unsigned int y) {
+    FAS_FLOAT smp;
 
-                    output_l += sl * vl;
-                    output_r += sr * vr;
-                }
-            } else if (synthesis_method == FAS_FORMANT_SYNTH) {
-                for (j = s; j < e; j += 1) {
-                    struct note *n = &curr_notes[j];
+    sp_pinknoise_compute(&fas_instruments_sp[k], (sp_pinknoise *)osc->sp_gens[k][SP_PINK_NOISE_GENERATOR], NULL, &smp);
 
-                    struct oscillator *osc = &curr_synth.oscillators[n->osc_index];
+    return smp;
+}
 
-                    FAS_FLOAT vl = n->previous_volume_l + n->diff_volume_l * curr_synth.lerp_t;
-                    FAS_FLOAT vr = n->previous_volume_r + n->diff_volume_r * curr_synth.lerp_t;
+static inline FAS_FLOAT waveformBrownNoise(unsigned int k, struct oscillator *osc, struct oscillators_state *state, unsigned int y) {
+    FAS_FLOAT smp;
 
-                    double bint = 0;
-                    FAS_FLOAT bflt = modf(fabs(n->blue), &bint);
+    sp_brown_compute(&fas_instruments_sp[k], (sp_brown *)osc->sp_gens[k][SP_BROWN_NOISE_GENERATOR], NULL, &smp);
 
-                    FAS_FLOAT il;
-                    FAS_FLOAT ir;
+    return smp;
+}
+#else
+// pink / brown noise need Soundpipe
+static inline FAS_FLOAT waveformPinkNoise(unsigned int k, struct oscillator *osc, struct oscillators_state *state, unsigned int y) {
+    return 0;
+}
 
-                    int chn = (int)bint % fas_max_channels;
-                    struct _synth_chn_settings *input_chn_settings = &curr_synth.chn_settings[chn];
+#define waveformBrownNoise waveformPinkNoise
+#endif
 
-                    il = input_chn_settings->last_sample_l * vl;
-                    ir = input_chn_settings->last_sample_r * vr;
+// filters
+#ifdef WITH_SOUNDPIPE
+static inline FAS_FLOAT filterMoog(unsigned int k, struct oscillator *osc, struct oscillators_state *state, struct note *n, FAS_FLOAT smp) {
+    sp_moogladder_compute(&fas_instruments_sp[k], (sp_moogladder *)osc->sp_filters[k][SP_MOOG_FILTER], &smp, &smp);
 
-                    FAS_FLOAT sl = 0.0f;
-                    FAS_FLOAT sr = 0.0f;
+    return smp;
+}
 
-                    sp_fofilt_compute(sp, (sp_fofilt *)osc->sp_filters[k][SP_FORMANT_FILTER_L], &il, &sl);
-                    sp_fofilt_compute(sp, (sp_fofilt *)osc->sp_filters[k][SP_FORMANT_FILTER_R], &ir, &sr);
+static inline FAS_FLOAT filterDiode(unsigned int k, struct oscillator *osc, struct oscillators_state *state, struct note *n, FAS_FLOAT smp) {
+    sp_diode_compute(&fas_instruments_sp[k], (sp_diode *)osc->sp_filters[k][SP_DIODE_FILTER], &smp, &smp);
 
-                    output_l += sl * vl;
-                    output_r += sr * vr;
-                }
-            } else if (synthesis_method == FAS_STRING_RESON) {
-                for (j = s; j < e; j += 1) {
-                    struct note *n = &curr_notes[j];
+    return smp;
+}
 
-                    struct oscillator *osc = &curr_synth.oscillators[n->osc_index];
+static inline FAS_FLOAT filterKorg35(unsigned int k, struct oscillator *osc, struct oscillators_state *state, struct note *n, FAS_FLOAT smp) {
+    sp_wpkorg35_compute(&fas_instruments_sp[k], (sp_wpkorg35 *)osc->sp_filters[k][SP_KORG35_FILTER], &smp, &smp);
 
-                    FAS_FLOAT vl = n->previous_volume_l + n->diff_volume_l * curr_synth.lerp_t;
-                    FAS_FLOAT vr = n->previous_volume_r + n->diff_volume_r * curr_synth.lerp_t;
+    return smp;
+}
 
-                    double bint = 0;
-                    FAS_FLOAT bflt = modf(fabs(n->blue), &bint);
+static inline FAS_FLOAT filterLpf18(unsigned int k, struct oscillator *osc, struct oscillators_state *state, struct note *n, FAS_FLOAT smp) {
+    sp_lpf18_compute(&fas_instruments_sp[k], (sp_lpf18 *)osc->sp_filters[k][SP_LPF18_FILTER], &smp, &smp);
 
-                    FAS_FLOAT il;
-                    FAS_FLOAT ir;
+    return smp;
+}
 
-                    if (bflt > 0) {
-                        int chn = (int)bint % fas_max_channels;
-                        struct _synth_chn_settings *input_chn_settings = &curr_synth.chn_settings[chn];
+static inline FAS_FLOAT filterNone(unsigned int k, struct oscillator *osc, struct oscillators_state *state, struct note *n, FAS_FLOAT smp) {
+    return smp;
+}
+#else
+// without Soundpipe all filter types use the Huovilainen Moog filter
+static inline FAS_FLOAT filterHuovilainen(unsigned int k, struct oscillator *osc, struct oscillators_state *state, struct note *n, FAS_FLOAT smp) {
+    return huovilainen_moog(smp, n->cutoff, n->res, state->fp1[n->osc_index], state->fp2[n->osc_index], state->fp3[n->osc_index], 2);
+}
+#endif
 
-                        il = input_chn_settings->last_sample_l * vl;
-                        ir = input_chn_settings->last_sample_r * vr;
-                    } else {
-                        int instrument_index = (int)bint % fas_max_instruments;
-                        struct _synth_instrument *instrument = &curr_synth.instruments[instrument_index];
+#define FAS_SUBTRACTIVE_NOTE_KERNEL(WAVEFORM, FILTER) \
+static void subtractive##WAVEFORM##FILTER(unsigned int k, struct note *n, struct oscillators_state *state, FAS_FLOAT *lerp_t, unsigned int len, FAS_FLOAT *out_l, FAS_FLOAT *out_r) { \
+    struct oscillator *osc = &curr_synth.oscillators[n->osc_index]; \
+    unsigned int y = n->osc_index; \
+    unsigned int b; \
+    \
+    for (b = 0; b < len; b += 1) { \
+        FAS_FLOAT smp = waveform##WAVEFORM(k, osc, state, y); \
+        \
+        state->fphase[y] += osc->phase_increment; \
+        while (state->fphase[y] >= M_PI2) { \
+            state->fphase[y] -= M_PI2; \
+        } \
+        \
+        FAS_FLOAT vl = n->previous_volume_l + n->diff_volume_l * lerp_t[b]; \
+        FAS_FLOAT vr = n->previous_volume_r + n->diff_volume_r * lerp_t[b]; \
+        \
+        smp = filter##FILTER(k, osc, state, n, smp); \
+        \
+        out_l[b] += vl * smp; \
+        out_r[b] += vr * smp; \
+    } \
+}
 
-                        il = instrument->last_sample_l * vl;
-                        ir = instrument->last_sample_r * vr; 
-                    }
+// instrument kernel of a filter; notes kernels are indexed by waveform
+#define FAS_SUBTRACTIVE_KERNEL(FILTER) \
+FAS_SUBTRACTIVE_NOTE_KERNEL(Saw, FILTER) \
+FAS_SUBTRACTIVE_NOTE_KERNEL(Square, FILTER) \
+FAS_SUBTRACTIVE_NOTE_KERNEL(Triangle, FILTER) \
+FAS_SUBTRACTIVE_NOTE_KERNEL(WhiteNoise, FILTER) \
+FAS_SUBTRACTIVE_NOTE_KERNEL(PinkNoise, FILTER) \
+FAS_SUBTRACTIVE_NOTE_KERNEL(BrownNoise, FILTER) \
+\
+static const fas_note_kernel subtractive##FILTER##Kernels[6] = { \
+    subtractiveSaw##FILTER, \
+    subtractiveSquare##FILTER, \
+    subtractiveTriangle##FILTER, \
+    subtractiveWhiteNoise##FILTER, \
+    subtractivePinkNoise##FILTER, \
+    subtractiveBrownNoise##FILTER \
+}; \
+\
+static void renderSubtractive##FILTER(FAS_KERNEL_ARGS) { \
+    struct oscillators_state *state = &curr_synth.oscillators_state[k]; \
+    unsigned int j; \
+    \
+    for (j = s; j < e; j += 1) { \
+        struct note *n = &curr_notes[j]; \
+        \
+        int waveform = ((int)fabs(floor(n->alpha))) % 6; \
+        \
+        subtractive##FILTER##Kernels[waveform](k, n, state, lerp_t, len, out_l, out_r); \
+    } \
+}
 
-                    FAS_FLOAT sl = 0.0f;
-                    FAS_FLOAT sr = 0.0f;
+#ifdef WITH_SOUNDPIPE
+FAS_SUBTRACTIVE_KERNEL(Moog)
+FAS_SUBTRACTIVE_KERNEL(Diode)
+FAS_SUBTRACTIVE_KERNEL(Korg35)
+FAS_SUBTRACTIVE_KERNEL(Lpf18)
+FAS_SUBTRACTIVE_KERNEL(None)
+
+// indexed by instrument p0 (filter type), other values are unfiltered
+static const fas_render_kernel fas_subtractive_kernels[4] = {
+    renderSubtractiveMoog,
+    renderSubtractiveDiode,
+    renderSubtractiveKorg35,
+    renderSubtractiveLpf18
+};
+#else
+FAS_SUBTRACTIVE_KERNEL(Huovilainen)
+#endif
 
-                    sp_streson_compute(sp, (sp_streson *)osc->sp_filters[k][SP_STRES_FILTER_L], &il, &sl);
-                    sp_streson_compute(sp, (sp_streson *)osc->sp_filters[k][SP_STRES_FILTER_R], &ir, &sr);
+static void renderPhysicalModelling(FAS_KERNEL_ARGS) {
+    unsigned int j, b;
 
-                    output_l += sl * vl;
-                    output_r += sr * vr;
-                }
-            } else if (synthesis_method == FAS_MODAL_SYNTH) {
-                for (j = s; j < e; j += 1) {
-                    struct note *n = &curr_notes[j];
+    struct _synth_instrument *instrument = &curr_synth.instruments[k];
+    struct oscillators_state *state = &curr_synth.oscillators_state[k];
 
-                    struct oscillator *osc = &curr_synth.oscillators[n->osc_index];
+    int model_type = instrument->p0;
+    for (j = s; j < e; j += 1) {
+        struct note *n = &curr_notes[j];
 
-                    FAS_FLOAT vl = n->previous_volume_l + n->diff_volume_l * curr_synth.lerp_t;
-                    FAS_FLOAT vr = n->previous_volume_r + n->diff_volume_r * curr_synth.lerp_t;
+        struct oscillator *osc = &curr_synth.oscillators[n->osc_index];
 
-                    double bint = 0;
-                    FAS_FLOAT bflt = modf(fabs(n->blue), &bint);
+#ifdef WITH_SOUNDPIPE
+        if (model_type == 2) {
+            for (b = 0; b < len; b += 1) {
+                FAS_FLOAT vl = n->previous_volume_l + n->diff_volume_l * lerp_t[b];
+                FAS_FLOAT vr = n->previous_volume_r + n->diff_volume_r * lerp_t[b];
 
-                    FAS_FLOAT il;
-                    FAS_FLOAT ir;
+                FAS_FLOAT trigger_l = ((n->previous_volume_l <= 0) || state->triggered[n->osc_index]) ? 1.f : 0.f;
+                FAS_FLOAT trigger_r = ((n->previous_volume_r <= 0) || state->triggered[n->osc_index]) ? 1.f : 0.f;
+                FAS_FLOAT bar_out_l = 0.;
+                FAS_FLOAT bar_out_r = 0.;
 
-                    if (bflt > 0) {
-                        int chn = (int)bint % fas_max_channels;
-                        struct _synth_chn_settings *input_chn_settings = &curr_synth.chn_settings[chn];
+                sp_bar_compute(&fas_instruments_sp[k], (sp_bar *)osc->sp_gens[k][SP_BAR_GENERATOR], &trigger_l, &bar_out_l);
+                sp_bar_compute(&fas_instruments_sp[k], (sp_bar *)osc->sp_gens[k][SP_BAR_GENERATOR], &trigger_r, &bar_out_r);
 
-                        il = input_chn_settings->last_sample_l * vl;
-                        ir = input_chn_settings->last_sample_r * vr;
-                    } else {
-                        int instrument_index = (int)bint % fas_max_instruments;
-                        struct _synth_instrument *instrument = &curr_synth.instruments[instrument_index];
+                out_l[b] += vl * bar_out_l;
+                out_r[b] += vr * bar_out_r;
 
-                        il = instrument->last_sample_l * vl;
-                        ir = instrument->last_sample_r * vr; 
-                    }
+                if (state->triggered[n->osc_index]) {
+                    state->triggered[n->osc_index] = 0;
+                }
+            }
+        } else if (model_type == 1) {
+            for (b = 0; b < len; b += 1) {
+                FAS_FLOAT vl = n->previous_volume_l + n->diff_volume_l * lerp_t[b];
+                FAS_FLOAT vr = n->previous_volume_r + n->diff_volume_r * lerp_t[b];
+
+                FAS_FLOAT trigger_l = ((n->previous_volume_l <= 0) || state->triggered[n->osc_index]) ? 1.f : 0.f;
+                FAS_FLOAT trigger_r = ((n->previous_volume_r <= 0) || state->triggered[n->osc_index]) ? 1.f : 0.f;
+                FAS_FLOAT drip_out_l = 0.;
+                FAS_FLOAT drip_out_r = 0.;
 
-                    FAS_FLOAT sl = 0.0f;
-                    FAS_FLOAT sr = 0.0f;
+                sp_drip_compute(&fas_instruments_sp[k], (sp_drip *)osc->sp_gens[k][SP_DRIP_GENERATOR], &trigger_l, &drip_out_l);
+                sp_drip_compute(&fas_instruments_sp[k], (sp_drip *)osc->sp_gens[k][SP_DRIP_GENERATOR], &trigger_r, &drip_out_r);
 
-                    sp_mode_compute(sp, (sp_mode *)osc->sp_filters[k][SP_MODE_FILTER_L], &il, &sl);
-                    sp_mode_compute(sp, (sp_mode *)osc->sp_filters[k][SP_MODE_FILTER_R], &ir, &sr);
+                out_l[b] += vl * drip_out_l;
+                out_r[b] += vr * drip_out_r;
 
-                    output_l += sl * vl;
-                    output_r += sr * vr;
+                if (state->triggered[n->osc_index]) {
+                    state->triggered[n->osc_index] = 0;
                 }
-            } else if (synthesis_method == FAS_PHASE_DISTORSION) {
-                for (j = s; j < e; j += 1) {
-                    struct note *n = &curr_notes[j];
+            }
+        } else if (model_type == 0) {
+#endif
+        FAS_FLOAT phase_step = osc->freq / (FAS_FLOAT)fas_sample_rate * (osc->buffer_len + 0.5);
 
-                    struct oscillator *osc = &curr_synth.oscillators[n->osc_index];
+        unsigned int si = osc->buffer_offset;
 
-                    FAS_FLOAT vl = n->previous_volume_l + n->diff_volume_l * curr_synth.lerp_t;
-                    FAS_FLOAT vr = n->previous_volume_r + n->diff_volume_r * curr_synth.lerp_t;
+        FAS_FLOAT stretch = state->fp1[n->osc_index][0];
 
-                    double bint = 0;
-                    FAS_FLOAT bflt = modf(fabs(n->blue), &bint);
+        // allpass
+        FAS_FLOAT delay = fabs((FAS_FLOAT)osc->buffer_len - ((FAS_FLOAT)fas_sample_rate / osc->freq));
+        FAS_FLOAT c = (1.0f - delay) / (1.0f + delay);
 
-                    FAS_FLOAT il;
-                    FAS_FLOAT ir;
+        // stretch decision random values of the block
+        FAS_FLOAT stretch_rnd[FAS_BLOCK_SIZE];
+        randfBatch(stretch_rnd, len, 0.f, 1.f);
 
-                    if (bflt > 0) {
-                        int chn = (int)bint % fas_max_channels;
-                        struct _synth_chn_settings *input_chn_settings = &curr_synth.chn_settings[chn];
+        for (b = 0; b < len; b += 1) {
+            FAS_FLOAT vl = n->previous_volume_l + n->diff_volume_l * lerp_t[b];
+            FAS_FLOAT vr = n->previous_volume_r + n->diff_volume_r * lerp_t[b];
 
-                        il = input_chn_settings->last_sample_l * vl;
-                        ir = input_chn_settings->last_sample_r * vr;
-                    } else {
-                        int instrument_index = (int)bint % fas_max_instruments;
-                        struct _synth_instrument *instrument = &curr_synth.instruments[instrument_index];
+            unsigned int curr_sample_index = state->fphase[n->osc_index];
+            unsigned int curr_sample_index2 = curr_sample_index + 1;
 
-                        il = instrument->last_sample_l * vl;
-                        ir = instrument->last_sample_r * vr; 
-                    }
+            FAS_FLOAT mu = state->fphase[n->osc_index] - (FAS_FLOAT)curr_sample_index;
 
-                    FAS_FLOAT sl = 0.0f;
-                    FAS_FLOAT sr = 0.0f;
+            unsigned int curr_sample = si + (curr_sample_index % osc->buffer_len);
+            unsigned int curr_sample2 = si + (curr_sample_index2 % osc->buffer_len);
 
-                    sp_pdhalf_compute(sp, (sp_pdhalf *)osc->sp_gens[k][SP_PD_GENERATOR], &il, &sl);
-                    sp_pdhalf_compute(sp, (sp_pdhalf *)osc->sp_gens[k][SP_PD_GENERATOR], &ir, &sr);
+            FAS_FLOAT smp = state->buffer[curr_sample];
 
-                    output_l += sl * vl;
-                    output_r += sr * vr;
-                }
+            FAS_FLOAT in = 0.0f;
+            if (stretch <= stretch_rnd[b]) {
+                in = 0.5f * ((smp + mu * (state->buffer[curr_sample2] - smp)) + state->pvalue[n->osc_index]);
+            } else {
+                in = smp;
             }
+
+            state->buffer[curr_sample] = state->fp4[n->osc_index][0] + c * in;
+            state->fp4[n->osc_index][0] = in - c * state->buffer[curr_sample];
+
+            FAS_FLOAT ol = state->buffer[curr_sample];
+
+            state->pvalue[n->osc_index] = ol;
+
+            out_l[b] += vl * ol;
+            out_r[b] += vr * ol;
+
+            state->fphase[n->osc_index] += phase_step;
+        }
+#ifdef WITH_SOUNDPIPE
+        }
 #endif
-#ifdef WITH_FAUST
-            else if (synthesis_method == FAS_FAUST) {
-                for (j = s; j < e; j += 1) {
-                    struct note *n = &curr_notes[j];
+    }
+}
+
+static void renderWavetable(FAS_KERNEL_ARGS) {
+    unsigned int j, b;
+
+    struct oscillators_state *state = &curr_synth.oscillators_state[k];
+
+    for (j = s; j < e; j += 1) {
+        struct note *n = &curr_notes[j];
+
+        struct oscillator *osc = &curr_synth.oscillators[n->osc_index];
+
+        for (b = 0; b < len; b += 1) {
+            struct sample *smp = &waves[(int)state->fp1[n->osc_index][0]];
 
-                    struct oscillator *osc = &curr_synth.oscillators[n->osc_index];
+            unsigned int curr_sample_index = state->fp1[n->osc_index][1];
+            unsigned int curr_sample_index2 = curr_sample_index + 1;
 
-                    FAS_FLOAT vl = n->previous_volume_l + n->diff_volume_l * curr_synth.lerp_t;
-                    FAS_FLOAT vr = n->previous_volume_r + n->diff_volume_r * curr_synth.lerp_t;
+            FAS_FLOAT mu = state->fp1[n->osc_index][1] - (FAS_FLOAT)curr_sample_index;
 
-                    int faust_dsp_index = instrument->p0 % osc->faust_gens_len;
+            FAS_FLOAT wsmp = smp->data_l[curr_sample_index] + mu * (smp->data_l[curr_sample_index2] - smp->data_l[curr_sample_index]);
 
-                    struct _fas_faust_dsp *fas_faust_dsp = osc->faust_gens[k][faust_dsp_index];
+            FAS_FLOAT vl = n->previous_volume_l + n->diff_volume_l * lerp_t[b];
+            FAS_FLOAT vr = n->previous_volume_r + n->diff_volume_r * lerp_t[b];
 
-                    // update Faust DSP params
-                    struct _fas_faust_ui_control *ctrl = fas_faust_dsp->controls;
+            FAS_FLOAT fsmp = 0;
+            if (n->res > 0) {
+                // next sample interpolation
+                struct sample *nsmp = &waves[(int)state->fp2[n->osc_index][0]];
 
-                    struct _fas_faust_ui_control *tmp;
-                    // note : p0 is used as the Faust generator index
-                    tmp = getFaustControl(ctrl, "fs_p0");
-                    if (tmp) {
-                        *tmp->zone = instrument->p1;
+                unsigned int nsample_index = state->fp2[n->osc_index][1];
+                unsigned int nsample_index2 = nsample_index + 1;
+                FAS_FLOAT nmu = state->fp2[n->osc_index][1] - (FAS_FLOAT)nsample_index;
+                FAS_FLOAT nwsmp = nsmp->data_l[nsample_index] + nmu * (nsmp->data_l[nsample_index2] - nsmp->data_l[nsample_index]);
+                //
+
+                fsmp = wsmp + fmin(state->fp1[n->osc_index][3], 1.0) * (nwsmp - wsmp);
+
+                state->fp2[n->osc_index][1] += state->fp2[n->osc_index][2];
+
+                state->fp2[n->osc_index][1] = fmod(state->fp2[n->osc_index][1], nsmp->frames);
+            } else {
+                fsmp = wsmp;
+            }
+
+            out_l[b] += vl * fsmp;
+            out_r[b] += vr * fsmp;
+
+            state->fp1[n->osc_index][1] += state->fp1[n->osc_index][2];
+            if (state->fp1[n->osc_index][1] >= smp->frames) {
+                state->fp1[n->osc_index][1] = fmod(state->fp1[n->osc_index][1], smp->frames);
+
+                if (state->fp1[n->osc_index][3] >= 1) {
+                    unsigned int start_index = abs((int)round(n->blue)) % waves_count;
+                    unsigned int stop_index = abs((int)round(n->alpha)) % waves_count;
+
+                    unsigned int next_start_index = start_index;
+
+                    if (n->blue < 0) {
+                        state->fp1[n->osc_index][0] -= 1;
+                        next_start_index = stop_index;
+                    } else {
+                        state->fp1[n->osc_index][0] += 1;
                     }
 
-                    tmp = getFaustControl(ctrl, "fs_p1");
-                    if (tmp) {
-                        *tmp->zone = instrument->p2;
+                    unsigned int current_index = state->fp1[n->osc_index][0];
+
+                    if (current_index < start_index) {
+                        state->fp1[n->osc_index][0] = next_start_index;
                     }
 
-                    tmp = getFaustControl(ctrl, "fs_p2");
-                    if (tmp) {
-                        *tmp->zone = instrument->p3;
+                    if (current_index > stop_index) {
+                        state->fp1[n->osc_index][0] = next_start_index;
                     }
 
-                    tmp = getFaustControl(ctrl, "fs_p3");
-                    if (tmp) {
-                        *tmp->zone = instrument->p4;
+                    if (n->blue > 0) {
+                        state->fp2[n->osc_index][0] = (unsigned int)(state->fp1[n->osc_index][0] + 1) % waves_count;
+                    } else {
+                        state->fp2[n->osc_index][0] = state->fp1[n->osc_index][0] - 1;
+                        if (state->fp2[n->osc_index][0] < 0) {
+                            state->fp2[n->osc_index][0] = start_index;
+                        }
                     }
 
-                    int faust_dsp_input_count = getNumInputsCDSPInstance(fas_faust_dsp->dsp);
-                    if (faust_dsp_input_count >= 1) {
-                        double bint = 0;
-                        FAS_FLOAT bflt = modf(fabs(n->blue), &bint);
+                    struct sample *smp = &waves[(int)state->fp1[n->osc_index][0]];
+                    state->fp1[n->osc_index][2] = osc->freq / smp->pitch / ((FAS_FLOAT)fas_sample_rate / (FAS_FLOAT)smp->samplerate);
+                    state->fp1[n->osc_index][3] = 0;
 
-                        FAS_FLOAT il;
-                        FAS_FLOAT ir;
+                    struct sample *nsmp = &waves[(int)state->fp2[n->osc_index][0]];
+                    state->fp2[n->osc_index][2] = osc->freq / nsmp->pitch / ((FAS_FLOAT)fas_sample_rate / (FAS_FLOAT)nsmp->samplerate);
 
-                        if (bflt > 0) {
-                            int chn = (int)bint % fas_max_channels;
-                            struct _synth_chn_settings *input_chn_settings = &curr_synth.chn_settings[chn];
+                    state->fp1[n->osc_index][1] = 0;
+                }
+            }
 
-                            il = input_chn_settings->last_sample_l * vl;
-                            ir = input_chn_settings->last_sample_r * vr;
-                        } else {
-                            int instrument_index = (int)bint % fas_max_instruments;
-                            struct _synth_instrument *instrument = &curr_synth.instruments[instrument_index];
+            state->fp1[n->osc_index][3] += state->fp3[n->osc_index][0];
+        }
+    }
+}
 
-                            il = instrument->last_sample_l * vl;
-                            ir = instrument->last_sample_r * vr; 
-                        }
+static void renderModulation(FAS_KERNEL_ARGS) {
+    unsigned int j;
 
-                        FAS_FLOAT sl = 0.0f;
-                        FAS_FLOAT sr = 0.0f;
+    struct _synth_instrument *instrument = &curr_synth.instruments[k];
 
-                        FAUSTFLOAT *faust_input[2] = { &il, &ir };
-                        FAUSTFLOAT *faust_output[2] = { &sl, &sr };
+    // modulation is applied once per block with the block last sample interpolation factor
+    FAS_FLOAT mod_lerp_t = lerp_t[len - 1];
 
-                        computeCDSPInstance(fas_faust_dsp->dsp, 1, faust_input, faust_output);
+    for (j = s; j < e; j += 1) {
+        struct note *n = &curr_notes[j];
 
-                        output_l += sl * vl;
-                        output_r += sr * vr;
-                    } else {
-                        FAS_FLOAT sl = 0.0f;
-                        FAS_FLOAT sr = 0.0f;
+        if (instrument->p0 == 0) {
+            // fx modulation
+            int chn = ((int)floor(instrument->p1)) % fas_max_channels;
+            int slot = ((int)floor(instrument->p2)) % FAS_MAX_FX_SLOTS;
+            int target = 2 + ((int)floor(instrument->p3)) % FAS_MAX_FX_PARAMETERS;
+            int easing_type = (int)instrument->p4 % (FAS_EASING_COUNT + 1);
 
-                        FAUSTFLOAT *faust_output[2] = { &sl, &sr };
+            if (chn >= 0 && slot >= 0 && target >= 0) {
+                struct _synth_chn_settings *target_chn_settings = &curr_synth.chn_settings[chn];
 
-                        computeCDSPInstance(fas_faust_dsp->dsp, 1, NULL, faust_output);
+                FAS_FLOAT value = lerp(n->palpha, n->alpha, applyEasing(easing_type, mod_lerp_t));
 
-                        output_l += sl * vl;
-                        output_r += sr * vr;
-                    }
+                updateEffectParameter(
+#ifdef WITH_SOUNDPIPE
+                    sp,
+#endif
+                    synth_fx[chn], target_chn_settings, slot, target, value);
+            }
+        } else if (instrument->p0 == 1) {
+            // chn settings modulation
+            int instrument_index = ((int)floor(instrument->p1)) % fas_max_instruments;
+            int param = ((int)floor(instrument->p2)) % 6;
+            int easing_type = ((int)floor(instrument->p4)) % (FAS_EASING_COUNT + 1);
+
+            if (instrument_index >= 0 && param >= 0) {
+                FAS_FLOAT value = lerp(n->palpha, n->alpha, applyEasing(easing_type, mod_lerp_t));
+
+                struct _synth_instrument *target_instrument = &curr_synth.instruments[instrument_index];
+                if (param == 0) {
+                    target_instrument->p0 = value;
+                } else if (param == 1) {
+                    target_instrument->p1 = value;
+                } else if (param == 2) {
+                    target_instrument->p2 = value;
+                } else if (param == 3) {
+                    target_instrument->p3 = value;
+                } else if (param == 4) {
+                    target_instrument->p4 = value;
                 }
             }
+        }
+    }
+}
+
+static void renderInput(FAS_KERNEL_ARGS) {
+    unsigned int j, b;
+
+    int chn_count = fas_input_channels / 2;
+
+    for (j = s; j < e; j += 1) {
+        struct note *n = &curr_notes[j];
+
+        int chn = abs((int)n->blue) % chn_count;
+
+        for (b = 0; b < len; b += 1) {
+            FAS_FLOAT vl = n->previous_volume_l + n->diff_volume_l * lerp_t[b];
+            FAS_FLOAT vr = n->previous_volume_r + n->diff_volume_r * lerp_t[b];
+
+#ifdef INTERLEAVED_SAMPLE_FORMAT
+            out_l[b] += audio_in[(i + b) * 2 * chn_count + chn * 2] * vl;
+            out_r[b] += audio_in[(i + b) * 2 * chn_count + 1 + chn * 2] * vr;
+#else
+            out_l[b] += inputBuffer[chn][i + b] * vl;
+            out_r[b] += inputBuffer[chn][i + b] * vr;
 #endif
-            else if (synthesis_method == FAS_VOID) {
-                break;
-            }
+        }
+    }
+}
 
-            if (!instrument->muted) {
-                chn_settings->output_l += output_l;
-                chn_settings->output_r += output_r;
-            }
+#ifdef WITH_SOUNDPIPE
+static void renderBandpass(FAS_KERNEL_ARGS) {
+    unsigned int j, b;
+
+    for (j = s; j < e; j += 1) {
+        struct note *n = &curr_notes[j];
+
+        struct oscillator *osc = &curr_synth.oscillators[n->osc_index];
+
+        double bint = 0;
+        FAS_FLOAT bflt = modf(fabs(n->blue), &bint);
+
+        FAS_FLOAT *in_l, *in_r;
+        unsigned int in_step = getRoutingInput(k, bint, bflt, &in_l, &in_r);
+
+        for (b = 0; b < len; b += 1) {
+            FAS_FLOAT vl = n->previous_volume_l + n->diff_volume_l * lerp_t[b];
+            FAS_FLOAT vr = n->previous_volume_r + n->diff_volume_r * lerp_t[b];
+
+            FAS_FLOAT il = in_l[b * in_step] * vl;
+            FAS_FLOAT ir = in_r[b * in_step] * vr;
+
+            FAS_FLOAT sl = 0.0f;
+            FAS_FLOAT sr = 0.0f;
 
-            instrument->last_sample_l = output_l;
-            instrument->last_sample_r = output_r;
+            sp_butbp_compute(&fas_instruments_sp[k], (sp_butbp *)osc->sp_filters[k][SP_BANDPASS_FILTER_L], &il, &sl);
+            sp_butbp_compute(&fas_instruments_sp[k], (sp_butbp *)osc->sp_filters[k][SP_BANDPASS_FILTER_R], &ir, &sr);
+
+            out_l[b] += sl * vl;
+            out_r[b] += sr * vr;
         }
+    }
+}
+#endif
 
-        for (k = 0; k < fas_max_channels; k += 1) {
-            struct _synth_chn_settings *chn_settings = &curr_synth.chn_settings[k];
+#ifdef WITH_SOUNDPIPE
+static void renderFormant(FAS_KERNEL_ARGS) {
+    unsigned int j, b;
 
-            if (chn_settings->output_chn < 0) {
-                continue;
-            }
+    for (j = s; j < e; j += 1) {
+        struct note *n = &curr_notes[j];
 
-            // channel effects
-            d = 0; j = 0;
-            int fx_id = -1;
-            do {
-                struct _synth_fx *fx = NULL;
+        struct oscillator *osc = &curr_synth.oscillators[n->osc_index];
 
-                if (synth_fx) {
-                    int bypass = chn_settings->fx[d].bypass;
-                    if (bypass) {
-                        fx_id = -2;
-                    } else {
-                        fx_id = chn_settings->fx[d].fx_id;
+        double bint = 0;
+        modf(fabs(n->blue), &bint);
 
-                        fx = synth_fx[k];
-                    }
-                }
+        int chn = (int)bint % fas_max_channels;
+        struct _synth_chn_settings *input_chn_settings = &curr_synth.chn_settings[chn];
+
+        for (b = 0; b < len; b += 1) {
+            FAS_FLOAT vl = n->previous_volume_l + n->diff_volume_l * lerp_t[b];
+            FAS_FLOAT vr = n->previous_volume_r + n->diff_volume_r * lerp_t[b];
+
+            FAS_FLOAT il = input_chn_settings->last_sample_l * vl;
+            FAS_FLOAT ir = input_chn_settings->last_sample_r * vr;
+
+            FAS_FLOAT sl = 0.0f;
+            FAS_FLOAT sr = 0.0f;
+
+            sp_fofilt_compute(&fas_instruments_sp[k], (sp_fofilt *)osc->sp_filters[k][SP_FORMANT_FILTER_L], &il, &sl);
+            sp_fofilt_compute(&fas_instruments_sp[k], (sp_fofilt *)osc->sp_filters[k][SP_FORMANT_FILTER_R], &ir, &sr);
+
+            out_l[b] += sl * vl;
+            out_r[b] += sr * vr;
+        }
+    }
+}
+#endif
 
-                if (fx_id == FX_CONV) {
 #ifdef WITH_SOUNDPIPE
-                    FAS_FLOAT insl = chn_settings->output_l;
-                    FAS_FLOAT insr = chn_settings->output_r;
+static void renderStringReson(FAS_KERNEL_ARGS) {
+    unsigned int j, b;
+
+    for (j = s; j < e; j += 1) {
+        struct note *n = &curr_notes[j];
+
+        struct oscillator *osc = &curr_synth.oscillators[n->osc_index];
+
+        double bint = 0;
+        FAS_FLOAT bflt = modf(fabs(n->blue), &bint);
+
+        FAS_FLOAT *in_l, *in_r;
+        unsigned int in_step = getRoutingInput(k, bint, bflt, &in_l, &in_r);
+
+        for (b = 0; b < len; b += 1) {
+            FAS_FLOAT vl = n->previous_volume_l + n->diff_volume_l * lerp_t[b];
+            FAS_FLOAT vr = n->previous_volume_r + n->diff_volume_r * lerp_t[b];
+
+            FAS_FLOAT il = in_l[b * in_step] * vl;
+            FAS_FLOAT ir = in_r[b * in_step] * vr;
+
+            FAS_FLOAT sl = 0.0f;
+            FAS_FLOAT sr = 0.0f;
 
-                    FAS_FLOAT outsl = 0;
-                    FAS_FLOAT outsr = 0;
-                    
-                    sp_conv_compute(sp, (sp_conv *)fx->conv[j], &insl, &outsl);
-                    sp_conv_compute(sp, (sp_conv *)fx->conv[j + 1], &insr, &outsr);
+            sp_streson_compute(&fas_instruments_sp[k], (sp_streson *)osc->sp_filters[k][SP_STRES_FILTER_L], &il, &sl);
+            sp_streson_compute(&fas_instruments_sp[k], (sp_streson *)osc->sp_filters[k][SP_STRES_FILTER_R], &ir, &sr);
 
-                    chn_settings->output_l = chn_settings->output_l * fx->dry[j] + outsl * fx->wet[j];
-                    chn_settings->output_r = chn_settings->output_r * fx->dry[j + 1] + outsr * fx->wet[j + 1];
+            out_l[b] += sl * vl;
+            out_r[b] += sr * vr;
+        }
+    }
+}
 #endif
-                } else if (fx_id == FX_ZITAREV) {
+
 #ifdef WITH_SOUNDPIPE
-                    sp_zitarev_compute(sp, (sp_zitarev *)fx->zitarev[d], &chn_settings->output_l, &chn_settings->output_r, &chn_settings->output_l, &chn_settings->output_r);
+static void renderModal(FAS_KERNEL_ARGS) {
+    unsigned int j, b;
+
+    for (j = s; j < e; j += 1) {
+        struct note *n = &curr_notes[j];
+
+        struct oscillator *osc = &curr_synth.oscillators[n->osc_index];
+
+        double bint = 0;
+        FAS_FLOAT bflt = modf(fabs(n->blue), &bint);
+
+        FAS_FLOAT *in_l, *in_r;
+        unsigned int in_step = getRoutingInput(k, bint, bflt, &in_l, &in_r);
+
+        for (b = 0; b < len; b += 1) {
+            FAS_FLOAT vl = n->previous_volume_l + n->diff_volume_l * lerp_t[b];
+            FAS_FLOAT vr = n->previous_volume_r + n->diff_volume_r * lerp_t[b];
+
+            FAS_FLOAT il = in_l[b * in_step] * vl;
+            FAS_FLOAT ir = in_r[b * in_step] * vr;
+
+            FAS_FLOAT sl = 0.0f;
+            FAS_FLOAT sr = 0.0f;
+
+            sp_mode_compute(&fas_instruments_sp[k], (sp_mode *)osc->sp_filters[k][SP_MODE_FILTER_L], &il, &sl);
+            sp_mode_compute(&fas_instruments_sp[k], (sp_mode *)osc->sp_filters[k][SP_MODE_FILTER_R], &ir, &sr);
+
+            out_l[b] += sl * vl;
+            out_r[b] += sr * vr;
+        }
+    }
+}
 #endif
-                } else if (fx_id == FX_SCREV) {
+
 #ifdef WITH_SOUNDPIPE
-                    sp_revsc_compute(sp, (sp_revsc *)fx->revsc[d], &chn_settings->output_l, &chn_settings->output_r, &chn_settings->output_l, &chn_settings->output_r);
+static void renderPhaseDistorsion(FAS_KERNEL_ARGS) {
+    unsigned int j, b;
+
+    for (j = s; j < e; j += 1) {
+        struct note *n = &curr_notes[j];
+
+        struct oscillator *osc = &curr_synth.oscillators[n->osc_index];
+
+        double bint = 0;
+        FAS_FLOAT bflt = modf(fabs(n->blue), &bint);
+
+        FAS_FLOAT *in_l, *in_r;
+        unsigned int in_step = getRoutingInput(k, bint, bflt, &in_l, &in_r);
+
+        for (b = 0; b < len; b += 1) {
+            FAS_FLOAT vl = n->previous_volume_l + n->diff_volume_l * lerp_t[b];
+            FAS_FLOAT vr = n->previous_volume_r + n->diff_volume_r * lerp_t[b];
+
+            FAS_FLOAT il = in_l[b * in_step] * vl;
+            FAS_FLOAT ir = in_r[b * in_step] * vr;
+
+            FAS_FLOAT sl = 0.0f;
+            FAS_FLOAT sr = 0.0f;
+
+            sp_pdhalf_compute(&fas_instruments_sp[k], (sp_pdhalf *)osc->sp_gens[k][SP_PD_GENERATOR], &il, &sl);
+            sp_pdhalf_compute(&fas_instruments_sp[k], (sp_pdhalf *)osc->sp_gens[k][SP_PD_GENERATOR], &ir, &sr);
+
+            out_l[b] += sl * vl;
+            out_r[b] += sr * vr;
+        }
+    }
+}
 #endif
-                } else if (fx_id == FX_AUTOWAH) {
+
+#ifdef WITH_FAUST
+static void renderFaust(FAS_KERNEL_ARGS) {
+    unsigned int j, b;
+
+    struct _synth_instrument *instrument = &curr_synth.instruments[k];
+
+    if (fas_faust_voices == NULL || fas_faust_voices->assigned == NULL) {
+        return;
+    }
+
+    for (j = s; j < e; j += 1) {
+        struct note *n = &curr_notes[j];
+
+        // voice assigned by notes preprocessing, none when the pool was exhausted
+        struct _fas_faust_dsp *fas_faust_dsp = getFaustVoice(fas_faust_voices, k, n->osc_index);
+        if (fas_faust_dsp == NULL) {
+            continue;
+        }
+
+        // update Faust DSP params
+        // note : p0 is used as the Faust generator index
+        setFaustZone(fas_faust_dsp, FAS_FAUST_ZONE_P0, instrument->p1);
+        setFaustZone(fas_faust_dsp, FAS_FAUST_ZONE_P0 + 1, instrument->p2);
+        setFaustZone(fas_faust_dsp, FAS_FAUST_ZONE_P0 + 2, instrument->p3);
+        setFaustZone(fas_faust_dsp, FAS_FAUST_ZONE_P0 + 3, instrument->p4);
+
+        // block processing; input is the routed instrument / channel output scaled by the note volume
+        FAUSTFLOAT faust_in_l[FAS_BLOCK_SIZE], faust_in_r[FAS_BLOCK_SIZE];
+        FAUSTFLOAT faust_out_l[FAS_BLOCK_SIZE], faust_out_r[FAS_BLOCK_SIZE];
+
+        FAUSTFLOAT *faust_input[2] = { faust_in_l, faust_in_r };
+        FAUSTFLOAT *faust_output[2] = { faust_out_l, faust_out_r };
+
+        int faust_dsp_input_count = getNumInputsCDSPInstance(fas_faust_dsp->dsp);
+        if (faust_dsp_input_count >= 1) {
+            double bint = 0;
+            FAS_FLOAT bflt = modf(fabs(n->blue), &bint);
+
+            FAS_FLOAT *in_l, *in_r;
+            unsigned int in_step = getRoutingInput(k, bint, bflt, &in_l, &in_r);
+
+            for (b = 0; b < len; b += 1) {
+                FAS_FLOAT vl = n->previous_volume_l + n->diff_volume_l * lerp_t[b];
+                FAS_FLOAT vr = n->previous_volume_r + n->diff_volume_r * lerp_t[b];
+
+                faust_in_l[b] = in_l[b * in_step] * vl;
+                faust_in_r[b] = in_r[b * in_step] * vr;
+            }
+
+            computeCDSPInstance(fas_faust_dsp->dsp, len, faust_input, faust_output);
+        } else {
+            computeCDSPInstance(fas_faust_dsp->dsp, len, NULL, faust_output);
+        }
+
+        // mono DSP output is duplicated, a DSP without outputs is silent
+        int faust_dsp_output_count = getNumOutputsCDSPInstance(fas_faust_dsp->dsp);
+        if (faust_dsp_output_count < 1) {
+            continue;
+        } else if (faust_dsp_output_count == 1) {
+            memcpy(faust_out_r, faust_out_l, sizeof(FAUSTFLOAT) * len);
+        }
+
+        for (b = 0; b < len; b += 1) {
+            FAS_FLOAT vl = n->previous_volume_l + n->diff_volume_l * lerp_t[b];
+            FAS_FLOAT vr = n->previous_volume_r + n->diff_volume_r * lerp_t[b];
+
+            out_l[b] += faust_out_l[b] * vl;
+            out_r[b] += faust_out_r[b] * vr;
+        }
+    }
+}
+#endif
+
+// indexed by synthesis method, NULL when there is nothing to render (or the method is not available)
+static const fas_render_kernel fas_render_kernels[FAS_VOID + 1] = {
+    [FAS_ADDITIVE] = renderAdditive,
+    [FAS_SPECTRAL] = renderSpectral,
+    [FAS_GRANULAR] = renderGranular,
+    [FAS_FM] = renderFM,
+    [FAS_PHYSICAL_MODELLING] = renderPhysicalModelling,
+    [FAS_WAVETABLE_SYNTH] = renderWavetable,
+    [FAS_MODULATION] = renderModulation,
+    [FAS_INPUT] = renderInput,
 #ifdef WITH_SOUNDPIPE
-                    sp_autowah_compute(sp, (sp_autowah *)fx->autowah[j], &chn_settings->output_l, &chn_settings->output_l);
-                    sp_autowah_compute(sp, (sp_autowah *)fx->autowah[j + 1], &chn_settings->output_r, &chn_settings->output_r);
+    [FAS_BANDPASS] = renderBandpass,
+    [FAS_FORMANT_SYNTH] = renderFormant,
+    [FAS_STRING_RESON] = renderStringReson,
+    [FAS_MODAL_SYNTH] = renderModal,
+    [FAS_PHASE_DISTORSION] = renderPhaseDistorsion,
 #endif
-                } else if (fx_id == FX_PHASER) {
+#ifdef WITH_FAUST
+    [FAS_FAUST] = renderFaust,
+#endif
+    [FAS_VOID] = NULL
+};
+
+/**
+ * Select instrument kernel from its synthesis method and parameters
+ **/
+static fas_render_kernel selectRenderKernel(struct _synth_instrument *instrument) {
+    if (instrument->type < 0 || instrument->type > FAS_VOID) {
+        return NULL;
+    }
+
+    if (instrument->type == FAS_SUBTRACTIVE) {
 #ifdef WITH_SOUNDPIPE
-                    sp_phaser_compute(sp, (sp_phaser *)fx->phaser[d], &chn_settings->output_l, &chn_settings->output_r, &chn_settings->output_l, &chn_settings->output_r);
+        int filter_type = instrument->p0;
+
+        if (filter_type >= 0 && filter_type < 4) {
+            return fas_subtractive_kernels[filter_type];
+        }
+
+        return renderSubtractiveNone;
+#else
+        return renderSubtractiveHuovilainen;
+#endif
+    }
+
+    return fas_render_kernels[instrument->type];
+}
+
+/**
+ * Apply channel k effects chain on len samples of the channel block (starting at b)
+ **/
+static void renderChannelEffects(unsigned int k, unsigned int b, unsigned int len) {
+    struct _synth_chn_settings *chn_settings = &curr_synth.chn_settings[k];
+
+    if (synth_fx == NULL) {
+        return;
+    }
+
+    processEffectsChain(
+#ifdef WITH_SOUNDPIPE
+        &fas_channels_sp[k],
+#endif
+        synth_fx[k], chn_settings, &chn_settings->output_l[b], &chn_settings->output_r[b], len);
+}
+
+// instruments block rendering job data
+struct _render_job {
+#ifdef INTERLEAVED_SAMPLE_FORMAT
+    float *audio_in;
+#else
+    float **inputBuffer;
+#endif
+    unsigned long i;
+    unsigned int b;
+    unsigned int len;
+
+    struct _render_task *tasks;
+};
+
+/**
+ * Render the current block of an instrument notes range; called from any threads of the workers pool
+ **/
+static void renderInstrumentJob(unsigned int index, void *data) {
+    struct _render_job *job = (struct _render_job *)data;
+    struct _render_task *task = &job->tasks[index];
+
+    unsigned int w;
+
+    for (w = 0; w < job->len; w += 1) {
+        task->out_l[w] = 0;
+        task->out_r[w] = 0;
+    }
+
+    fas_render_kernel kernel = curr_synth.instruments[task->instrument].kernel;
+    if (kernel == NULL) {
+        return;
+    }
+
+#ifdef INTERLEAVED_SAMPLE_FORMAT
+    kernel(task->instrument, task->s, task->e, job->audio_in, job->i + job->b, &fas_block_lerp_t[job->b], job->len, task->out_l, task->out_r);
+#else
+    kernel(task->instrument, task->s, task->e, job->inputBuffer, job->i + job->b, &fas_block_lerp_t[job->b], job->len, task->out_l, task->out_r);
+#endif
+}
+
+/**
+ * Render len samples of all instruments into their output channel block (starting at b)
+ * instruments are rendered level by level of the dependency graph, instruments of a level are rendered in parallel when a workers pool is given
+ * additive instruments with more than fas_partition_threshold notes are also split into notes ranges rendered in parallel
+ * ranges and instruments are always summed in order so the result does not depend on scheduling
+ **/
+#ifdef INTERLEAVED_SAMPLE_FORMAT
+static void renderInstruments(float *audio_in, unsigned long i, unsigned int b, unsigned int len, struct _instruments_graph *graph, struct _fas_workers *workers) {
+#else
+static void renderInstruments(float **inputBuffer, unsigned long i, unsigned int b, unsigned int len, struct _instruments_graph *graph, struct _fas_workers *workers) {
+#endif
+    unsigned int k, w, l, t, r;
+
+    unsigned int max_ranges = workers ? workers->count + 1 : 1;
+
+    struct _render_job job;
+#ifdef INTERLEAVED_SAMPLE_FORMAT
+    job.audio_in = audio_in;
+#else
+    job.inputBuffer = inputBuffer;
+#endif
+    job.i = i;
+    job.b = b;
+    job.len = len;
+    job.tasks = fas_render_tasks;
+
+    for (l = 0; l < graph->levels_count; l += 1) {
+        unsigned int tasks_count = 0;
+
+        for (t = graph->levels[l]; t < graph->levels[l + 1]; t += 1) {
+            k = graph->order[t];
+
+            struct _synth_instrument *instrument = &curr_synth.instruments[k];
+
+            // selected here so that parameters changed by previous levels (modulation) are taken into account
+            instrument->kernel = selectRenderKernel(instrument);
+
+            unsigned int notes_count = instrument->notes_end - instrument->notes_start;
+            unsigned int ranges = 1;
+
+            if (max_ranges > 1 && fas_partition_threshold > 0 && instrument->type == FAS_ADDITIVE && notes_count > fas_partition_threshold) {
+                ranges = (notes_count + fas_partition_threshold - 1) / fas_partition_threshold;
+                if (ranges > max_ranges) {
+                    ranges = max_ranges;
+                }
+            }
+
+            // ranges length is a multiple of the packed partials alignment (see sliceAdditiveBank)
+            unsigned int range_len = (notes_count + ranges - 1) / ranges;
+            range_len = ((range_len + FAS_ADDITIVE_LANES - 1) / FAS_ADDITIVE_LANES) * FAS_ADDITIVE_LANES;
+
+            for (r = 0; r < ranges; r += 1) {
+                unsigned int s = instrument->notes_start + r * range_len;
+
+                if (r > 0 && s >= instrument->notes_end) {
+                    break;
+                }
+
+                struct _render_task *task = &fas_render_tasks[tasks_count++];
+
+                task->instrument = k;
+                task->s = s;
+                task->e = (s + range_len < instrument->notes_end) ? s + range_len : instrument->notes_end;
+
+                if (r == 0) {
+                    task->out_l = instrument->output_l;
+                    task->out_r = instrument->output_r;
+                } else {
+                    task->out_l = task->output_l;
+                    task->out_r = task->output_r;
+                }
+            }
+        }
+
+        runWorkers(workers, tasks_count, renderInstrumentJob, (void *)&job);
+
+        // sum ranges of split instruments
+        for (t = 0; t < tasks_count; t += 1) {
+            struct _render_task *task = &fas_render_tasks[t];
+            struct _synth_instrument *instrument = &curr_synth.instruments[task->instrument];
+
+            if (task->out_l != instrument->output_l) {
+                for (w = 0; w < len; w += 1) {
+                    instrument->output_l[w] += task->output_l[w];
+                    instrument->output_r[w] += task->output_r[w];
+                }
+            }
+
+            instrument->last_sample_l = instrument->output_l[len - 1];
+            instrument->last_sample_r = instrument->output_r[len - 1];
+        }
+    }
+
+    // mix
+    for (k = 0; k < graph->count; k += 1) {
+        struct _synth_instrument *instrument = &curr_synth.instruments[k];
+
+        if (instrument->muted) {
+            continue;
+        }
+
+        struct _synth_chn_settings *chn_settings = &curr_synth.chn_settings[instrument->output_channel];
+
+        for (w = 0; w < len; w += 1) {
+            chn_settings->output_l[b + w] += instrument->output_l[w];
+            chn_settings->output_r[b + w] += instrument->output_r[w];
+        }
+    }
+}
+
+// channels effects job data
+struct _channels_job {
+    unsigned int b;
+    unsigned int len;
+};
+
+/**
+ * Apply the effects chain of a channel on the current block; called from any threads of the workers pool
+ **/
+static void renderChannelEffectsJob(unsigned int index, void *data) {
+    struct _channels_job *job = (struct _channels_job *)data;
+    struct _synth_chn_settings *chn_settings = &curr_synth.chn_settings[index];
+
+    if (chn_settings->output_chn < 0) {
+        return;
+    }
+
+    renderChannelEffects(index, job->b, job->len);
+
+    chn_settings->last_sample_l = chn_settings->output_l[job->b + job->len - 1];
+    chn_settings->last_sample_r = chn_settings->output_r[job->b + job->len - 1];
+}
+
+/**
+ * Apply channels effects on len samples of the channels block (starting at b) and write them to the output buffer
+ * channels effects chains are processed in parallel when a workers pool is given, channels are then mixed in order
+ **/
+#ifdef INTERLEAVED_SAMPLE_FORMAT
+static void renderChannels(float *audio_out, unsigned long i, unsigned int b, unsigned int len, struct _fas_workers *workers) {
+#else
+static void renderChannels(float **outputBuffer, unsigned long i, unsigned int b, unsigned int len, struct _fas_workers *workers) {
+#endif
+    unsigned int k, w;
+
+    struct _channels_job job;
+    job.b = b;
+    job.len = len;
+
+    // a run is only worth it with more than one effects chain to process
+    unsigned int chains_count = 0;
+    if (workers && synth_fx) {
+        for (k = 0; k < fas_max_channels; k += 1) {
+            if (curr_synth.chn_settings[k].output_chn >= 0 && synth_fx[k]->chain.count > 0) {
+                chains_count += 1;
+            }
+        }
+    }
+
+    runWorkers((chains_count > 1) ? workers : NULL, fas_max_channels, renderChannelEffectsJob, (void *)&job);
+
+    for (k = 0; k < fas_max_channels; k += 1) {
+        struct _synth_chn_settings *chn_settings = &curr_synth.chn_settings[k];
+
+        FAS_FLOAT *out_l = &chn_settings->output_l[b];
+        FAS_FLOAT *out_r = &chn_settings->output_r[b];
+
+        if (chn_settings->output_chn >= 0) {
+            FAS_FLOAT gain_lr = curr_synth.settings->gain_lr;
+            FAS_FLOAT chn_gain_diff = chn_settings->curr_chn_gain - chn_settings->last_chn_gain;
+
+#ifdef INTERLEAVED_SAMPLE_FORMAT
+            unsigned long frame_index = (i + b) * 2 * frame_data_count + chn_settings->output_chn * 2;
+
+            for (w = 0; w < len; w += 1) {
+                FAS_FLOAT chn_gain = chn_settings->last_chn_gain + chn_gain_diff * fas_block_lerp_t[b + w];
+
+                audio_out[frame_index] += out_l[w] * chn_gain * gain_lr;
+                audio_out[frame_index + 1] += out_r[w] * chn_gain * gain_lr;
+
+                frame_index += 2 * frame_data_count;
+            }
+#else
+            int output_chn = chn_settings->output_chn * 2;
+
+            float *chn_out_l = &outputBuffer[output_chn][i + b];
+            float *chn_out_r = &outputBuffer[output_chn + 1][i + b];
+
+            for (w = 0; w < len; w += 1) {
+                FAS_FLOAT chn_gain = chn_settings->last_chn_gain + chn_gain_diff * fas_block_lerp_t[b + w];
+
+                chn_out_l[w] += out_l[w] * chn_gain * gain_lr;
+                chn_out_r[w] += out_r[w] * chn_gain * gain_lr;
+            }
+#endif
+        }
+
+        for (w = 0; w < len; w += 1) {
+            out_l[w] = 0;
+            out_r[w] = 0;
+        }
+    }
+}
+
+#ifdef WITH_FAUST
+/**
+ * free reloaded (or replaced) Faust instances then their factories
+ **/
+static void freeFaustReload(struct _fas_faust_reload *reload) {
+    freeFaustGenerators(&reload->voices);
+
+    if (reload->effects) {
+        for (unsigned int i = 0; i < fas_max_channels; i += 1) {
+            freeFaustChannelEffects(&reload->effects[i]);
+        }
+
+        free(reload->effects);
+        reload->effects = NULL;
+    }
+
+    freeFaustFactories(reload->factories);
+    reload->factories = NULL;
+}
+
+/**
+ * Faust reload thread; compile & instantiate while audio keep playing, wait for the audio thread to swap then free the previous instances
+ **/
+static void *faustReloadThread(void *args) {
+    struct _fas_faust_reload *reload = &fas_faust_reload;
+
+    if (reload->action == FAS_ACTION_FAUST_GENS) {
+        reload->factories = createFaustFactories(fas_faust_gens_path, fas_faust_options, fas_faust_target, fas_faust_cache_path);
+        reload->voices = createFaustGenerators(reload->factories, fas_faust_polyphony, fas_sample_rate);
+
+        if (reload->rows > 0) {
+            setFaustGeneratorsBank(reload->voices, reload->rows, fas_max_instruments);
+        }
+    } else {
+        reload->factories = createFaustFactories(fas_faust_effs_path, fas_faust_options, fas_faust_target, fas_faust_cache_path);
+        reload->effects = (struct _fas_faust_effects **)calloc(fas_max_channels, sizeof(struct _fas_faust_effects *));
+
+        if (reload->effects == NULL) {
+            printf("faustReloadThread alloc. error.");
+            fflush(stdout);
+
+            freeFaustReload(reload);
+
+            atomic_store_explicit(&fas_faust_reload_state, FAS_FAUST_RELOAD_IDLE, memory_order_release);
+
+            return NULL;
+        }
+
+        for (unsigned int i = 0; i < fas_max_channels; i += 1) {
+            reload->effects[i] = createFaustChannelEffects(reload->factories, fas_sample_rate);
+        }
+    }
+
+    atomic_store_explicit(&fas_faust_reload_state, FAS_FAUST_RELOAD_READY, memory_order_release);
+
+    struct timespec ts = { 0, 1000000 };
+
+    while (atomic_load_explicit(&fas_faust_reload_state, memory_order_acquire) != FAS_FAUST_RELOAD_SWAPPED) {
+        // leave remaining instances to the main thread
+        if (atomic_load_explicit(&fas_faust_reload_quit, memory_order_relaxed)) {
+            return NULL;
+        }
+
+        nanosleep(&ts, NULL);
+    }
+
+    // the audio thread does not reference previous instances anymore
+    freeFaustReload(reload);
+
+    atomic_store_explicit(&fas_faust_reload_state, FAS_FAUST_RELOAD_IDLE, memory_order_release);
+
+    return NULL;
+}
+
+/**
+ * start a background Faust generators / effects reload; ignored when a reload is already in progress
+ **/
+static void startFaustReload(int action) {
+    if (atomic_load_explicit(&fas_faust_reload_state, memory_order_acquire) != FAS_FAUST_RELOAD_IDLE) {
+        printf("Faust reload already in progress, action ignored.\n");
+        fflush(stdout);
+
+        return;
+    }
+
+    if (fas_faust_reload_joinable) {
+        pthread_join(fas_faust_reload_thread, NULL);
+
+        fas_faust_reload_joinable = 0;
+    }
+
+    fas_faust_reload.action = action;
+    fas_faust_reload.rows = curr_synth.oscillators ? curr_synth.bank_settings->h : 0;
+
+    atomic_store_explicit(&fas_faust_reload_state, FAS_FAUST_RELOAD_BUILDING, memory_order_release);
+
+    int err = pthread_create(&fas_faust_reload_thread, NULL, &faustReloadThread, NULL);
+    if (err != 0) {
+        fprintf(stderr, "startFaustReload : pthread_create error %i\n", err);
+
+        atomic_store(&fas_faust_reload_state, FAS_FAUST_RELOAD_IDLE);
+
+        return;
+    }
+
+    fas_faust_reload_joinable = 1;
+}
+
+/**
+ * audio thread; swap reloaded Faust instances at a frame boundary (allocation free)
+ **/
+static void swapFaustReload() {
+    if (atomic_load_explicit(&fas_faust_reload_state, memory_order_acquire) != FAS_FAUST_RELOAD_READY) {
+        return;
+    }
+
+    struct _fas_faust_reload *reload = &fas_faust_reload;
+
+    struct _faust_factories *factories;
+
+    if (reload->action == FAS_ACTION_FAUST_GENS) {
+        struct _fas_faust_voices *voices = fas_faust_voices;
+
+        fas_faust_voices = reload->voices;
+        reload->voices = voices;
+
+        factories = fas_faust_gens;
+        fas_faust_gens = reload->factories;
+    } else {
+        swapFaustEffects(synth_fx, reload->effects, fas_max_channels);
+
+        factories = fas_faust_effs;
+        fas_faust_effs = reload->factories;
+
+        // restore current Faust effects parameters (fs_p0 ... fs_p9)
+        for (unsigned int i = 0; i < fas_max_channels; i += 1) {
+            struct _synth_chn_settings *chn_settings = &curr_synth.chn_settings[i];
+
+            for (unsigned int slot = 0; slot < FAS_MAX_FX_SLOTS; slot += 1) {
+                struct _synth_fx_settings *fx_settings = &chn_settings->fx[slot];
+
+                if (fx_settings->fx_id == -1) {
+                    break;
+                }
+
+                if (fx_settings->fx_id != FX_FAUST) {
+                    continue;
+                }
+
+                for (unsigned int target = 3; target <= 12; target += 1) {
+                    updateEffectParameter(
+#ifdef WITH_SOUNDPIPE
+                        sp,
+#endif
+                        synth_fx[i], chn_settings, slot, target, fx_settings->fp[target - 2]);
+                }
+            }
+        }
+    }
+
+    reload->factories = factories;
+
+    atomic_store_explicit(&fas_faust_reload_state, FAS_FAUST_RELOAD_SWAPPED, memory_order_release);
+}
+#endif
+
+#ifdef INTERLEAVED_SAMPLE_FORMAT
+static int audioCallback(float *inputBuffer, float *outputBuffer, unsigned long nframes) {
+#else
+static int audioCallback(float **inputBuffer, float **outputBuffer, unsigned long nframes) {
 #endif
-                } else if (fx_id == FX_DELAY) {
-#ifdef WITH_SOUNDPIPE
-                    FAS_FLOAT insl = chn_settings->output_l;
-                    FAS_FLOAT insr = chn_settings->output_r;
-
-                    FAS_FLOAT outsl = 0;
-                    FAS_FLOAT outsr = 0;
-                    
-                    sp_delay_compute(sp, (sp_delay *)fx->delay[j], &insl, &outsl);
-                    sp_delay_compute(sp, (sp_delay *)fx->delay[j + 1], &insr, &outsr);
+    LFDS720_MISC_MAKE_VALID_ON_CURRENT_LOGICAL_CORE_INITS_COMPLETED_BEFORE_NOW_ON_ANY_OTHER_PHYSICAL_CORE;
 
-                    chn_settings->output_l = chn_settings->output_l * fx->dry[j] + outsl * fx->wet[j];
-                    chn_settings->output_r = chn_settings->output_r * fx->dry[j + 1] + outsr * fx->wet[j + 1];
-#endif
-                } else if (fx_id == FX_SMOOTH_DELAY) {
-#ifdef WITH_SOUNDPIPE
-                    FAS_FLOAT insl = chn_settings->output_l;
-                    FAS_FLOAT insr = chn_settings->output_r;
-                    sp_smoothdelay_compute(sp, (sp_smoothdelay *)fx->sdelay[j], &insl, &chn_settings->output_l);
-                    sp_smoothdelay_compute(sp, (sp_smoothdelay *)fx->sdelay[j + 1], &insr, &chn_settings->output_r);
+#ifdef INTERLEAVED_SAMPLE_FORMAT
+    float *audio_out = outputBuffer;
+    float *audio_in = inputBuffer;
 #endif
-                } else if (fx_id == FX_COMB) {
-#ifdef WITH_SOUNDPIPE
-                    FAS_FLOAT insl = chn_settings->output_l;
-                    FAS_FLOAT insr = chn_settings->output_r;
-
-                    FAS_FLOAT outsl = 0;
-                    FAS_FLOAT outsr = 0;
+    unsigned int i, j, k, d, s, e, b;
 
-                    sp_comb_compute(sp, (sp_comb *)fx->comb[j], &insl, &outsl);
-                    sp_comb_compute(sp, (sp_comb *)fx->comb[j + 1], &insr, &outsr);
+    struct _freelist_frames_data *freelist_frames_data;
 
-                    chn_settings->output_l = chn_settings->output_l * fx->dry[j] + outsl * fx->wet[j];
-                    chn_settings->output_r = chn_settings->output_r * fx->dry[j + 1] + outsr * fx->wet[j + 1];
-#endif
-                } else if (fx_id == FX_BITCRUSH) {
-#ifdef WITH_SOUNDPIPE
-                    FAS_FLOAT insl = chn_settings->output_l;
-                    FAS_FLOAT insr = chn_settings->output_r;
+    doSynthCommands();
 
-                    FAS_FLOAT outsl = 0;
-                    FAS_FLOAT outsr = 0;
+    int read_status = 0;
+    void *key;
 
-                    sp_bitcrush_compute(sp, (sp_bitcrush *)fx->bitcrush[j], &insl, &outsl);
-                    sp_bitcrush_compute(sp, (sp_bitcrush *)fx->bitcrush[j + 1], &insr, &outsr);
+    // audio callback commands
+    if (audio_thread_state == FAS_AUDIO_DO_PAUSE) {
+        last_gain_lr = curr_synth.settings->gain_lr;
 
-                    chn_settings->output_l = chn_settings->output_l * fx->dry[j] + outsl * fx->wet[j];
-                    chn_settings->output_r = chn_settings->output_r * fx->dry[j + 1] + outsr * fx->wet[j + 1];
-#endif
-                } else if (fx_id == FX_DISTORSION) {
-#ifdef WITH_SOUNDPIPE
-                    FAS_FLOAT insl = chn_settings->output_l;
-                    FAS_FLOAT insr = chn_settings->output_r;
+        audio_thread_state = FAS_AUDIO_PAUSE;
+    } else if (audio_thread_state == FAS_AUDIO_DO_PLAY) {
+        audio_thread_state = FAS_AUDIO_PLAY;
+    } else if (audio_thread_state == FAS_AUDIO_DO_FLUSH_THEN_PAUSE) {
+        // flush away callback data
+        if (curr_notes != dummy_notes) {
+            LFDS720_FREELIST_N_SET_VALUE_IN_ELEMENT(curr_freelist_frames_data->fe, curr_freelist_frames_data);
+            lfds720_freelist_n_threadsafe_push(&freelist_frames, NULL, &curr_freelist_frames_data->fe);
+        }
 
-                    FAS_FLOAT outsl = 0;
-                    FAS_FLOAT outsr = 0;
+        curr_notes = dummy_notes;
 
-                    sp_dist_compute(sp, (sp_dist *)fx->dist[j], &insl, &outsl);
-                    sp_dist_compute(sp, (sp_dist *)fx->dist[j + 1], &insr, &outsr);
+        last_gain_lr = curr_synth.settings->gain_lr;
 
-                    chn_settings->output_l = chn_settings->output_l * fx->dry[j] + outsl * fx->wet[j];
-                    chn_settings->output_r = chn_settings->output_r * fx->dry[j + 1] + outsr * fx->wet[j + 1];
-#endif
-                } else if (fx_id == FX_SATURATOR) {
-#ifdef WITH_SOUNDPIPE
-                    FAS_FLOAT insl = chn_settings->output_l;
-                    FAS_FLOAT insr = chn_settings->output_r;
+        audio_thread_state = FAS_AUDIO_PAUSE;
+    }
 
-                    FAS_FLOAT outsl = 0;
-                    FAS_FLOAT outsr = 0;
+    if (audio_thread_state == FAS_AUDIO_PAUSE) {
+        // paused audio
+        for (i = 0; i < nframes; i += 1) {
+#ifdef INTERLEAVED_SAMPLE_FORMAT
+            for (j = 0; j < fas_max_channels; j += 1) {
+                struct _synth_chn_settings *chn_settings = &curr_synth.chn_settings[j];
 
-                    sp_saturator_compute(sp, (sp_saturator *)fx->saturator[j], &insl, &outsl);
-                    sp_saturator_compute(sp, (sp_saturator *)fx->saturator[j + 1], &insr, &outsr);
+                if (chn_settings->output_chn >= 0) {
+                    audio_out[i * 2 * frame_data_count + chn_settings->output_chn * 2] += chn_settings->last_sample_l * (1.0f - curr_synth.lerp_t) * last_gain_lr;
+                    audio_out[i * 2 * frame_data_count + 1 + chn_settings->output_chn * 2] += chn_settings->last_sample_r * (1.0f - curr_synth.lerp_t) * last_gain_lr;
+                }
+            }
+#else
+            for (j = 0; j < fas_max_channels; j += 1) {
+                struct _synth_chn_settings *chn_settings = &curr_synth.chn_settings[j];
 
-                    chn_settings->output_l = chn_settings->output_l * fx->dry[j] + outsl * fx->wet[j];
-                    chn_settings->output_r = chn_settings->output_r * fx->dry[j + 1] + outsr * fx->wet[j + 1];
-#endif
-                } else if (fx_id == FX_COMPRESSOR) {
-#ifdef WITH_SOUNDPIPE
-                    sp_compressor_compute(sp, (sp_compressor *)fx->compressor[j], &chn_settings->output_l, &chn_settings->output_l);
-                    sp_compressor_compute(sp, (sp_compressor *)fx->compressor[j + 1], &chn_settings->output_r, &chn_settings->output_r);
+                if (chn_settings->output_chn >= 0) {
+                    int output_chn = chn_settings->output_chn * 2;
+                    outputBuffer[output_chn][i] += chn_settings->last_sample_l * (1.0f - curr_synth.lerp_t) * last_gain_lr;
+                    outputBuffer[output_chn + 1][i] += chn_settings->last_sample_r * (1.0f - curr_synth.lerp_t) * last_gain_lr;
+                }
+            }
 #endif
-                } else if (fx_id == FX_PEAK_LIMITER) {
-#ifdef WITH_SOUNDPIPE
-                    FAS_FLOAT insl = chn_settings->output_l;
-                    FAS_FLOAT insr = chn_settings->output_r;
-
-                    FAS_FLOAT outsl = 0;
-                    FAS_FLOAT outsr = 0;
+            curr_synth.lerp_t += (1.0f / (FAS_FLOAT)nframes);
+            curr_synth.lerp_t = fmin(curr_synth.lerp_t, 1.0f);
+        }
 
-                    sp_peaklim_compute(sp, (sp_peaklim *)fx->peaklimit[j], &insl, &outsl);
-                    sp_peaklim_compute(sp, (sp_peaklim *)fx->peaklimit[j + 1], &insr, &outsr);
+        curr_synth.lerp_t = 0.0;
+        curr_synth.curr_sample = 0;
 
-                    chn_settings->output_l = chn_settings->output_l * fx->dry[j] + outsl * fx->wet[j];
-                    chn_settings->output_r = chn_settings->output_r * fx->dry[j + 1] + outsr * fx->wet[j + 1];
-#endif
-                } else if (fx_id == FX_CLIP) {
-#ifdef WITH_SOUNDPIPE
-                    FAS_FLOAT insl = chn_settings->output_l;
-                    FAS_FLOAT insr = chn_settings->output_r;
+        lerp_t_step = 1 / note_time_samples;
 
-                    FAS_FLOAT outsl = 0;
-                    FAS_FLOAT outsr = 0;
+        return 0;
+    }
 
-                    sp_clip_compute(sp, (sp_clip *)fx->clip[j], &insl, &outsl);
-                    sp_clip_compute(sp, (sp_clip *)fx->clip[j + 1], &insr, &outsr);
+    // synth core - critical part :)
+    struct note *_notes;
+    unsigned int note_buffer_len = 0, pv_note_buffer_len = 0;
 
-                    chn_settings->output_l = chn_settings->output_l * fx->dry[j] + outsl * fx->wet[j];
-                    chn_settings->output_r = chn_settings->output_r * fx->dry[j + 1] + outsr * fx->wet[j + 1];
-#endif
-                } else if (fx_id == FX_B_LOWPASS) {
-#ifdef WITH_SOUNDPIPE
-                    sp_butlp_compute(sp, (sp_butlp *)fx->butlp[j], &chn_settings->output_l, &chn_settings->output_l);
-                    sp_butlp_compute(sp, (sp_butlp *)fx->butlp[j + 1], &chn_settings->output_r, &chn_settings->output_r);
-#endif
-                } else if (fx_id == FX_B_HIGHPASS) {
-#ifdef WITH_SOUNDPIPE
-                    sp_buthp_compute(sp, (sp_buthp *)fx->buthp[j], &chn_settings->output_l, &chn_settings->output_l);
-                    sp_buthp_compute(sp, (sp_buthp *)fx->buthp[j + 1], &chn_settings->output_r, &chn_settings->output_r);
-#endif
-                } else if (fx_id == FX_B_BANDPASS) {
-#ifdef WITH_SOUNDPIPE
-                    sp_butbp_compute(sp, (sp_butbp *)fx->butbp[j], &chn_settings->output_l, &chn_settings->output_l);
-                    sp_butbp_compute(sp, (sp_butbp *)fx->butbp[j + 1], &chn_settings->output_r, &chn_settings->output_r);
-#endif
-                } else if (fx_id == FX_B_BANDREJECT) {
-#ifdef WITH_SOUNDPIPE
-                    sp_butbr_compute(sp, (sp_butbr *)fx->butbr[j], &chn_settings->output_l, &chn_settings->output_l);
-                    sp_butbr_compute(sp, (sp_butbr *)fx->butbr[j + 1], &chn_settings->output_r, &chn_settings->output_r);
-#endif
-                } else if (fx_id == FX_PAREQ) {
-#ifdef WITH_SOUNDPIPE
-                    sp_pareq_compute(sp, (sp_pareq *)fx->pareq[j], &chn_settings->output_l, &chn_settings->output_l);
-                    sp_pareq_compute(sp, (sp_pareq *)fx->pareq[j + 1], &chn_settings->output_r, &chn_settings->output_r);
-#endif
-                } else if (fx_id == FX_MOOG_LPF) {
-#ifdef WITH_SOUNDPIPE
-                    sp_moogladder_compute(sp, (sp_moogladder *)fx->mooglp[j], &chn_settings->output_l, &chn_settings->output_l);
-                    sp_moogladder_compute(sp, (sp_moogladder *)fx->mooglp[j + 1], &chn_settings->output_r, &chn_settings->output_r);
-#endif
-                } else if (fx_id == FX_DIODE_LPF) {
-#ifdef WITH_SOUNDPIPE
-                    sp_diode_compute(sp, (sp_diode *)fx->diodelp[j], &chn_settings->output_l, &chn_settings->output_l);
-                    sp_diode_compute(sp, (sp_diode *)fx->diodelp[j + 1], &chn_settings->output_r, &chn_settings->output_r);
-#endif
-                } else if (fx_id == FX_KORG_LPF) {
-#ifdef WITH_SOUNDPIPE
-                    sp_wpkorg35_compute(sp, (sp_wpkorg35 *)fx->korglp[j], &chn_settings->output_l, &chn_settings->output_l);
-                    sp_wpkorg35_compute(sp, (sp_wpkorg35 *)fx->korglp[j + 1], &chn_settings->output_r, &chn_settings->output_r);
-#endif
-                } else if (fx_id == FX_18_LPF) {
-#ifdef WITH_SOUNDPIPE
-                    sp_lpf18_compute(sp, (sp_lpf18 *)fx->lpf18[j], &chn_settings->output_l, &chn_settings->output_l);
-                    sp_lpf18_compute(sp, (sp_lpf18 *)fx->lpf18[j + 1], &chn_settings->output_r, &chn_settings->output_r);
-#endif
-                } else if (fx_id == FX_TBVCF) {
-#ifdef WITH_SOUNDPIPE
-                    FAS_FLOAT insl = chn_settings->output_l;
-                    FAS_FLOAT insr = chn_settings->output_r;
-                    sp_tbvcf_compute(sp, (sp_tbvcf *)fx->tbvcf[j], &insl, &chn_settings->output_l);
-                    sp_tbvcf_compute(sp, (sp_tbvcf *)fx->tbvcf[j + 1], &insr, &chn_settings->output_r);
-#endif
-                } else if (fx_id == FX_FOLD) {
-#ifdef WITH_SOUNDPIPE
-                    sp_fold_compute(sp, (sp_fold *)fx->fold[j], &chn_settings->output_l, &chn_settings->output_l);
-                    sp_fold_compute(sp, (sp_fold *)fx->fold[j + 1], &chn_settings->output_r, &chn_settings->output_r);
-#endif
-                } else if (fx_id == FX_DC_BLOCK) {
-#ifdef WITH_SOUNDPIPE
-                    sp_dcblock_compute(sp, (sp_dcblock *)fx->dcblock[j], &chn_settings->output_l, &chn_settings->output_l);
-                    sp_dcblock_compute(sp, (sp_dcblock *)fx->dcblock[j + 1], &chn_settings->output_r, &chn_settings->output_r);
-#endif
-                } else if (fx_id == FX_LPC) {
-#ifdef WITH_SOUNDPIPE
-                    sp_lpc_compute(sp, (sp_lpc *)fx->lpc[j], &chn_settings->output_l, &chn_settings->output_l);
-                    sp_lpc_compute(sp, (sp_lpc *)fx->lpc[j + 1], &chn_settings->output_r, &chn_settings->output_r);
-#endif
-                } else if (fx_id == FX_WAVESET) {
-#ifdef WITH_SOUNDPIPE
-                    sp_waveset_compute(sp, (sp_waveset *)fx->wset[j], &chn_settings->output_l, &chn_settings->output_l);
-                    sp_waveset_compute(sp, (sp_waveset *)fx->wset[j + 1], &chn_settings->output_r, &chn_settings->output_r);
-#endif
-                } else if (fx_id == FX_PANNER) {
-#ifdef WITH_SOUNDPIPE
-                    sp_panst_compute(sp, (sp_panst *)fx->panner[d], &chn_settings->output_l, &chn_settings->output_r, &chn_settings->output_l, &chn_settings->output_r);
-#endif
-                } else if (fx_id == FX_FAUST) {
-#ifdef WITH_FAUST
-                    FAS_FLOAT insl = chn_settings->output_l;
-                    FAS_FLOAT insr = chn_settings->output_r;
+    i = 0;
+    while (i < nframes) {
+        // the callback buffer is processed by blocks which never cross an event boundary
+        unsigned int block_len = FAS_BLOCK_SIZE;
 
-                    FAUSTFLOAT *faust_input[2] = { &insl, &insr };
-                    FAUSTFLOAT *faust_output[2] = { &chn_settings->output_l, &chn_settings->output_r };
+        if (nframes - i < block_len) {
+            block_len = nframes - i;
+        }
 
-                    struct _synth_fx_settings *chn_fx_settings = &chn_settings->fx[j];
+        int event_samples = (int)note_time_samples - curr_synth.curr_sample;
+        if (event_samples < 1) {
+            event_samples = 1;
+        }
 
-                    struct _fas_faust_dsp *fas_faust_dsp = fx->faust_effs[j][(unsigned int)chn_fx_settings->fp[0]];
+        if ((unsigned int)event_samples < block_len) {
+            block_len = event_samples;
+        }
 
-                    computeCDSPInstance(fas_faust_dsp->dsp, 1, faust_input, faust_output);
-#endif
-                }
-                
-                d += 1;
-                j += 2;
-            } while (fx_id != -1);
-            //
+        // notes interpolation factor of each samples of the block
+        for (b = 0; b < block_len; b += 1) {
+            fas_block_lerp_t[b] = curr_synth.lerp_t;
 
-            chn_settings->last_sample_l = chn_settings->output_l;
-            chn_settings->last_sample_r = chn_settings->output_r;
+            curr_synth.lerp_t += lerp_t_step * fas_smooth_factor;
+            curr_synth.lerp_t = fmin(curr_synth.lerp_t, 1.0f);
+        }
 
-            FAS_FLOAT chn_gain = chn_settings->last_chn_gain + (chn_settings->curr_chn_gain - chn_settings->last_chn_gain) * curr_synth.lerp_t;
+        // instruments rendering order; instruments reading their own / channels output (or cycles) require per-sample processing
+        scheduleInstruments(fas_instruments_graph);
 
+        if (fas_instruments_graph->per_sample) {
+            for (b = 0; b < block_len; b += 1) {
+                renderInstruments(
 #ifdef INTERLEAVED_SAMPLE_FORMAT
-            audio_out[i * 2 * frame_data_count + chn_settings->output_chn * 2] += chn_settings->output_l * chn_gain * curr_synth.settings->gain_lr;
-            audio_out[i * 2 * frame_data_count + 1 + chn_settings->output_chn * 2] += chn_settings->output_r * chn_gain * curr_synth.settings->gain_lr;
+                    audio_in,
 #else
-            int output_chn = chn_settings->output_chn * 2;
-            outputBuffer[output_chn][i] += chn_settings->output_l * chn_gain * curr_synth.settings->gain_lr;
-            outputBuffer[output_chn + 1][i] += chn_settings->output_r * chn_gain * curr_synth.settings->gain_lr;
+                    inputBuffer,
 #endif
-
-            chn_settings->output_l = 0;
-            chn_settings->output_r = 0;
+                    i, b, 1, fas_instruments_graph, NULL);
+                renderChannels(
+#ifdef INTERLEAVED_SAMPLE_FORMAT
+                    audio_out,
+#else
+                    outputBuffer,
+#endif
+                    i, b, 1, NULL);
+            }
+        } else {
+            renderInstruments(
+#ifdef INTERLEAVED_SAMPLE_FORMAT
+                audio_in,
+#else
+                inputBuffer,
+#endif
+                i, 0, block_len, fas_instruments_graph, fas_workers);
+            renderChannels(
+#ifdef INTERLEAVED_SAMPLE_FORMAT
+                audio_out,
+#else
+                outputBuffer,
+#endif
+                i, 0, block_len, fas_workers);
         }
 
-        curr_synth.lerp_t += lerp_t_step * fas_smooth_factor;
-        curr_synth.lerp_t = fmin(curr_synth.lerp_t, 1.0f);
+        i += block_len;
 
-        curr_synth.curr_sample += 1;
+        curr_synth.curr_sample += block_len;
 
         // compute the next event
         if (curr_synth.curr_sample >= note_time_samples) {
@@ -1556,6 +2213,11 @@ static int audioCallback(float **inputBuffer, float **outputBuffer, unsigned lon
                     }
                 }
 
+#ifdef WITH_FAUST
+                // reloaded Faust generators / effects
+                swapFaustReload();
+#endif
+
                 for (k = 0; k < fas_max_instruments; k += 1) {
                     // preprocess notes
                     pv_note_buffer_len += note_buffer_len;
@@ -1567,6 +2229,8 @@ static int audioCallback(float **inputBuffer, float **outputBuffer, unsigned lon
                     struct _synth_instrument *instrument = &curr_synth.instruments[k];
                     int synthesis_method = instrument->type;
 
+                    struct oscillators_state *state = &curr_synth.oscillators_state[k];
+
                     if (synthesis_method == FAS_ADDITIVE) {
                         for (j = s; j < e; j += 1) {
                             struct note *n = &curr_notes[j];
@@ -1574,8 +2238,15 @@ static int audioCallback(float **inputBuffer, float **outputBuffer, unsigned lon
                             struct oscillator *osc = &curr_synth.oscillators[n->osc_index];
 
                             double dummy_int_part;
-                            osc->fp1[k][0] = fabs(n->blue);
-                            osc->fp1[k][1] = modf(fabs(n->blue), &dummy_int_part);
+                            state->fp1[n->osc_index][0] = fabs(n->blue);
+                            state->fp1[n->osc_index][1] = modf(fabs(n->blue), &dummy_int_part);
+
+#if defined(PARTIAL_FX) && defined(WITH_SOUNDPIPE)
+                            // convolved partials hold a convolver of the pool while playing (same effect selection as renderAdditive)
+                            if (((int)state->fp1[n->osc_index][0] % SP_OSC_MODS) == SP_CONV_MODS) {
+                                acquireConvolverVoice(fas_conv_voices, getConvolutionKernel(impulses_kernels, fabs(round(n->alpha))), k, n->osc_index);
+                            }
+#endif
 
                             if (n->previous_volume_l <= 0 && n->previous_volume_r <= 0) {
                                 unsigned int alpha = fabs(round(n->alpha));
@@ -1585,68 +2256,28 @@ static int audioCallback(float **inputBuffer, float **outputBuffer, unsigned lon
                                 if (alpha != palpha) {
                                     if (fx == SP_CONV_MODS) {
 #ifdef WITH_SOUNDPIPE
-                                        sp_ftbl *imp_ftbl = osc->ft_void;
-                                        if (impulses_count > 0) {
-                                            struct sample *smp = &impulses[alpha % impulses_count];
-                                            imp_ftbl = smp->ftbl;
+                                        // impulses are pre-transformed; switching is a pointer swap and history reset
+                                        struct _fas_convolver *conv = getConvolverVoice(fas_conv_voices, k, n->osc_index);
+                                        if (conv) {
+                                            setConvolverKernel(conv, getConvolutionKernel(impulses_kernels, alpha));
                                         }
-                                        sp_conv_destroy((sp_conv **)&osc->sp_mods[k][SP_CONV_MODS]);
-
-                                        sp_conv_create((sp_conv **)&osc->sp_mods[k][SP_CONV_MODS]);
-                                        sp_conv_init(sp, (sp_conv *)osc->sp_mods[k][SP_CONV_MODS], imp_ftbl, 2048);
 #endif
                                     }
                                 }
 
                                 //if (fx == SP_EMPTY_MODS) {
-                                //    osc->phase_index[k] = n->alpha * fas_wavetable_size_m1;
+                                //    state->phase_index[n->osc_index] = n->alpha * fas_wavetable_size_m1;
                                 //}
 #else
                                 // phase control via alpha value
-                                //osc->phase_index[k] = n->alpha * fas_wavetable_size_m1;
+                                //state->phase_index[n->osc_index] = n->alpha * fas_wavetable_size_m1;
 #endif
                             }
                         }
                     } else if (synthesis_method == FAS_GRANULAR) {
-                        for (j = s; j < e; j += 1) {
-                            struct note *n = &curr_notes[j];
-
-                            struct oscillator *osc = &curr_synth.oscillators[n->osc_index];
-
-                            // reset granular envelope; force grains creation
-                            if (n->smp_index != n->psmp_index) {
-                                unsigned int grain_index = n->osc_index * samples_count + n->smp_index;
-                                unsigned int si = curr_synth.bank_settings->h * samples_count;
-
-                                struct grain *gr = &curr_synth.grains[grain_index];
-
-                                for (d = 0; d < gr->density[k]; d += 1) {
-                                    gr = &curr_synth.grains[grain_index + (d * si)];
-
-                                    gr->env_index[k] = FAS_ENVS_SIZE;
-                                }
-                            }
-
-                            if (n->previous_volume_l <= 0 && n->previous_volume_r <= 0) {
-                                unsigned int grain_index = n->osc_index * samples_count + n->smp_index;
-                                unsigned int pgrain_index = n->osc_index * samples_count + n->psmp_index;
-                                unsigned int si = curr_synth.bank_settings->h * samples_count;
-
-                                struct grain *gr = &curr_synth.grains[grain_index];
-                                struct grain *gr2 = &curr_synth.grains[pgrain_index];
-
-                                for (d = 0; d < gr->density[k]; d += 1) {
-                                    gr = &curr_synth.grains[grain_index + (d * si)];
-
-                                    gr->env_index[k] = FAS_ENVS_SIZE;
-                                }
-
-                                for (d = 0; d < gr2->density[k]; d += 1) {
-                                    gr2 = &curr_synth.grains[pgrain_index + (d * si)];
-
-                                    gr2->env_index[k] = FAS_ENVS_SIZE;
-                                }
-                            }
+                        // match active grains against this frame notes (reset granular envelope on note-on / sample change; force grains creation)
+                        if (curr_synth.grains) {
+                            updateGrains(&curr_synth.grains->pools[k], curr_notes, s, e);
                         }
                     } else if (synthesis_method == FAS_BANDPASS) {
                         for (j = s; j < e; j += 1) {
@@ -1657,8 +2288,8 @@ static int audioCallback(float **inputBuffer, float **outputBuffer, unsigned lon
 #ifdef WITH_SOUNDPIPE
                             sp_butbp *bpb_l = (sp_butbp *)osc->sp_filters[k][SP_BANDPASS_FILTER_L];
                             sp_butbp *bpb_r = (sp_butbp *)osc->sp_filters[k][SP_BANDPASS_FILTER_R];
-                            bpb_l->bw = osc->bw[k] * fabs(n->alpha);
-                            bpb_r->bw = osc->bw[k] * fabs(n->alpha);
+                            bpb_l->bw = osc->bw * fabs(n->alpha);
+                            bpb_r->bw = osc->bw * fabs(n->alpha);
 #endif
                         }  
                     } else if (synthesis_method == FAS_FORMANT_SYNTH) {
@@ -1722,8 +2353,8 @@ static int audioCallback(float **inputBuffer, float **outputBuffer, unsigned lon
                             struct oscillator *osc = &curr_synth.oscillators[n->osc_index];
 
                             if (n->previous_volume_l <= 0 && n->previous_volume_r <= 0) {
-                                osc->fp1[k][0] = 0.0f;
-                                osc->fp1[k][1] = 0.0f;
+                                state->fp1[n->osc_index][0] = 0.0f;
+                                state->fp1[n->osc_index][1] = 0.0f;
                             }
 
                             if (instrument->p0 >= 0 && waves_count > 0) {
@@ -1731,15 +2362,15 @@ static int audioCallback(float **inputBuffer, float **outputBuffer, unsigned lon
 
                                 struct sample *smp = &waves[index];
 
-                                osc->wav1[k] = smp->data_l;
+                                state->wav1[n->osc_index] = smp->data_l;
 
-                                osc->fp1[k][3] = osc->freq / smp->pitch / ((FAS_FLOAT)fas_sample_rate / (FAS_FLOAT)smp->samplerate);
-                                osc->fp2[k][0] = smp->frames;
+                                state->fp1[n->osc_index][3] = osc->freq / smp->pitch / ((FAS_FLOAT)fas_sample_rate / (FAS_FLOAT)smp->samplerate);
+                                state->fp2[n->osc_index][0] = smp->frames;
                             } else {
-                                osc->wav1[k] = fas_sine_wavetable;
+                                state->wav1[n->osc_index] = fas_sine_wavetable;
 
-                                osc->fp1[k][3] = osc->phase_step;
-                                osc->fp2[k][0] = fas_wavetable_size;
+                                state->fp1[n->osc_index][3] = osc->phase_step;
+                                state->fp2[n->osc_index][0] = fas_wavetable_size;
                             }
 
                             if (instrument->p1 >= 0 && waves_count > 0) {
@@ -1747,19 +2378,19 @@ static int audioCallback(float **inputBuffer, float **outputBuffer, unsigned lon
 
                                 struct sample *smp = &waves[index];
 
-                                osc->wav2[k] = smp->data_l;
+                                state->wav2[n->osc_index] = smp->data_l;
 
-                                osc->fp1[k][4] = n->alpha / smp->pitch / ((FAS_FLOAT)fas_sample_rate / (FAS_FLOAT)smp->samplerate);
-                                osc->fp2[k][1] = smp->frames;
+                                state->fp1[n->osc_index][4] = n->alpha / smp->pitch / ((FAS_FLOAT)fas_sample_rate / (FAS_FLOAT)smp->samplerate);
+                                state->fp2[n->osc_index][1] = smp->frames;
                             } else {
-                                osc->wav2[k] = fas_sine_wavetable;
+                                state->wav2[n->osc_index] = fas_sine_wavetable;
 
-                                osc->fp1[k][4] = n->alpha / (FAS_FLOAT)fas_sample_rate * fas_wavetable_size;
-                                osc->fp2[k][1] = fas_wavetable_size;
+                                state->fp1[n->osc_index][4] = n->alpha / (FAS_FLOAT)fas_sample_rate * fas_wavetable_size;
+                                state->fp2[n->osc_index][1] = fas_wavetable_size;
                             }
 
                             double dummy_int_part;
-                            osc->fp3[k][0] = modf(fabs(n->blue), &dummy_int_part);
+                            state->fp3[n->osc_index][0] = modf(fabs(n->blue), &dummy_int_part);
                         }
                     } else if (synthesis_method == FAS_SUBTRACTIVE) {
                         for (j = s; j < e; j += 1) {
@@ -1794,11 +2425,11 @@ static int audioCallback(float **inputBuffer, float **outputBuffer, unsigned lon
 
                             // reset standalone filter on note-off
                             if (n->previous_volume_l <= 0 && n->previous_volume_r <= 0) {
-                                memset(osc->fp1[k], 0, sizeof(FAS_FLOAT) * 4);
-                                memset(osc->fp2[k], 0, sizeof(FAS_FLOAT) * 4);
-                                memset(osc->fp3[k], 0, sizeof(FAS_FLOAT) * 4);
+                                memset(state->fp1[n->osc_index], 0, sizeof(FAS_FLOAT) * 4);
+                                memset(state->fp2[n->osc_index], 0, sizeof(FAS_FLOAT) * 4);
+                                memset(state->fp3[n->osc_index], 0, sizeof(FAS_FLOAT) * 4);
 
-                                osc->pvalue[k] = 0.0f;
+                                state->pvalue[n->osc_index] = 0.0f;
                             }
 #endif
                         }
@@ -1839,16 +2470,16 @@ static int audioCallback(float **inputBuffer, float **outputBuffer, unsigned lon
 #ifndef WITH_SOUNDPIPE
                             huovilainen_compute(osc->freq * n->cutoff, n->res, &n->cutoff, &n->res, (FAS_FLOAT)fas_sample_rate);
 #endif
-                            if ((n->previous_volume_l <= 0 && n->previous_volume_r <= 0) || osc->triggered[k] == 1) {
+                            if ((n->previous_volume_l <= 0 && n->previous_volume_r <= 0) || state->triggered[n->osc_index] == 1) {
                                 if (model_type == 0) {
-                                    karplusTrigger(k, osc, n);
+                                    karplusTrigger(k, osc, state, n);
 
-                                    osc->triggered[k] = 0;
+                                    state->triggered[n->osc_index] = 0;
                                 }
                             }
 
                             double dummy_int_part;
-                            osc->fp1[k][0] = modf(fabs(n->blue), &dummy_int_part);
+                            state->fp1[n->osc_index][0] = modf(fabs(n->blue), &dummy_int_part);
                         }
                     } else if (synthesis_method == FAS_WAVETABLE_SYNTH) {
                         for (j = s; j < e; j += 1) {
@@ -1856,83 +2487,61 @@ static int audioCallback(float **inputBuffer, float **outputBuffer, unsigned lon
 
                             struct oscillator *osc = &curr_synth.oscillators[n->osc_index];
 
-                            if ((n->previous_volume_l <= 0 && n->previous_volume_r <= 0) || (osc->triggered[k] == 1 && instrument->p0 == 1)) {
+                            if ((n->previous_volume_l <= 0 && n->previous_volume_r <= 0) || (state->triggered[n->osc_index] == 1 && instrument->p0 == 1)) {
                                 int start_index = (int)fabs(round(n->blue)) % waves_count;
                                 int stop_index = (int)fabs(round(n->alpha)) % waves_count;
 
                                 if (n->blue > 0) {
-                                    osc->fp1[k][0] = start_index;
-                                    osc->fp2[k][0] = (start_index + 1) % waves_count;
+                                    state->fp1[n->osc_index][0] = start_index;
+                                    state->fp2[n->osc_index][0] = (start_index + 1) % waves_count;
                                 } else {
-                                    osc->fp1[k][0] = stop_index;
-                                    osc->fp2[k][0] = stop_index - 1;
-                                    if (osc->fp2[k][0] < 0) {
-                                        osc->fp2[k][0] = start_index;
+                                    state->fp1[n->osc_index][0] = stop_index;
+                                    state->fp2[n->osc_index][0] = stop_index - 1;
+                                    if (state->fp2[n->osc_index][0] < 0) {
+                                        state->fp2[n->osc_index][0] = start_index;
                                     }
                                 }
 
-                                struct sample *smp = &waves[(unsigned int)osc->fp1[k][0]];
+                                struct sample *smp = &waves[(unsigned int)state->fp1[n->osc_index][0]];
 
-                                osc->fp1[k][1] = 0;
-                                osc->fp1[k][2] = osc->freq / smp->pitch / ((FAS_FLOAT)fas_sample_rate / (FAS_FLOAT)smp->samplerate);
-                                osc->fp1[k][3] = 0;
+                                state->fp1[n->osc_index][1] = 0;
+                                state->fp1[n->osc_index][2] = osc->freq / smp->pitch / ((FAS_FLOAT)fas_sample_rate / (FAS_FLOAT)smp->samplerate);
+                                state->fp1[n->osc_index][3] = 0;
                                 
-                                struct sample *nsmp = &waves[(unsigned int)osc->fp2[k][0]];
+                                struct sample *nsmp = &waves[(unsigned int)state->fp2[n->osc_index][0]];
 
-                                osc->fp2[k][1] = 0;
-                                osc->fp2[k][2] = osc->freq / nsmp->pitch / ((FAS_FLOAT)fas_sample_rate / (FAS_FLOAT)nsmp->samplerate);
+                                state->fp2[n->osc_index][1] = 0;
+                                state->fp2[n->osc_index][2] = osc->freq / nsmp->pitch / ((FAS_FLOAT)fas_sample_rate / (FAS_FLOAT)nsmp->samplerate);
 
-                                osc->triggered[k] = 0;
+                                state->triggered[n->osc_index] = 0;
                             }
 
                             double dummy_int_part;
-                            osc->fp3[k][0] = modf(fabs(n->blue), &dummy_int_part);
+                            state->fp3[n->osc_index][0] = modf(fabs(n->blue), &dummy_int_part);
                         }
 #ifdef WITH_FAUST
-                    } else if (synthesis_method == FAS_FAUST) {
+                    } else if (synthesis_method == FAS_FAUST && fas_faust_voices) {
+                        unsigned int faust_dsp_index = instrument->p0 % fas_faust_voices->factories_count;
+
                         for (j = s; j < e; j += 1) {
                             // update notes related parameters
                             struct note *n = &curr_notes[j];
 
                             struct oscillator *osc = &curr_synth.oscillators[n->osc_index];
 
-                            int faust_dsp_index = instrument->p0 % osc->faust_gens_len;
-
-                            struct _fas_faust_dsp *fas_faust_dsp = osc->faust_gens[k][faust_dsp_index];
-
-                            // update Faust DSP params
-                            struct _fas_faust_ui_control *ctrl = fas_faust_dsp->controls;
-
-                            struct _fas_faust_ui_control *tmp;
-                            tmp = getFaustControl(ctrl, "fs_pr");
-                            if (tmp) {
-                                *tmp->zone = n->previous_volume_l;
-                            }
-
-                            tmp = getFaustControl(ctrl, "fs_pg");
-                            if (tmp) {
-                                *tmp->zone = n->previous_volume_r;
+                            // note-on assign a voice of the pool to this instrument / row
+                            struct _fas_faust_dsp *fas_faust_dsp = acquireFaustVoice(fas_faust_voices, osc, faust_dsp_index, k, n->osc_index);
+                            if (fas_faust_dsp == NULL) {
+                                continue;
                             }
 
-                            tmp = getFaustControl(ctrl, "fs_r");
-                            if (tmp) {
-                                *tmp->zone = n->volume_l;
-                            }
-
-                            tmp = getFaustControl(ctrl, "fs_g");
-                            if (tmp) {
-                                *tmp->zone = n->volume_r;
-                            }
-
-                            tmp = getFaustControl(ctrl, "fs_b");
-                            if (tmp) {
-                                *tmp->zone = n->blue;
-                            }
-
-                            tmp = getFaustControl(ctrl, "fs_a");
-                            if (tmp) {
-                                *tmp->zone = n->alpha;
-                            }
+                            // update Faust DSP params
+                            setFaustZone(fas_faust_dsp, FAS_FAUST_ZONE_PR, n->previous_volume_l);
+                            setFaustZone(fas_faust_dsp, FAS_FAUST_ZONE_PG, n->previous_volume_r);
+                            setFaustZone(fas_faust_dsp, FAS_FAUST_ZONE_R, n->volume_l);
+                            setFaustZone(fas_faust_dsp, FAS_FAUST_ZONE_G, n->volume_r);
+                            setFaustZone(fas_faust_dsp, FAS_FAUST_ZONE_B, n->blue);
+                            setFaustZone(fas_faust_dsp, FAS_FAUST_ZONE_A, n->alpha);
                         }
 #endif
                     } else if (synthesis_method == FAS_VOID) {
@@ -1940,6 +2549,15 @@ static int audioCallback(float **inputBuffer, float **outputBuffer, unsigned lon
                     }
                 }
 
+#ifdef WITH_FAUST
+                // note-off : recycle Faust voices which were not part of this frame
+                releaseFaustVoices(fas_faust_voices);
+#endif
+
+#if defined(PARTIAL_FX) && defined(WITH_SOUNDPIPE)
+                releaseConvolverVoices(fas_conv_voices);
+#endif
+
 #ifdef DEBUG
     frames_read += 1;
     if ((frames_read % 64) == 0) {
@@ -1976,6 +2594,87 @@ static int audioCallback(float **inputBuffer, float **outputBuffer, unsigned lon
     return 0;
 }
 
+/**
+ * Look-ahead mode render thread; render blocks into the output ring until it hold fas_lookahead blocks
+ **/
+static void *renderThread(void *args) {
+    unsigned int ahead_frames = fas_lookahead * FAS_BLOCK_SIZE;
+
+    // wait for a quarter of a block when enough frames are ahead
+    struct timespec ts = { 0, (long)(1000000000.0 / (double)fas_sample_rate * FAS_BLOCK_SIZE / 4.0) };
+
+    while (!atomic_load_explicit(&fas_render_thread_quit, memory_order_relaxed)) {
+        unsigned int ahead = fas_output_ring->frames - lookaheadWritable(fas_output_ring);
+        if (ahead + FAS_BLOCK_SIZE > ahead_frames) {
+            nanosleep(&ts, NULL);
+
+            continue;
+        }
+
+        // input frames; silence when the device did not provide them yet
+        if (fas_input_ring) {
+            if (lookaheadReadable(fas_input_ring) >= FAS_BLOCK_SIZE) {
+#ifdef INTERLEAVED_SAMPLE_FORMAT
+                readLookahead(fas_input_ring, fas_input_ring->block, FAS_BLOCK_SIZE);
+#else
+                readLookaheadPlanar(fas_input_ring, fas_input_ring->block_channels, FAS_BLOCK_SIZE);
+#endif
+            } else {
+                memset(fas_input_ring->block, 0, FAS_BLOCK_SIZE * fas_input_ring->channels * sizeof(float));
+            }
+        }
+
+        memset(fas_output_ring->block, 0, FAS_BLOCK_SIZE * fas_output_ring->channels * sizeof(float));
+
+#ifdef INTERLEAVED_SAMPLE_FORMAT
+        audioCallback(fas_input_ring ? fas_input_ring->block : NULL, fas_output_ring->block, FAS_BLOCK_SIZE);
+
+        writeLookahead(fas_output_ring, fas_output_ring->block, FAS_BLOCK_SIZE);
+#else
+        audioCallback(fas_input_ring ? fas_input_ring->block_channels : NULL, fas_output_ring->block_channels, FAS_BLOCK_SIZE);
+
+        writeLookaheadPlanar(fas_output_ring, fas_output_ring->block_channels, FAS_BLOCK_SIZE);
+#endif
+    }
+
+    return NULL;
+}
+
+/**
+ * Look-ahead mode device callback; only copy frames from / to the rings
+ **/
+#ifdef INTERLEAVED_SAMPLE_FORMAT
+static int lookaheadCallback(float *inputBuffer, float *outputBuffer, unsigned long nframes) {
+#else
+static int lookaheadCallback(float **inputBuffer, float **outputBuffer, unsigned long nframes) {
+#endif
+    if (fas_input_ring && inputBuffer) {
+        if (lookaheadWritable(fas_input_ring) >= nframes) {
+#ifdef INTERLEAVED_SAMPLE_FORMAT
+            writeLookahead(fas_input_ring, inputBuffer, nframes);
+#else
+            writeLookaheadPlanar(fas_input_ring, inputBuffer, nframes);
+#endif
+        }
+    }
+
+    unsigned int frames = lookaheadReadable(fas_output_ring);
+    if (frames < nframes) {
+        // underrun; missing frames are left silent
+        atomic_fetch_add_explicit(&fas_lookahead_underruns, 1, memory_order_relaxed);
+    } else {
+        frames = nframes;
+    }
+
+#ifdef INTERLEAVED_SAMPLE_FORMAT
+    readLookahead(fas_output_ring, outputBuffer, frames);
+#else
+    readLookaheadPlanar(fas_output_ring, outputBuffer, frames);
+#endif
+
+    return 0;
+}
+
 #ifdef WITH_JACK
 int jackCallback (jack_nframes_t nframes, void *arg) {
     cpu_load_measurer.measurementStartTime = get_time();
@@ -1991,7 +2690,12 @@ int jackCallback (jack_nframes_t nframes, void *arg) {
         memset(jack_out[i], 0, sizeof(float) * nframes);
     }
 
-    int r = audioCallback((float **)jack_in, (float **)jack_out, nframes);
+    int r;
+    if (fas_output_ring) {
+        r = lookaheadCallback((float **)jack_in, (float **)jack_out, nframes);
+    } else {
+        r = audioCallback((float **)jack_in, (float **)jack_out, nframes);
+    }
 
     // compute CPU load (come from PortAudio)
     double measurementEndTime = get_time();
@@ -2021,12 +2725,21 @@ static int paCallback(const void *inputBuffer, void *outputBuffer,
 #ifdef INTERLEAVED_SAMPLE_FORMAT
     void *input_buffer = (void *)inputBuffer;
     memset(outputBuffer, 0, nframes * sizeof(float) * fas_output_channels);
+
+    if (fas_output_ring) {
+        return lookaheadCallback((float *)input_buffer, (float *)outputBuffer, nframes);
+    }
+
     return audioCallback((float *)input_buffer, (float *)outputBuffer, nframes);
 #else
     for (int i = 0; i < fas_output_channels; i += 1) {
         memset(&outputBuffer[i], 0, nframes * sizeof(float));
     }
 
+    if (fas_output_ring) {
+        return lookaheadCallback((float **)inputBuffer, (float **)outputBuffer, nframes);
+    }
+
     return audioCallback((float **)inputBuffer, (float **)outputBuffer, nframes);
 #endif
 }
@@ -2098,10 +2811,77 @@ struct _freelist_synth_commands *getSynthCommandFreelist() {
         fflush(stdout);
 #endif
 
-        return NULL;
+        return NULL;
+    }
+
+    return LFDS720_FREELIST_N_GET_VALUE_FROM_ELEMENT(*fe);
+}
+
+/**
+ * decode a sparse FRAME_DATA packet once; the decoded frame is reused when the next frame is decoded against it
+ **/
+static void prepareFrame(struct _fas_decoder_job *job, void *data) {
+    struct _fas_frames_format *format = (struct _fas_frames_format *)data;
+
+    if (job->sparse_frame == NULL) {
+        return;
+    }
+
+    size_t header_length = PACKET_HEADER_LENGTH + FRAME_HEADER_LENGTH;
+
+    unsigned int instruments[1];
+    memcpy(&instruments, &job->curr->data[PACKET_HEADER_LENGTH], sizeof(instruments));
+
+    // validated before submission
+    decodeSparseFrame(job->sparse_frame, (*instruments), format->data_size,
+        (unsigned char *)&job->curr->data[header_length], job->curr->len - header_length);
+}
+
+/**
+ * FRAME_DATA packet to notes buffer; called by the decoding threads (or the network thread when there is none)
+ * frames are validated and their notes buffer acquired before submission so decoding never drop a frame
+ **/
+static void decodeFrame(struct _fas_decoder_job *job, void *data) {
+    struct _fas_frames_format *format = (struct _fas_frames_format *)data;
+    struct _freelist_frames_data *freelist_frames_data = (struct _freelist_frames_data *)job->output;
+
+    unsigned int instruments[1];
+    memcpy(&instruments, &job->curr->data[PACKET_HEADER_LENGTH], sizeof(instruments));
+
+    if ((*instruments) > fas_max_instruments) {
+        (*instruments) = fas_max_instruments;
+    }
+
+    unsigned int notes_count = 0;
+    if (job->sparse_frame) {
+        // both frames are prepared (previous frame is a submitted frame or the initial empty one)
+        notes_count = fillNotesBufferSparse(samples_count_m1, waves_count_m1, fas_granular_max_density, (*instruments), format->data_size,
+                        freelist_frames_data->data, job->prev_sparse_frame, job->sparse_frame);
+    } else {
+        notes_count = fillNotesBuffer(samples_count_m1, waves_count_m1, fas_granular_max_density, (*instruments), format->data_size,
+                        freelist_frames_data->data, format->h, format->frame_length,
+                        &job->prev->data[PACKET_HEADER_LENGTH], &job->curr->data[PACKET_HEADER_LENGTH]);
+    }
+
+    // notes buffer is not cleared; instruments which are not part of the frame have no notes
+    memset(&freelist_frames_data->data[notes_count], 0, sizeof(struct note) * (fas_max_instruments - (*instruments)));
+}
+
+/**
+ * push a notes buffer to the audio thread; called in frames order
+ **/
+static void commitFrame(void *output, void *data) {
+    LFDS720_MISC_MAKE_VALID_ON_CURRENT_LOGICAL_CORE_INITS_COMPLETED_BEFORE_NOW_ON_ANY_OTHER_PHYSICAL_CORE;
+
+    struct _freelist_frames_data *freelist_frames_data = (struct _freelist_frames_data *)output;
+    struct _freelist_frames_data *overwritten_notes = NULL;
+
+    lfds720_ringbuffer_n_write(&rs, (void *) (lfds720_pal_uint_t) freelist_frames_data, NULL, &overwrite_occurred_flag, (void *)&overwritten_notes, NULL);
+    if (overwrite_occurred_flag == LFDS720_MISC_FLAG_RAISED) {
+        // okay, push it back!
+        LFDS720_FREELIST_N_SET_VALUE_IN_ELEMENT(overwritten_notes->fe, overwritten_notes);
+        lfds720_freelist_n_threadsafe_push(&freelist_frames, NULL, &overwritten_notes->fe);
     }
-
-    return LFDS720_FREELIST_N_GET_VALUE_FROM_ELEMENT(*fe);
 }
 
 void freeRender() {
@@ -2151,6 +2931,10 @@ void render(struct user_session_data *usd, void *data, unsigned int channels) {
         if (usd->frame_data_size == sizeof(float)) {
             frame_data_index = 2;
 
+            data_length /= usd->frame_data_size;
+        } else if (usd->frame_data_size == sizeof(uint16_t)) {
+            frame_data_index = 4;
+
             data_length /= usd->frame_data_size;
         }
 
@@ -2167,6 +2951,15 @@ void render(struct user_session_data *usd, void *data, unsigned int channels) {
                     fas_render_buffer[index + 1] = fmin(cdata[frame_data_index + 1] * 255.0f, 255.0f);
                     fas_render_buffer[index + 2] = fmin(cdata[frame_data_index + 2] * 255.0f, 255.0f);
                     fas_render_buffer[index + 3] = fmin(cdata[frame_data_index + 3] * 255.0f, 255.0f);
+                } else if (usd->frame_data_size == sizeof(uint16_t)) {
+                    float rgba[4];
+
+                    halfToFloat4(&((uint16_t *)data)[frame_data_index], rgba);
+
+                    fas_render_buffer[index] = fmin(rgba[0] * 255.0f, 255.0f);
+                    fas_render_buffer[index + 1] = fmin(rgba[1] * 255.0f, 255.0f);
+                    fas_render_buffer[index + 2] = fmin(rgba[2] * 255.0f, 255.0f);
+                    fas_render_buffer[index + 3] = fmin(rgba[3] * 255.0f, 255.0f);
                 } else {
                     unsigned char *dst = fas_render_buffer + index;
                     unsigned char *src = (unsigned char *)data + frame_data_index;
@@ -2197,6 +2990,16 @@ void freeUserSynthChnFxSettings(double ***synth_chn_fx_settings) {
     }
 }
 
+// largest frame packet of a bank (sparse frames worst case is one run per row)
+static size_t maxFramePacketLength(struct _bank_settings *bank_settings, unsigned int frame_data_size) {
+    if (bank_settings->data_type & FAS_FRAME_DATA_SPARSE) {
+        return PACKET_HEADER_LENGTH + FRAME_HEADER_LENGTH +
+            fas_max_instruments * (sizeof(uint32_t) + bank_settings->h * (sizeof(uint32_t) * 2 + 4 * frame_data_size));
+    }
+
+    return PACKET_HEADER_LENGTH + FRAME_HEADER_LENGTH + 4 * frame_data_size * bank_settings->h * fas_max_instruments;
+}
+
 int ws_callback(struct lws *wsi, enum lws_callback_reasons reason,
                         void *user, void *in, size_t len) {
     LFDS720_MISC_MAKE_VALID_ON_CURRENT_LOGICAL_CORE_INITS_COMPLETED_BEFORE_NOW_ON_ANY_OTHER_PHYSICAL_CORE;
@@ -2245,6 +3048,10 @@ int ws_callback(struct lws *wsi, enum lws_callback_reasons reason,
                 for (m = 0; m < FAS_MAX_FX_SLOTS; m += 1) {
                     usd->synth_chn_fx_settings[n][m] = calloc(FAS_MAX_FX_PARAMETERS, sizeof(double));
                     // TODO : check calloc return value
+                    if (usd->synth_chn_fx_settings[n][m]) {
+                        // no effect
+                        usd->synth_chn_fx_settings[n][m][0] = -1;
+                    }
                 }
             }
 
@@ -2271,9 +3078,8 @@ int ws_callback(struct lws *wsi, enum lws_callback_reasons reason,
 
             usd->packet = NULL;
             usd->packet_len = 0;
+            usd->packet_capacity = 0;
             usd->packet_skip = 0;
-            usd->frame_data = NULL;
-            usd->prev_frame_data = NULL;
 
             usd->connected = 1;
 
@@ -2292,15 +3098,23 @@ int ws_callback(struct lws *wsi, enum lws_callback_reasons reason,
                 return 0;
             }
 
-            usd->packet_len += len;
-
             remaining_payload = lws_remaining_packet_payload(wsi);
 
-            if (usd->packet == NULL) {
-                // we initialize the first fragment or the final one
-                // this mechanism depend on the rx buffer size
-                usd->packet = (char *)malloc(len);
-                if (usd->packet == NULL) {
+#ifdef DEBUG_NETWORK
+if (usd->packet_len == 0) {
+    printf("\nReceiving packet...\n");
+}
+#endif
+
+            // accumulate the packet fragments to construct the final one
+            if (usd->packet_len + len > usd->packet_capacity) {
+                size_t packet_capacity = usd->packet_capacity * 2;
+                if (packet_capacity < usd->packet_len + len + remaining_payload) {
+                    packet_capacity = usd->packet_len + len + remaining_payload;
+                }
+
+                char *new_packet = (char *)realloc(usd->packet, packet_capacity);
+                if (new_packet == NULL) {
                     if (is_final_fragment) {
                         printf("A packet was skipped due to alloc. error.\n");
                     } else {
@@ -2310,35 +3124,19 @@ int ws_callback(struct lws *wsi, enum lws_callback_reasons reason,
                     }
                     fflush(stdout);
 
-                    return 0;
-                }
-
-                memcpy(usd->packet, &((char *) in)[0], len);
-
-#ifdef DEBUG_NETWORK
-    printf("\nReceiving packet...\n");
-#endif
-            } else {
-                // accumulate the packet fragments to construct the final one
-                char *new_packet = (char *)realloc(usd->packet, usd->packet_len);
-
-                if (new_packet == NULL) {
-                    free(usd->packet);
-                    usd->packet = NULL;
-
-                    usd->packet_skip = 1;
-
-                    printf("A packet will be skipped due to alloc. error.\n");
-                    fflush(stdout);
+                    usd->packet_len = 0;
 
                     return 0;
                 }
 
                 usd->packet = new_packet;
-
-                memcpy(&(usd->packet)[usd->packet_len - len], &((char *) in)[0], len);
+                usd->packet_capacity = packet_capacity;
             }
 
+            memcpy(&usd->packet[usd->packet_len], in, len);
+
+            usd->packet_len += len;
+
 #ifdef DEBUG_NETWORK
 if (remaining_payload != 0) {
     printf("Remaining packet payload: %lu\n", remaining_payload);
@@ -2357,49 +3155,83 @@ if (remaining_payload != 0) {
 #endif
 
                 if (pid == BANK_SETTINGS) {
+                    // pending frames are decoded with the previous settings
+                    flushDecoder(fas_decoder);
+
                     audioFlushThenPause();
 
                     // flush all waiting data
                     clearQueues();
 
-                    // copy new settings
-                    memcpy(curr_synth.bank_settings, &((char *) usd->packet)[PACKET_HEADER_LENGTH], sizeof(struct _bank_settings));
+                    // new settings are applied once all frames buffers are allocated (previous settings & banks are kept on failure)
+                    struct _bank_settings bank_settings;
+                    memcpy(&bank_settings, &((char *) usd->packet)[PACKET_HEADER_LENGTH], sizeof(struct _bank_settings));
 
 #ifdef DEBUG
-    printf("BANK_SETTINGS : %u, %u, %u, %f\n", curr_synth.bank_settings->h,
-        curr_synth.bank_settings->octave, curr_synth.bank_settings->data_type, curr_synth.bank_settings->base_frequency);
+    printf("BANK_SETTINGS : %u, %u, %u, %f\n", bank_settings.h,
+        bank_settings.octave, bank_settings.data_type, bank_settings.base_frequency);
 #endif
 
-                    // free grains & oscillator banks
-                    freeGrains(&curr_synth.grains, samples_count, fas_max_instruments, usd->synth_h, fas_granular_max_density);
+                    // pre-compute frames size (aka notes slice data)
+                    unsigned int frame_data_size = 0;
+                    if (bank_settings.data_type & FAS_FRAME_DATA_HALF) {
+                        frame_data_size = sizeof(uint16_t);
+                    } else {
+                        frame_data_size = (bank_settings.data_type & FAS_FRAME_DATA_FLOAT) ? sizeof(float) : sizeof(unsigned char);
+                    }
 
-                    curr_synth.oscillators = freeOscillatorsBank(&curr_synth.oscillators, usd->synth_h, fas_max_instruments);
+                    size_t max_frame_packet_len = maxFramePacketLength(&bank_settings, frame_data_size);
 
-                    // pre-compute frames size (aka notes slice data)
-                    usd->frame_data_size = curr_synth.bank_settings->data_type ? sizeof(float) : sizeof(unsigned char);
+                    // preallocate the packet buffer so that frames fragments never need an allocation (content is kept)
+                    if (usd->packet_capacity < max_frame_packet_len) {
+                        char *new_packet = (char *)realloc(usd->packet, max_frame_packet_len);
+                        if (new_packet == NULL) {
+                            printf("BANK_SETTINGS : packet buffer alloc. failed, previous settings are kept.\n");
+                            fflush(stdout);
 
-                    usd->expected_frame_length = 4 * usd->frame_data_size * curr_synth.bank_settings->h;
-                    usd->expected_max_frame_length = 4 * usd->frame_data_size * curr_synth.bank_settings->h * fas_max_instruments;
-                    size_t max_frame_data_len = usd->expected_frame_length * fas_max_instruments + sizeof(unsigned int);
+                            audioPlay();
+
+                            goto free_packet;
+                        }
 
-                    // free frames data state
-                    free(usd->frame_data);
-                    free(usd->prev_frame_data);
+                        usd->packet = new_packet;
+                        usd->packet_capacity = max_frame_packet_len;
+                    }
 
-                    usd->frame_data = NULL;
-                    usd->prev_frame_data = NULL;
+                    // sparse frames are decoded against the previous frame active rows (note-off)
+                    if (setDecoderFrames(fas_decoder, max_frame_packet_len, bank_settings.h, fas_max_instruments,
+                            (bank_settings.data_type & FAS_FRAME_DATA_SPARSE) ? 1 : 0) != 0) {
+                        printf("BANK_SETTINGS : frames decoding buffers alloc. failed, previous settings are kept.\n");
+                        fflush(stdout);
 
-                    usd->frame_data = calloc(max_frame_data_len, usd->frame_data_size);
-                    usd->prev_frame_data = calloc(max_frame_data_len, usd->frame_data_size);
-                    if (usd->prev_frame_data == NULL || usd->frame_data == NULL) {
-                        printf("BANK_SETTINGS : frame_data / prev_frame_data calloc failed.");
+                        // frames are skipped until the next settings change when previous buffers cannot be restored either
+                        if (usd->synth_h > 0) {
+                            setDecoderFrames(fas_decoder, maxFramePacketLength(curr_synth.bank_settings, usd->frame_data_size), usd->synth_h, fas_max_instruments,
+                                (curr_synth.bank_settings->data_type & FAS_FRAME_DATA_SPARSE) ? 1 : 0);
+                        }
 
-                        free(usd->frame_data);
-                        free(usd->prev_frame_data);
+                        audioPlay();
 
                         goto free_packet;
                     }
 
+                    memcpy(curr_synth.bank_settings, &bank_settings, sizeof(struct _bank_settings));
+
+                    usd->frame_data_size = frame_data_size;
+                    usd->expected_frame_length = 4 * usd->frame_data_size * curr_synth.bank_settings->h;
+                    usd->expected_max_frame_length = 4 * usd->frame_data_size * curr_synth.bank_settings->h * fas_max_instruments;
+
+                    fas_frames_format.h = curr_synth.bank_settings->h;
+                    fas_frames_format.data_size = usd->frame_data_size;
+                    fas_frames_format.frame_length = usd->expected_frame_length;
+
+                    // free grains & oscillator banks
+                    freeGrains(&curr_synth.grains);
+
+                    curr_synth.oscillators = freeOscillatorsBank(&curr_synth.oscillators, usd->synth_h, fas_max_instruments);
+                    curr_synth.oscillators_state = freeOscillatorsState(&curr_synth.oscillators_state, fas_max_instruments);
+                    curr_synth.additive_banks = freeAdditiveBanks(&curr_synth.additive_banks, fas_max_instruments);
+
                     usd->oscillators = freeOscillatorsBank(&usd->oscillators, usd->synth_h, fas_max_instruments);
 
                     usd->synth_h = curr_synth.bank_settings->h;
@@ -2412,29 +3244,51 @@ if (remaining_payload != 0) {
 #endif
                         curr_synth.bank_settings->h,
                         curr_synth.bank_settings->base_frequency, curr_synth.bank_settings->octave, fas_sample_rate, fas_wavetable_size, fas_max_instruments);
+
+                    curr_synth.oscillators_state = createOscillatorsState(curr_synth.oscillators, curr_synth.bank_settings->h, fas_wavetable_size, fas_max_instruments);
+                    curr_synth.additive_banks = createAdditiveBanks(curr_synth.bank_settings->h, fas_max_instruments);
                         
 #ifdef WITH_FAUST
+                    setFaustGeneratorsBank(fas_faust_voices, curr_synth.bank_settings->h, fas_max_instruments);
 
-                    createFaustGenerators(
-                        fas_faust_gens,
-                        curr_synth.oscillators,
-                        curr_synth.bank_settings->h,
-                        fas_sample_rate,
-                        fas_max_instruments
-                    );
+                    // instances of a pending generators reload are resized as well
+                    struct timespec faust_reload_ts = { 0, 1000000 };
+                    while (atomic_load(&fas_faust_reload_state) == FAS_FAUST_RELOAD_BUILDING) {
+                        nanosleep(&faust_reload_ts, NULL);
+                    }
+
+                    if (atomic_load(&fas_faust_reload_state) == FAS_FAUST_RELOAD_READY && fas_faust_reload.voices) {
+                        setFaustGeneratorsBank(fas_faust_reload.voices, curr_synth.bank_settings->h, fas_max_instruments);
+                    }
+#endif
+
+#ifdef PARTIAL_FX
+                    setConvolverVoicesBank(fas_conv_voices, curr_synth.bank_settings->h, fas_max_instruments);
 #endif
 
                     // pre-compute grains data
-                    curr_synth.grains = createGrains(&samples, samples_count, usd->synth_h, curr_synth.bank_settings->base_frequency, curr_synth.bank_settings->octave, fas_sample_rate, fas_max_instruments, fas_granular_max_density);
+                    curr_synth.grains = createGrains(usd->synth_h, curr_synth.bank_settings->base_frequency, curr_synth.bank_settings->octave, fas_sample_rate, fas_max_instruments, fas_granular_max_grains);
 
                     //initRender(usd->synth_h);
 
                     initializeSynthChnSettings();
 
+                    for (i = 0; i < fas_max_channels; i += 1) {
+                        compileEffectsChain(synth_fx[i], &curr_synth.chn_settings[i]);
+                    }
+
                     for (i = 0; i < fas_max_instruments; i += 1) {
                         curr_synth.instruments[i].type = FAS_VOID;
                     }
 
+                    // audio stay paused (frames are dropped) until the next bank settings
+                    if (curr_synth.oscillators == NULL || curr_synth.oscillators_state == NULL || curr_synth.additive_banks == NULL || curr_synth.grains == NULL) {
+                        printf("BANK_SETTINGS : banks alloc. failed, audio is paused.\n");
+                        fflush(stdout);
+
+                        goto free_packet;
+                    }
+
                     audioPlay();
                 } else if (pid == FRAME_DATA) {
 #ifdef DEBUG_FRAME_DATA
@@ -2456,7 +3310,7 @@ if (remaining_payload != 0) {
                     //    goto free_packet;
                     //}
 
-                    if (usd->frame_data == NULL) {
+                    if (fas_decoder->last == NULL) {
                         printf("Skipping a frame until a synth. settings change happen.\n");
                         fflush(stdout);
                         goto free_packet;
@@ -2479,12 +3333,52 @@ if (remaining_payload != 0) {
                         printf("Frame latency %fms\nFrame overall time %fms\n", time_between_frames_ms, frame_sync.acc_time);
                         fflush(stdout);
 #endif
+                    }
+
+                    size_t header_length = PACKET_HEADER_LENGTH + FRAME_HEADER_LENGTH;
+                    if (usd->packet_len < header_length) {
+                        printf("Skipping a malformed frame.\n");
+                        fflush(stdout);
+
+                        goto free_packet;
+                    }
 
-                        frame_sync.acc_time = 0;
+                    unsigned int instruments[1];
+                    memcpy(&instruments, &usd->packet[PACKET_HEADER_LENGTH], sizeof(instruments));
+
+                    if (curr_synth.bank_settings->data_type & FAS_FRAME_DATA_SPARSE) {
+                        // malformed frames are dropped here so that they never become the previous frame
+                        if (validateSparseFrame(usd->synth_h, ((*instruments) > fas_max_instruments) ? fas_max_instruments : (*instruments), usd->frame_data_size,
+                                (unsigned char *)&usd->packet[header_length], usd->packet_len - header_length) != 0) {
+                            printf("Skipping a malformed sparse frame.\n");
+                            fflush(stdout);
+
+                            goto free_packet;
+                        }
+                    } else {
+                        if ((*instruments) >= fas_max_instruments) {
+#ifdef DEBUG_FRAME_DATA
+                            printf("Frame instruments > Max instruments. (%i instrument ignored)\n", (*instruments) - fas_max_instruments);
+                            fflush(stdout);
+#endif
+                        } else {
+                            // instruments which are not part of the frame are silent
+                            size_t frame_end = header_length + usd->expected_frame_length * (*instruments);
+                            size_t max_frame_end = header_length + usd->expected_max_frame_length;
+                            if (frame_end > usd->packet_len) {
+                                frame_end = usd->packet_len;
+                            }
 
-                        curr_synth.curr_sample = 0;
+                            memset(&usd->packet[frame_end], 0, max_frame_end - frame_end);
+#ifdef DEBUG_FRAME_DATA
+                            printf("Frame instruments (%i) < Max instruments.\n", instruments[0]);
+                            fflush(stdout);
+#endif
+                        }
                     }
 
+                    //render(usd, &usd->packet[PACKET_HEADER_LENGTH], (*instruments));
+
 #ifdef DEBUG_FRAME_DATA
     lfds720_pal_uint_t frames_data_freelist_count;
     lfds720_freelist_n_query(&freelist_frames, LFDS720_FREELIST_N_QUERY_SINGLETHREADED_GET_COUNT, NULL, (void *)&frames_data_freelist_count);
@@ -2503,48 +3397,25 @@ if (remaining_payload != 0) {
                         goto free_packet;
                     }
 
-                    memcpy(usd->prev_frame_data, &usd->frame_data[0], usd->expected_max_frame_length);
-
-                    unsigned int instruments[1];
-                    memcpy(&instruments, &usd->packet[PACKET_HEADER_LENGTH], sizeof(instruments));
+                    freelist_frames_data = LFDS720_FREELIST_N_GET_VALUE_FROM_ELEMENT(*fe);
 
-                    if ((*instruments) >= fas_max_instruments) {
-#ifdef DEBUG_FRAME_DATA
-                        printf("Frame instruments > Max instruments. (%i instrument ignored)\n", (*instruments) - fas_max_instruments);
+                    // hand the packet to the decode pipeline; the packet buffer is exchanged with a free one
+                    if (submitDecoder(fas_decoder, &usd->packet, &usd->packet_capacity, usd->packet_len, freelist_frames_data) != 0) {
+#ifdef DEBUG
+                        printf("Skipping a frame, frames decoding queues are full.\n");
                         fflush(stdout);
 #endif
 
-                        (*instruments) = fas_max_instruments;
+                        LFDS720_FREELIST_N_SET_VALUE_IN_ELEMENT(freelist_frames_data->fe, freelist_frames_data);
+                        lfds720_freelist_n_threadsafe_push(&freelist_frames, NULL, &freelist_frames_data->fe);
 
-                        memcpy(usd->frame_data, &usd->packet[PACKET_HEADER_LENGTH], usd->expected_frame_length * (*instruments) - PACKET_HEADER_LENGTH);
-                    } else if ((*instruments) < fas_max_instruments) {
-                        memcpy(usd->frame_data, &usd->packet[PACKET_HEADER_LENGTH], usd->packet_len - PACKET_HEADER_LENGTH);
-                        memset(&usd->frame_data[usd->expected_frame_length * (*instruments)], 0, usd->expected_frame_length * (fas_max_instruments - (*instruments)));
-#ifdef DEBUG_FRAME_DATA
-                        printf("Frame instruments (%i) < Max instruments.\n", instruments[0]);
-                        fflush(stdout);
-#endif
-                    } else {
-                        memcpy(usd->frame_data, &usd->packet[PACKET_HEADER_LENGTH], usd->packet_len - PACKET_HEADER_LENGTH);
+                        goto free_packet;
                     }
 
-                    //render(usd, usd->frame_data, (*instruments));
-
-                    freelist_frames_data = LFDS720_FREELIST_N_GET_VALUE_FROM_ELEMENT(*fe);
-
-                    memset(freelist_frames_data->data, 0, sizeof(struct note) * (usd->synth_h + 1) * fas_max_instruments + sizeof(unsigned int));
+                    // frames timing restart only for submitted frames (a dropped frame keep accumulating time)
+                    frame_sync.acc_time = 0;
 
-                    fillNotesBuffer(samples_count_m1, waves_count_m1, fas_granular_max_density, (*instruments), usd->frame_data_size,
-                                    freelist_frames_data->data, usd->synth_h, usd->expected_frame_length,
-                                    usd->prev_frame_data, usd->frame_data);
-
-                    struct _freelist_frames_data *overwritten_notes = NULL;
-                    lfds720_ringbuffer_n_write(&rs, (void *) (lfds720_pal_uint_t) freelist_frames_data, NULL, &overwrite_occurred_flag, (void *)&overwritten_notes, NULL);
-                    if (overwrite_occurred_flag == LFDS720_MISC_FLAG_RAISED) {
-                        // okay, push it back!
-                        LFDS720_FREELIST_N_SET_VALUE_IN_ELEMENT(overwritten_notes->fe, overwritten_notes);
-                        lfds720_freelist_n_threadsafe_push(&freelist_frames, NULL, &overwritten_notes->fe);
-                    }
+                    curr_synth.curr_sample = 0;
 
                     // check & send stream informations (load & latency)
                     time_t stream_load_end;
@@ -2565,6 +3436,16 @@ if (remaining_payload != 0) {
                         lws_write(wsi, &p_load[LWS_SEND_BUFFER_PRE_PADDING], sizeof(int) * 2 + sizeof(double), LWS_WRITE_BINARY);
 
                         time(&stream_load_begin);
+
+                        // look-ahead mode underruns since the last report
+                        static unsigned int last_underruns = 0;
+                        unsigned int underruns = atomic_load(&fas_lookahead_underruns);
+                        if (underruns != last_underruns) {
+                            fprintf(stderr, "Look-ahead : %u underruns (%u total)\n", underruns - last_underruns, underruns);
+                            fflush(stderr);
+
+                            last_underruns = underruns;
+                        }
                     }
                 } else if (pid == SYNTH_SETTINGS) {
                     uint32_t target = 0;
@@ -2665,6 +3546,13 @@ if (remaining_payload != 0) {
 
                     if (target == 0) {
                         usd->instruments[instrument].type = value;
+
+#ifdef WITH_SOUNDPIPE
+                        // Soundpipe objects of this synthesis method are created here (not by the audio thread)
+                        if (curr_synth.oscillators) {
+                            createOscillatorsSoundpipe(sp, curr_synth.oscillators, curr_synth.bank_settings->h, instrument, (int)value, fas_sample_rate);
+                        }
+#endif
                     }
 
                     if (target == 3) {
@@ -2782,6 +3670,31 @@ if (remaining_payload != 0) {
 
                     usd->synth_chn_fx_settings[chn][fx_slot][target] = value;
 
+#ifdef WITH_SOUNDPIPE
+                    // effects instances are created when a slot is assigned, before the audio thread use it
+                    if (target == 0 && fx_slot < FAS_MAX_FX_SLOTS) {
+                        double **chn_fx_settings = usd->synth_chn_fx_settings[chn];
+
+                        if (value >= 0) {
+                            createEffectSlot(sp, synth_fx[chn], value, fx_slot);
+                        } else {
+                            // slot deletion; follow the audio thread slots shift so that shifted slots have their instances
+                            unsigned int s = 0;
+                            for (s = fx_slot; s < FAS_MAX_FX_SLOTS - 1; s += 1) {
+                                if (chn_fx_settings[s + 1][0] == -1) {
+                                    break;
+                                }
+
+                                memcpy(chn_fx_settings[s], chn_fx_settings[s + 1], sizeof(double) * FAS_MAX_FX_PARAMETERS);
+
+                                createEffectSlot(sp, synth_fx[chn], chn_fx_settings[s][0], s);
+                            }
+
+                            chn_fx_settings[s][0] = -1;
+                        }
+                    }
+
+#endif
                     // special case for effects which require re-initialization for this parameter
                     unsigned int curr_fx_id = usd->synth_chn_fx_settings[chn][fx_slot][0];
 
@@ -2898,6 +3811,9 @@ fflush(stdout);
 #endif
 
                     if (action_type[0] == FAS_ACTION_WAVES_RELOAD) { // RELOAD waves
+                        // frames are decoded against the current waves / samples count
+                        flushDecoder(fas_decoder);
+
                         audioPause();
 
                         free_samples(&waves, waves_count);
@@ -2923,6 +3839,19 @@ fflush(stdout);
 #endif
                         impulses_count_m1 = impulses_count - 1;
 
+#ifdef PARTIAL_FX
+                        // convolvers are tied to a kernels set
+                        freeConvolverVoices(&fas_conv_voices);
+    freeConvolutionKernels(&impulses_kernels);
+
+                        impulses_kernels = createConvolutionKernels(impulses, impulses_count, FAS_PARTIAL_CONV_PART_LEN);
+                        fas_conv_voices = createConvolverVoices(impulses_kernels, fas_partial_conv_polyphony);
+
+                        if (curr_synth.oscillators) {
+                            setConvolverVoicesBank(fas_conv_voices, curr_synth.bank_settings->h, fas_max_instruments);
+                        }
+#endif
+
                         for (n = 0; n < fas_max_channels; n += 1) {
                             resetConvolutions(
 #ifdef WITH_SOUNDPIPE
@@ -2933,9 +3862,11 @@ fflush(stdout);
 
                         audioPlay();
                     } else if (action_type[0] == FAS_ACTION_SAMPLES_RELOAD) { // RELOAD SAMPLES
+                        flushDecoder(fas_decoder);
+
                         audioPause();
 
-                        freeGrains(&curr_synth.grains, samples_count, fas_max_instruments, usd->synth_h, fas_granular_max_density);
+                        freeGrains(&curr_synth.grains);
 
                         free_samples(&samples, samples_count);
 
@@ -2946,7 +3877,7 @@ fflush(stdout);
 #endif
                         samples_count_m1 = samples_count - 1;
 
-                        curr_synth.grains = createGrains(&samples, samples_count, usd->synth_h, curr_synth.bank_settings->base_frequency, curr_synth.bank_settings->octave, fas_sample_rate, fas_max_instruments, fas_granular_max_density);
+                        curr_synth.grains = createGrains(usd->synth_h, curr_synth.bank_settings->base_frequency, curr_synth.bank_settings->octave, fas_sample_rate, fas_max_instruments, fas_granular_max_grains);
 
                         audioPlay();
                     } else if (action_type[0] == FAS_ACTION_NOTE_RESET) { // RE-TRIGGER note
@@ -2981,38 +3912,14 @@ fflush(stdout);
                         audioPlay();
                     }
 #ifdef WITH_FAUST
-                    else if (action_type[0] == FAS_ACTION_FAUST_GENS) { // reload Faust generators
-                            audioFlushThenPause();
-                            clearQueues();
-
-                            freeFaustGenerators(&curr_synth.oscillators, curr_synth.bank_settings->h, fas_max_instruments);
-
-                            freeFaustFactories(fas_faust_gens);
-                            fas_faust_gens = createFaustFactories(fas_faust_gens_path);
-
-                            createFaustGenerators(fas_faust_gens, curr_synth.oscillators, curr_synth.bank_settings->h, fas_sample_rate, fas_max_instruments);
-
-                            audioPlay();
-                    } else if (action_type[0] == FAS_ACTION_FAUST_EFFS) { // reload Faust effects
-                            audioFlushThenPause();
-                            clearQueues();
-
-                            freeFaustEffects(synth_fx, fas_max_channels);
-
-                            freeFaustFactories(fas_faust_effs);
-                            fas_faust_effs = createFaustFactories(fas_faust_effs_path);
-
-                            createFaustEffects(fas_faust_effs, synth_fx, fas_max_channels, fas_sample_rate);
-
-                            audioPlay();
+                    else if (action_type[0] == FAS_ACTION_FAUST_GENS || action_type[0] == FAS_ACTION_FAUST_EFFS) { // reload Faust generators / effects
+                        startFaustReload(action_type[0]);
                     }
 #endif
                 }
 
 free_packet:
-                free(usd->packet);
-                usd->packet = NULL;
-
+                // packet buffer is kept for the next packet
                 usd->packet_len = 0;
             }
 #ifdef DEBUG
@@ -3027,6 +3934,8 @@ free_packet:
             }
 
             if (clients > 0) {
+                flushDecoder(fas_decoder);
+
                 if (reason == LWS_CALLBACK_WS_PEER_INITIATED_CLOSE) {
                     audioFlushThenPause();
                 }
@@ -3049,11 +3958,17 @@ free_packet:
                     curr_synth.oscillators = freeOscillatorsBank(&curr_synth.oscillators, curr_synth.bank_settings->h, fas_max_instruments);
                 }
 
-                free(usd->prev_frame_data);
-                free(usd->frame_data);
+                curr_synth.oscillators_state = freeOscillatorsState(&curr_synth.oscillators_state, fas_max_instruments);
+                curr_synth.additive_banks = freeAdditiveBanks(&curr_synth.additive_banks, fas_max_instruments);
+
+                setDecoderFrames(fas_decoder, 0, 0, 0, 0);
+
+                free(usd->packet);
+
+                usd->packet = NULL;
 
-                usd->prev_frame_data = NULL;
-                usd->frame_data = NULL;
+                usd->packet_capacity = 0;
+                usd->packet_len = 0;
 
                 printf("Connection from %s (%s) closed.\n", usd->peer_name, usd->peer_ip);
                 fflush(stdout);
@@ -3189,6 +4104,17 @@ int main(int argc, char **argv)
         { "faust_effs_dir",             required_argument, 0, 29 },
         { "max_instruments",            required_argument, 0, 30 },
         { "max_channels",               required_argument, 0, 31 },
+        { "workers",                    required_argument, 0, 32 },
+        { "partition_threshold",        required_argument, 0, 33 },
+        { "lookahead",                  required_argument, 0, 34 },
+        { "faust_options",              required_argument, 0, 35 },
+        { "faust_target",               required_argument, 0, 36 },
+        { "faust_polyphony",            required_argument, 0, 37 },
+        { "faust_cache_dir",            required_argument, 0, 38 },
+        { "rand_seed",                  required_argument, 0, 39 },
+        { "granular_max_grains",        required_argument, 0, 40 },
+        { "decoders",                   required_argument, 0, 41 },
+        { "partial_conv_polyphony",     required_argument, 0, 42 },
         { 0, 0, 0, 0 }
     };
 
@@ -3299,11 +4225,50 @@ int main(int argc, char **argv)
             case 31:
                 fas_max_channels = strtoul(optarg, NULL, 0);
                 break;
+            case 32:
+                fas_workers_count = strtoul(optarg, NULL, 0);
+                break;
+            case 33:
+                fas_partition_threshold = strtoul(optarg, NULL, 0);
+                break;
+            case 34:
+                fas_lookahead = strtoul(optarg, NULL, 0);
+                break;
+            case 35:
+                fas_faust_options = optarg;
+                break;
+            case 36:
+                fas_faust_target = optarg;
+                break;
+            case 37:
+                fas_faust_polyphony = strtoul(optarg, NULL, 0);
+                break;
+            case 38:
+                fas_faust_cache_path = optarg;
+                break;
+            case 39:
+                fas_rand_seed = strtoull(optarg, NULL, 0);
+                break;
+            case 40:
+                fas_granular_max_grains = strtoul(optarg, NULL, 0);
+                break;
+            case 41:
+                fas_decoders_count = strtoul(optarg, NULL, 0);
+                break;
+            case 42:
+                fas_partial_conv_polyphony = strtoul(optarg, NULL, 0);
+                break;
             default: print_usage();
                 return EXIT_FAILURE;
         }
     }
 
+    if (fas_rand_seed == 0) {
+        fas_rand_seed = (uint64_t)time(NULL);
+    }
+
+    fasRandSeed(fas_rand_seed);
+
     if (fas_grains_path == NULL) {
 #ifdef __unix__
         struct stat s;
@@ -3429,6 +4394,10 @@ int main(int argc, char **argv)
 #endif
     }
 
+    if (fas_faust_cache_path == NULL) {
+        fas_faust_cache_path = fas_default_faust_cache_path;
+    }
+
     if (fas_max_instruments == 0) {
         printf("Warning: max_instruments program option argument is invalid, should be > 0, the default value (%u) will be used.\n", FAS_MAX_INSTRUMENTS);
 
@@ -3467,6 +4436,13 @@ int main(int argc, char **argv)
         fas_frames_per_buffer = FAS_FRAMES_PER_BUFFER;
     }
 
+    // look-ahead must hold at least a device buffer in addition to the block being rendered
+    if (fas_lookahead > 0 && fas_lookahead * FAS_BLOCK_SIZE < (unsigned int)fas_frames_per_buffer + FAS_BLOCK_SIZE) {
+        fas_lookahead = (fas_frames_per_buffer + FAS_BLOCK_SIZE * 2 - 1) / FAS_BLOCK_SIZE;
+
+        printf("Warning: lookahead program option argument is too low for the frames setting, %u blocks will be used.\n", fas_lookahead);
+    }
+
     if (fas_rx_buffer_size == 0) {
         printf("Warning: rx_buffer_size program option argument is invalid, should be > 0, the default value (%u) will be used.\n", FAS_RX_BUFFER_SIZE);
 
@@ -3515,6 +4491,12 @@ int main(int argc, char **argv)
         fas_noise_amount = FAS_GRANULAR_MAX_DENSITY;
     }
 
+    if (fas_granular_max_grains < 1) {
+        printf("Warning: granular_max_grains program option argument is invalid, should be >= 1, the default value (%i) will be used.\n", FAS_GRANULAR_MAX_GRAINS);
+
+        fas_granular_max_grains = FAS_GRANULAR_MAX_GRAINS;
+    }
+
     if (fas_stream_infos_send_delay < 1.) {
         printf("Warning: fas_stream_infos_send_delay program option argument is invalid, should be >= 1, the default value (%i) will be used.\n", FAS_STREAM_INFOS_SEND_DELAY);
 
@@ -3554,6 +4536,29 @@ int main(int argc, char **argv)
 #ifdef WITH_SOUNDPIPE
     sp_create(&sp);
     sp->sr = fas_sample_rate;
+
+    fas_instruments_sp = (sp_data *)calloc(fas_max_instruments, sizeof(sp_data));
+    fas_channels_sp = (sp_data *)calloc(fas_max_channels, sizeof(sp_data));
+    if (fas_instruments_sp == NULL || fas_channels_sp == NULL) {
+        fprintf(stderr, "Soundpipe data alloc. error.\n");
+
+        free(fas_instruments_sp);
+        free(fas_channels_sp);
+        sp_destroy(&sp);
+
+        return EXIT_FAILURE;
+    }
+
+    // distinct random numbers sequence per instrument / channel (reproducible with a fixed seed)
+    for (unsigned int k = 0; k < fas_max_instruments; k += 1) {
+        fas_instruments_sp[k] = *sp;
+        fas_instruments_sp[k].rand = (uint32_t)fasRandMix(fas_rand_seed + k);
+    }
+
+    for (unsigned int k = 0; k < fas_max_channels; k += 1) {
+        fas_channels_sp[k] = *sp;
+        fas_channels_sp[k].rand = (uint32_t)fasRandMix(fas_rand_seed + fas_max_instruments + k);
+    }
 #endif
 
     if (print_infos != 1) {
@@ -3568,6 +4573,11 @@ int main(int argc, char **argv)
             impulses_count_m1 = impulses_count - 1;
         }
 
+#ifdef PARTIAL_FX
+        impulses_kernels = createConvolutionKernels(impulses, impulses_count, FAS_PARTIAL_CONV_PART_LEN);
+        fas_conv_voices = createConvolverVoices(impulses_kernels, fas_partial_conv_polyphony);
+#endif
+
 #ifdef WITH_SOUNDPIPE
         waves_count = load_samples(sp, &waves, fas_waves_path, fas_sample_rate, fas_samplerate_converter_type, 0);
 #else
@@ -3587,8 +4597,10 @@ int main(int argc, char **argv)
         }
 
 #ifdef WITH_FAUST
-        fas_faust_gens = createFaustFactories("./faust/generators");
-        fas_faust_effs = createFaustFactories("./faust/effects");
+        fas_faust_gens = createFaustFactories("./faust/generators", fas_faust_options, fas_faust_target, fas_faust_cache_path);
+        fas_faust_effs = createFaustFactories("./faust/effects", fas_faust_options, fas_faust_target, fas_faust_cache_path);
+
+        fas_faust_voices = createFaustGenerators(fas_faust_gens, fas_faust_polyphony, fas_sample_rate);
 #endif
 
         if (fas_wavetable) {
@@ -3858,6 +4870,14 @@ int main(int argc, char **argv)
         goto error;  
     }
 
+    fas_instruments_graph = createInstrumentsGraph(fas_max_instruments);
+    if (!fas_instruments_graph) {
+        fprintf(stderr, "fas_instruments_graph alloc. failed\n");
+        fflush(stdout);
+
+        goto error;  
+    }
+
     curr_synth.settings = (struct _synth_settings*)calloc(1, sizeof(struct _synth_settings));
     if (!curr_synth.settings) {
         fprintf(stderr, "curr_synth.settings calloc failed\n");
@@ -3910,6 +4930,12 @@ int main(int argc, char **argv)
     createFaustEffects(fas_faust_effs, synth_fx, fas_max_channels, fas_sample_rate);
 #endif
 
+    initializeSynthChnSettings();
+
+    for (unsigned int i = 0; i < fas_max_channels; i += 1) {
+        compileEffectsChain(synth_fx[i], &curr_synth.chn_settings[i]);
+    }
+
 #if defined(_WIN32) || defined(_WIN64)
     struct lfds720_ringbuffer_n_element *re = NULL;
     re = malloc(sizeof(struct lfds720_ringbuffer_n_element) * (fas_frames_queue_size + 1));
@@ -3980,7 +5006,69 @@ int main(int argc, char **argv)
     }
 #endif
 
-    srand(time(NULL));
+    // instruments rendering workers (the audio thread is also one of them)
+    if (fas_workers_count > 1) {
+        fas_workers = createWorkers(fas_workers_count - 1);
+        if (fas_workers) {
+            printf("%i workers threads will be used to render instruments\n", fas_workers_count);
+        }
+    }
+
+    // frames decoding threads (frames are decoded on the network thread when 0)
+    fas_decoder = createDecoder(fas_decoders_count, fas_frames_queue_size, prepareFrame, decodeFrame, commitFrame, &fas_frames_format);
+    if (fas_decoder == NULL) {
+        fprintf(stderr, "frames decoder creation failed\n");
+        fflush(stdout);
+
+        goto quit;
+    }
+
+    if (fas_decoders_count > 0) {
+        printf("%i threads will be used to decode frames\n", fas_decoders_count);
+    }
+
+    // rendering tasks; an instrument may be split into one notes range per threads
+    fas_render_tasks = (struct _render_task *)calloc(fas_max_instruments * (fas_workers ? fas_workers_count : 1), sizeof(struct _render_task));
+    if (!fas_render_tasks) {
+        fprintf(stderr, "fas_render_tasks calloc failed\n");
+        fflush(stdout);
+
+        goto quit;
+    }
+
+    // look-ahead mode; rendering happen on a dedicated thread and the device callback only copy frames
+    if (fas_lookahead > 0) {
+        fas_output_ring = createLookaheadRing(fas_lookahead * FAS_BLOCK_SIZE, fas_output_channels);
+        if (fas_input_channels > 0) {
+            fas_input_ring = createLookaheadRing(fas_lookahead * FAS_BLOCK_SIZE, fas_input_channels);
+        }
+
+        if (fas_output_ring == NULL || (fas_input_channels > 0 && fas_input_ring == NULL)) {
+            fprintf(stderr, "look-ahead rings alloc. error.\n");
+            goto quit;
+        }
+
+        int render_thread_state = pthread_create(&fas_render_thread, NULL, &renderThread, NULL);
+        if (render_thread_state != 0) {
+            fprintf(stderr, "pthread_create renderThread error %i\n", render_thread_state);
+
+            freeLookaheadRing(&fas_output_ring);
+            freeLookaheadRing(&fas_input_ring);
+            goto quit;
+        }
+
+        // real-time priority (best effort; need privileges)
+        struct sched_param param;
+        param.sched_priority = sched_get_priority_max(SCHED_FIFO) - 1;
+        if (pthread_setschedparam(fas_render_thread, SCHED_FIFO, &param) != 0) {
+#ifdef DEBUG
+    printf("renderThread : real-time priority not available\n");
+    fflush(stdout);
+#endif
+        }
+
+        printf("Look-ahead mode : %u frames of latency added\n", fas_lookahead * FAS_BLOCK_SIZE);
+    }
 
     // start audio stream
 #ifndef WITH_JACK
@@ -4036,6 +5124,16 @@ quit:
     Pa_Terminate();
 #endif
 
+    if (fas_output_ring) {
+        atomic_store(&fas_render_thread_quit, 1);
+        pthread_join(fas_render_thread, NULL);
+
+        freeLookaheadRing(&fas_output_ring);
+        freeLookaheadRing(&fas_input_ring);
+    }
+
+    freeWorkers(&fas_workers);
+
     freeInstrumentsState(fas_instrument_states, fas_max_instruments);
 
     // free synth
@@ -4043,12 +5141,17 @@ quit:
         freeOscillatorsBank(&curr_synth.oscillators, curr_synth.bank_settings->h, fas_max_instruments);
     }
 
+    freeOscillatorsState(&curr_synth.oscillators_state, fas_max_instruments);
+    freeAdditiveBanks(&curr_synth.additive_banks, fas_max_instruments);
+
     free(curr_synth.instruments);
+    freeInstrumentsGraph(&fas_instruments_graph);
+    free(fas_render_tasks);
 
     free(curr_synth.settings);
 
     if (curr_synth.grains) {
-        freeGrains(&curr_synth.grains, samples_count, fas_max_instruments, curr_synth.bank_settings->h, fas_granular_max_density);
+        freeGrains(&curr_synth.grains);
     }
 
     free(curr_synth.bank_settings);
@@ -4062,6 +5165,22 @@ quit:
     if (sp) {
         sp_destroy(&sp);
     }
+
+    free(fas_instruments_sp);
+    free(fas_channels_sp);
+
+    fas_instruments_sp = NULL;
+    fas_channels_sp = NULL;
+#endif
+
+#ifdef WITH_FAUST
+    if (fas_faust_reload_joinable) {
+        atomic_store(&fas_faust_reload_quit, 1);
+        pthread_join(fas_faust_reload_thread, NULL);
+
+        // instances which were not swapped or not yet freed
+        freeFaustReload(&fas_faust_reload);
+    }
 #endif
 
     if (synth_fx) {
@@ -4073,14 +5192,20 @@ quit:
 
     freeEnvelopes(grain_envelope);
     free_samples(&impulses, impulses_count);
+    freeConvolverVoices(&fas_conv_voices);
+    freeConvolutionKernels(&impulses_kernels);
     free_samples(&waves, waves_count);
     free_samples(&samples, samples_count);
 
 #ifdef WITH_FAUST
+    freeFaustGenerators(&fas_faust_voices);
     freeFaustFactories(fas_faust_gens);
     freeFaustFactories(fas_faust_effs);
 #endif
 
+    // pending frames are decoded before the notes buffers are released
+    freeDecoder(&fas_decoder);
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
     if (re) {
@@ -4127,6 +5252,12 @@ error:
     if (sp) {
         sp_destroy(&sp);
     }
+
+    free(fas_instruments_sp);
+    free(fas_channels_sp);
+
+    fas_instruments_sp = NULL;
+    fas_channels_sp = NULL;
 #endif
 
 #ifndef WITH_JACK
@@ -4146,10 +5277,13 @@ error:
     free(fas_white_noise_table);
 
     free_samples(&impulses, impulses_count);
+    freeConvolverVoices(&fas_conv_voices);
+    freeConvolutionKernels(&impulses_kernels);
     free_samples(&samples, samples_count);
     free_samples(&waves, waves_count);
 
 #ifdef WITH_FAUST
+    freeFaustGenerators(&fas_faust_voices);
     freeFaustFactories(fas_faust_gens);
     freeFaustFactories(fas_faust_effs);
 #endif
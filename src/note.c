@@ -1,171 +1,495 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <stdint.h>
 
 #include "note.h"
+#include "half.h"
+
+// rows scanning (USE_SSE / USE_NEON build options)
+#if defined(USE_SSE) && defined(__SSE2__)
+    #include <emmintrin.h>
+
+    #define FAS_NOTE_SSE
+#elif defined(USE_NEON) && (defined(__ARM_NEON) || defined(__NEON__))
+    #include <arm_neon.h>
+
+    #define FAS_NOTE_NEON
+#endif
+
+// 32-bit words scanned at once (a multiple of every row words count)
+#define FAS_NOTE_SCAN_WORDS 32
+
+// modf / round replacements for non-negative values (notes parameters); values beyond 2^53 are integers
+static inline FAS_FLOAT truncPositive(FAS_FLOAT x) {
+    return (x < 9007199254740992.0) ? (FAS_FLOAT)(int64_t)x : x;
+}
+
+static inline FAS_FLOAT fracPositive(FAS_FLOAT x, FAS_FLOAT int_part) {
+    return (x < 9007199254740992.0) ? x - int_part : 0;
+}
+
+// compute a note from a row previous / current RGBA values; return 0 when the row is silent (no note)
+static int fillNote(struct note *_note, unsigned int y, FAS_FLOAT pl, FAS_FLOAT pr, FAS_FLOAT pb, FAS_FLOAT pa,
+                    FAS_FLOAT l, FAS_FLOAT r, FAS_FLOAT blue, FAS_FLOAT alpha, FAS_FLOAT inv_full_brightness,
+                    unsigned int samples_count, unsigned int waves_count, unsigned int max_density) {
+    FAS_FLOAT pvl, pvr, volume_l, volume_r;
+
+    if (l > 0 ) {
+        volume_l = l * inv_full_brightness;
+        pvl = pl * inv_full_brightness;
+        _note->previous_volume_l = pvl;
+        _note->volume_l = volume_l;
+        _note->diff_volume_l = volume_l - pvl;
+    } else {
+        if (pl > 0) {
+            pvl = pl * inv_full_brightness;
+
+            _note->previous_volume_l = pvl;
+            _note->diff_volume_l = -pvl;
+            _note->volume_l = 0;
+        } else {
+            _note->previous_volume_l = 0;
+            _note->diff_volume_l = 0;
+            _note->volume_l = -1;
+
+            if (r == 0 && pr == 0) {
+                return 0;
+            }
+        }
+    }
+
+    if (r > 0) {
+        volume_r = r * inv_full_brightness;
+        pvr = pr * inv_full_brightness;
+        _note->previous_volume_r = pvr;
+        _note->volume_r = volume_r;
+        _note->diff_volume_r = volume_r - pvr;
+    } else {
+        if (pr > 0) {
+            pvr = pr * inv_full_brightness;
+
+            _note->previous_volume_r = pvr;
+            _note->diff_volume_r = -pvr;
+            _note->volume_r = 0;
+        } else {
+            _note->previous_volume_r = 0;
+            _note->diff_volume_r = 0;
+            _note->volume_r = -1;
+
+            if (l == 0 && pl == 0) {
+                return 0;
+            }
+        }
+    }
+
+    if (_note->volume_l != -1 || _note->volume_r != -1) {
+        _note->osc_index = y;
+
+        _note->alpha = alpha;
+        _note->palpha = pa;
+        _note->pblue = pb;
+        _note->blue = blue;
+
+        FAS_FLOAT blue_abs = fabs(blue);
+        FAS_FLOAT pblue_abs = fabs(pb);
+        FAS_FLOAT alpha_abs = fabs(alpha);
+        FAS_FLOAT palpha_abs = fabs(pa);
+
+        FAS_FLOAT blue_int_part = truncPositive(blue_abs);
+        FAS_FLOAT pblue_int_part = truncPositive(pblue_abs);
+        FAS_FLOAT alpha_int_part = truncPositive(alpha_abs);
+        FAS_FLOAT palpha_int_part = truncPositive(palpha_abs);
+
+        _note->density = truncPositive(blue_abs + 0.5);
+
+        _note->norm_density = 1.0f / (_note->density + 0.0000001f);
+
+        if (_note->density < 1) {
+            _note->density = 1;
+        }
+
+        if (_note->density >= max_density) {
+            _note->density = 1;
+        }
+
+        FAS_FLOAT blue_frac_part = fracPositive(blue_abs, blue_int_part);
+        FAS_FLOAT pblue_frac_part = fracPositive(pblue_abs, pblue_int_part);
+        FAS_FLOAT alpha_frac_part = fracPositive(alpha_abs, alpha_int_part);
+
+        // for granular synthesis, samples and related
+        _note->smp_index = blue_frac_part * (samples_count + 1);
+        _note->psmp_index = pblue_frac_part * (samples_count + 1);
+
+        // for wavetable synthesis
+        _note->wav_index = (int)alpha_int_part % (waves_count + 1);
+        _note->pwav_index = (int)palpha_int_part % (waves_count + 1);
+
+        // for subtractive synthesis
+        _note->cutoff = blue_abs;
+        _note->res = alpha_frac_part;
+    } else {
+        // negative L / R values; the buffer is not cleared so this note is reset explicitly
+        memset(_note, 0, sizeof(struct note));
+
+        _note->volume_l = -1;
+        _note->volume_r = -1;
+    }
+
+    return 1;
+}
+
+// L / R words of a row once loaded as 32-bit words (4 words period); rows are 1 (8-bit), 2 (half float) or 4 (float) words
+static const uint32_t fas_lr_pattern_u8[4] = { 0x0000ffff, 0x0000ffff, 0x0000ffff, 0x0000ffff };
+static const uint32_t fas_lr_pattern_f16[4] = { 0x7fff7fff, 0, 0x7fff7fff, 0 };
+static const uint32_t fas_lr_pattern_f32[4] = { 0x7fffffff, 0x7fffffff, 0, 0 };
+
+// bitmask of the FAS_NOTE_SCAN_WORDS words which have a non-zero L / R value in the previous or current frame
+static inline uint32_t activeWordsMask(const uint32_t *prev, const uint32_t *cur, const uint32_t *pattern) {
+    uint32_t mask = 0;
+    unsigned int i;
+
+#if defined(FAS_NOTE_SSE)
+    __m128i p = _mm_loadu_si128((const __m128i *)pattern);
+    __m128i zero = _mm_setzero_si128();
+
+    for (i = 0; i < FAS_NOTE_SCAN_WORDS; i += 4) {
+        __m128i v = _mm_or_si128(_mm_loadu_si128((const __m128i *)&prev[i]), _mm_loadu_si128((const __m128i *)&cur[i]));
+        __m128i eq = _mm_cmpeq_epi32(_mm_and_si128(v, p), zero);
+
+        mask |= (uint32_t)(~_mm_movemask_ps(_mm_castsi128_ps(eq)) & 0xf) << i;
+    }
+#elif defined(FAS_NOTE_NEON)
+    static const uint32_t weights[4] = { 1, 2, 4, 8 };
+
+    uint32x4_t p = vld1q_u32(pattern);
+    uint32x4_t w = vld1q_u32(weights);
+
+    for (i = 0; i < FAS_NOTE_SCAN_WORDS; i += 4) {
+        uint32x4_t v = vorrq_u32(vld1q_u32(&prev[i]), vld1q_u32(&cur[i]));
+        uint32x4_t b = vandq_u32(vtstq_u32(v, p), w);
+        uint32x2_t s = vpadd_u32(vget_low_u32(b), vget_high_u32(b));
+        s = vpadd_u32(s, s);
+
+        mask |= vget_lane_u32(s, 0) << i;
+    }
+#else
+    for (i = 0; i < FAS_NOTE_SCAN_WORDS; i += 1) {
+        mask |= (uint32_t)(((prev[i] | cur[i]) & pattern[i & 3]) != 0) << i;
+    }
+#endif
+
+    return mask;
+}
+
+static inline void readRow(const unsigned char *data, unsigned int row, const unsigned int data_frame_size, float *rgba) {
+    if (data_frame_size == sizeof(float)) {
+        memcpy(rgba, &data[row * 4 * sizeof(float)], 4 * sizeof(float));
+    } else if (data_frame_size == sizeof(uint16_t)) {
+        halfToFloat4((const uint16_t *)&data[row * 4 * sizeof(uint16_t)], rgba);
+    } else {
+        const unsigned char *v = &data[row * 4];
+
+        rgba[0] = v[0];
+        rgba[1] = v[1];
+        rgba[2] = v[2];
+        rgba[3] = v[3];
+    }
+}
+
+// fill an instrument notes from its rows data, return the notes count
+// data_frame_size is a constant at each call site so that the data type branches are resolved out of the rows loop
+static inline unsigned int fillInstrumentNotes(struct note *note_buffer, unsigned int h, const unsigned char *prev_data, const unsigned char *data,
+                    const unsigned int data_frame_size, const uint32_t *pattern, FAS_FLOAT inv_full_brightness,
+                    unsigned int samples_count, unsigned int waves_count, unsigned int max_density) {
+    const uint32_t *pwords = (const uint32_t *)prev_data;
+    const uint32_t *cwords = (const uint32_t *)data;
+
+    // 32-bit words per row
+    const unsigned int row_words = data_frame_size;
+    const uint32_t row_bits = (1u << row_words) - 1;
+
+    unsigned int words = h * row_words;
+    unsigned int osc_count = 0;
+    unsigned int w = 0, k = 0;
+
+    for (w = 0; w < words; w += FAS_NOTE_SCAN_WORDS) {
+        uint32_t mask = 0;
+
+        if (w + FAS_NOTE_SCAN_WORDS <= words) {
+            mask = activeWordsMask(&pwords[w], &cwords[w], pattern);
+        } else {
+            for (k = w; k < words; k += 1) {
+                mask |= (uint32_t)(((pwords[k] | cwords[k]) & pattern[k & 3]) != 0) << (k - w);
+            }
+        }
+
+        while (mask) {
+            unsigned int bit = __builtin_ctz(mask);
+            unsigned int first_word = bit & ~(row_words - 1);
+            unsigned int row = (w + first_word) / row_words;
+
+            mask &= ~(row_bits << first_word);
+
+            float prgba[4], rgba[4];
+
+            readRow(prev_data, row, data_frame_size, prgba);
+            readRow(data, row, data_frame_size, rgba);
+
+            struct note *_note = &note_buffer[osc_count];
+
+            if (fillNote(_note, h - 1 - row, prgba[0], prgba[1], prgba[2] * inv_full_brightness, prgba[3] * inv_full_brightness,
+                    rgba[0], rgba[1], rgba[2] * inv_full_brightness, rgba[3] * inv_full_brightness,
+                    inv_full_brightness, samples_count, waves_count, max_density)) {
+                osc_count += 1;
+            }
+        }
+    }
+
+    return osc_count;
+}
 
 // fill the notes buffer for instruments
 // data argument is the raw RGBA values received with the channels count indicated as the first entry
-void fillNotesBuffer(unsigned int samples_count, unsigned int waves_count, unsigned int max_density, 
+// only rows with a non-zero L / R value in the previous or current frame are decoded, the notes buffer does not need to be cleared
+unsigned int fillNotesBuffer(unsigned int samples_count, unsigned int waves_count, unsigned int max_density,
                     unsigned int instruments, unsigned int data_frame_size, struct note *note_buffer,
                     unsigned int h, size_t data_length, void *prev_data, void *data) {
-    FAS_FLOAT pvl = 0, pvr = 0, pl, pr, pb, pa, l, r;
-    unsigned int i, j, frame_data_index = 8;
-    unsigned int li = 0, ri = 1;
-    unsigned int index = 0, note_osc_index = 0, osc_count = 0;
-    FAS_FLOAT volume_l, volume_r, blue, alpha;
-    FAS_FLOAT inv_full_brightness = 1.0 / 255.0;
+    unsigned int j;
+    unsigned int index = 0, osc_count = 0;
+
+    for (j = 0; j < instruments; j += 1) {
+        const unsigned char *pdata = (const unsigned char *)prev_data + FRAME_HEADER_LENGTH + j * data_length;
+        const unsigned char *cdata = (const unsigned char *)data + FRAME_HEADER_LENGTH + j * data_length;
 
-    unsigned int note_i = 0;
+        struct note *notes = &note_buffer[index + 1];
 
-    if (data_frame_size == sizeof(float)) {
-        inv_full_brightness = 1.;
+        if (data_frame_size == sizeof(float)) {
+            osc_count = fillInstrumentNotes(notes, h, pdata, cdata, sizeof(float), fas_lr_pattern_f32, 1., samples_count, waves_count, max_density);
+        } else if (data_frame_size == sizeof(uint16_t)) {
+            osc_count = fillInstrumentNotes(notes, h, pdata, cdata, sizeof(uint16_t), fas_lr_pattern_f16, 1., samples_count, waves_count, max_density);
+        } else {
+            osc_count = fillInstrumentNotes(notes, h, pdata, cdata, sizeof(unsigned char), fas_lr_pattern_u8, 1.0 / 255.0, samples_count, waves_count, max_density);
+        }
+
+        note_buffer[index].osc_index = osc_count;
 
-        frame_data_index = 2;
+        index += osc_count + 1;
 
-        data_length /= data_frame_size;
+#ifdef DEBUG_FRAME_DATA
+    printf("Instrument l/r (stereo) %u : %i oscillators \n", (j + 1), osc_count);
+#endif
     }
 
-    for (j = 0; j < instruments; j += 1) {
-        note_osc_index = index;
-        index += 1;
-        osc_count = 0;
+    return index;
+}
 
-        unsigned int y = h - 1;
+struct _fas_sparse_frame *createSparseFrame(unsigned int h, unsigned int max_instruments) {
+    struct _fas_sparse_frame *frame = (struct _fas_sparse_frame *)calloc(1, sizeof(struct _fas_sparse_frame));
 
-        for (i = 0; i < data_length; i += 4) {
-            if (data_frame_size == sizeof(float)) {
-                float *pdata = (float *)prev_data;
-                float *cdata = (float *)data;
+    if (frame == NULL) {
+        printf("createSparseFrame alloc. error.");
+        fflush(stdout);
+        return NULL;
+    }
 
-                pl = pdata[frame_data_index + li];
-                pr = pdata[frame_data_index + ri];
+    frame->h = h;
+    frame->max_instruments = max_instruments;
 
-                l = cdata[frame_data_index + li];
-                r = cdata[frame_data_index + ri];
+    frame->count = (unsigned int *)calloc(max_instruments, sizeof(unsigned int));
+    frame->rows = (unsigned int *)calloc(h * max_instruments, sizeof(unsigned int));
+    frame->values = (float *)calloc(h * max_instruments * 4, sizeof(float));
 
-                pb = pdata[frame_data_index + 2];
-                pa = pdata[frame_data_index + 3];
+    if (frame->count == NULL || frame->rows == NULL || frame->values == NULL) {
+        printf("createSparseFrame alloc. error.");
+        fflush(stdout);
 
-                blue = cdata[frame_data_index + 2];
-                alpha = cdata[frame_data_index + 3];
-            } else {
-                unsigned char *pdata = (unsigned char *)prev_data;
-                unsigned char *cdata = (unsigned char *)data;
+        return freeSparseFrame(&frame);
+    }
+
+    return frame;
+}
+
+// data argument point to the first instrument runs (after the frame header)
+int validateSparseFrame(unsigned int h, unsigned int instruments, unsigned int data_frame_size, unsigned char *data, size_t data_length) {
+    unsigned int i, j;
+    size_t offset = 0;
 
-                pl = pdata[frame_data_index + li];
-                pr = pdata[frame_data_index + ri];
+    for (j = 0; j < instruments; j += 1) {
+        unsigned int runs = 0, next_row = 0;
+
+        if (offset + sizeof(uint32_t) > data_length) {
+            return -1;
+        }
 
-                l = cdata[frame_data_index + li];
-                r = cdata[frame_data_index + ri];
+        memcpy(&runs, &data[offset], sizeof(uint32_t));
+        offset += sizeof(uint32_t);
 
-                pb = pdata[frame_data_index + 2] * inv_full_brightness;
-                pa = pdata[frame_data_index + 3] * inv_full_brightness;
+        for (i = 0; i < runs; i += 1) {
+            uint32_t run[2];
 
-                blue = cdata[frame_data_index + 2] * inv_full_brightness;
-                alpha = cdata[frame_data_index + 3] * inv_full_brightness;
+            if (offset + sizeof(run) > data_length) {
+                return -1;
             }
 
-            frame_data_index += 4;
+            memcpy(&run, &data[offset], sizeof(run));
+            offset += sizeof(run);
 
-            struct note *_note = &note_buffer[index];
+            unsigned int start = run[0];
+            unsigned int length = run[1];
 
-            if (l > 0 ) {
-                volume_l = l * inv_full_brightness;
-                pvl = pl * inv_full_brightness;
-                _note->previous_volume_l = pvl;
-                _note->volume_l = volume_l;
-                _note->diff_volume_l = volume_l - pvl;
-            } else {
-                if (pl > 0) {
-                    pvl = pl * inv_full_brightness;
-
-                    _note->previous_volume_l = pvl;
-                    _note->diff_volume_l = -pvl;
-                    _note->volume_l = 0;
-                } else {
-                    _note->previous_volume_l = 0;
-                    _note->diff_volume_l = 0;
-                    _note->volume_l = -1;
-
-                    if (r == 0 && pr == 0) {
-                        y -= 1;
-                        continue;
-                    }
-                }
+            // runs must be ordered and fit the bank height
+            if (start < next_row || start > h || length > h - start) {
+                return -1;
+            }
+
+            size_t run_size = (size_t)length * 4 * data_frame_size;
+            if (offset + run_size > data_length) {
+                return -1;
+            }
+
+            offset += run_size;
+
+            next_row = start + length;
+        }
+    }
+
+    return 0;
+}
+
+int decodeSparseFrame(struct _fas_sparse_frame *frame, unsigned int instruments, unsigned int data_frame_size, unsigned char *data, size_t data_length) {
+    unsigned int h = frame->h;
+    unsigned int i, j, k;
+    size_t offset = 0;
+
+    if (instruments > frame->max_instruments) {
+        instruments = frame->max_instruments;
+    }
+
+    memset(frame->count, 0, sizeof(unsigned int) * frame->max_instruments);
+
+    if (validateSparseFrame(h, instruments, data_frame_size, data, data_length) != 0) {
+        return -1;
+    }
+
+    for (j = 0; j < instruments; j += 1) {
+        unsigned int *rows = &frame->rows[j * h];
+        float *values = &frame->values[j * h * 4];
+
+        unsigned int runs = 0, count = 0;
+
+        memcpy(&runs, &data[offset], sizeof(uint32_t));
+        offset += sizeof(uint32_t);
+
+        for (i = 0; i < runs; i += 1) {
+            uint32_t run[2];
+
+            memcpy(&run, &data[offset], sizeof(run));
+            offset += sizeof(run);
+
+            unsigned int start = run[0];
+            unsigned int length = run[1];
+
+            size_t run_size = (size_t)length * 4 * data_frame_size;
+
+            for (k = 0; k < length; k += 1) {
+                rows[count + k] = start + k;
             }
 
-            if (r > 0) {
-                volume_r = r * inv_full_brightness;
-                pvr = pr * inv_full_brightness;
-                _note->previous_volume_r = pvr;
-                _note->volume_r = volume_r;
-                _note->diff_volume_r = volume_r - pvr;
+            if (data_frame_size == sizeof(float)) {
+                memcpy(&values[count * 4], &data[offset], run_size);
+            } else if (data_frame_size == sizeof(uint16_t)) {
+                uint16_t *hdata = (uint16_t *)&data[offset];
+
+                for (k = 0; k < length; k += 1) {
+                    halfToFloat4(&hdata[k * 4], &values[(count + k) * 4]);
+                }
             } else {
-                if (pr > 0) {
-                    pvr = pr * inv_full_brightness;
-
-                    _note->previous_volume_r = pvr;
-                    _note->diff_volume_r = -pvr;
-                    _note->volume_r = 0;
-                } else {
-                    _note->previous_volume_r = 0;
-                    _note->diff_volume_r = 0;
-                    _note->volume_r = -1;
-
-                    if (l == 0 && pl == 0) {
-                        y -= 1;
-                        continue;
-                    }
+                for (k = 0; k < length * 4; k += 1) {
+                    values[count * 4 + k] = data[offset + k];
                 }
             }
 
-            if (_note->volume_l != -1 || _note->volume_r != -1) {
-                _note->osc_index = y;
+            offset += run_size;
 
-                _note->alpha = alpha;
-                _note->palpha = pa;
-                _note->pblue = pb;
-                _note->blue = blue;
+            count += length;
+        }
 
-                _note->density = fabs(round(blue));
+        frame->count[j] = count;
+    }
 
-                _note->norm_density = 1.0f / (_note->density + 0.0000001f);
+    return 0;
+}
 
-                if (_note->density < 1) {
-                    _note->density = 1;
-                }
+// same as fillNotesBuffer but only visit rows which are active in the previous or current frame
+unsigned int fillNotesBufferSparse(unsigned int samples_count, unsigned int waves_count, unsigned int max_density,
+                    unsigned int instruments, unsigned int data_frame_size, struct note *note_buffer,
+                    struct _fas_sparse_frame *prev_frame, struct _fas_sparse_frame *frame) {
+    unsigned int h = frame->h;
+    unsigned int j;
+    unsigned int index = 0, note_osc_index = 0, osc_count = 0;
+    FAS_FLOAT inv_full_brightness = 1.0 / 255.0;
 
-                if (_note->density >= max_density) {
-                    _note->density = 1;
-                }
+    if (data_frame_size == sizeof(float) || data_frame_size == sizeof(uint16_t)) {
+        inv_full_brightness = 1.;
+    }
+
+    if (instruments > frame->max_instruments) {
+        instruments = frame->max_instruments;
+    }
+
+    for (j = 0; j < instruments; j += 1) {
+        note_osc_index = index;
+        index += 1;
+        osc_count = 0;
 
-                double dummy_int_part;
-                double alpha_int_part;
-                double palpha_int_part;
-                FAS_FLOAT blue_frac_part = modf(fabs(blue), &dummy_int_part);
-                FAS_FLOAT pblue_frac_part = modf(fabs(pb), &dummy_int_part);
-                FAS_FLOAT palpha_frac_part = modf(fabs(pa), &palpha_int_part);
-                FAS_FLOAT alpha_frac_part = modf(fabs(alpha), &alpha_int_part);
-
-                // for granular synthesis, samples and related
-                _note->smp_index = blue_frac_part * (samples_count + 1);
-                _note->psmp_index = pblue_frac_part * (samples_count + 1);
-
-                // for wavetable synthesis
-                _note->wav_index = (int)alpha_int_part % (waves_count + 1);
-                _note->pwav_index = (int)palpha_int_part % (waves_count + 1);
-
-                // for subtractive synthesis
-                _note->cutoff = fabs(blue);
-                _note->res = alpha_frac_part;
+        unsigned int *prows = &prev_frame->rows[j * h];
+        unsigned int *crows = &frame->rows[j * h];
+        float *pvalues = &prev_frame->values[j * h * 4];
+        float *cvalues = &frame->values[j * h * 4];
+
+        unsigned int pcount = prev_frame->count[j];
+        unsigned int ccount = frame->count[j];
+        unsigned int pi = 0, ci = 0;
+
+        // both rows lists are ordered; merge them
+        while (pi < pcount || ci < ccount) {
+            unsigned int prow = (pi < pcount) ? prows[pi] : h;
+            unsigned int crow = (ci < ccount) ? crows[ci] : h;
+            unsigned int row = (prow < crow) ? prow : crow;
+
+            FAS_FLOAT pl = 0, pr = 0, pb = 0, pa = 0;
+            FAS_FLOAT l = 0, r = 0, blue = 0, alpha = 0;
+
+            if (prow == row) {
+                float *v = &pvalues[pi * 4];
+
+                pl = v[0];
+                pr = v[1];
+                pb = v[2] * inv_full_brightness;
+                pa = v[3] * inv_full_brightness;
+
+                pi += 1;
+            }
+
+            if (crow == row) {
+                float *v = &cvalues[ci * 4];
+
+                l = v[0];
+                r = v[1];
+                blue = v[2] * inv_full_brightness;
+                alpha = v[3] * inv_full_brightness;
+
+                ci += 1;
             }
 
-            index += 1;
+            struct note *_note = &note_buffer[index];
 
-            osc_count += 1;
+            if (fillNote(_note, h - 1 - row, pl, pr, pb, pa, l, r, blue, alpha, inv_full_brightness, samples_count, waves_count, max_density)) {
+                index += 1;
 
-            y -= 1;
+                osc_count += 1;
+            }
         }
 
         note_buffer[note_osc_index].osc_index = osc_count;
@@ -174,4 +498,23 @@ void fillNotesBuffer(unsigned int samples_count, unsigned int waves_count, unsig
     printf("Instrument l/r (stereo) %u : %i oscillators \n", (j + 1), osc_count);
 #endif
     }
+
+    return index;
+}
+
+struct _fas_sparse_frame *freeSparseFrame(struct _fas_sparse_frame **f) {
+    struct _fas_sparse_frame *frame = *f;
+
+    if (frame == NULL) {
+        return NULL;
+    }
+
+    free(frame->count);
+    free(frame->rows);
+    free(frame->values);
+    free(frame);
+
+    *f = NULL;
+
+    return NULL;
 }
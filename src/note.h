@@ -39,8 +39,43 @@
         unsigned int pwav_index;
     };
 
-    extern void fillNotesBuffer(unsigned int samples_count, unsigned int waves_count, unsigned int max_density,
+    /**
+     * return the amount of notes buffer entries written (instruments notes count entries included)
+     **/
+    extern unsigned int fillNotesBuffer(unsigned int samples_count, unsigned int waves_count, unsigned int max_density,
                                 unsigned int instruments, unsigned int data_frame_size, struct note *note_buffer,
                                 unsigned int h, size_t data_length, void *prev_data, void *data);
 
+    /**
+     * sparse frames (FAS_FRAME_DATA_SPARSE) only carry active rows as runs, per instrument :
+     * uint32 runs count then for each run uint32 first row, uint32 rows count followed by rows count RGBA values
+     * rows are data rows (0 is the top of the slice) and runs must be ordered
+     **/
+    struct _fas_sparse_frame {
+        unsigned int h;
+        unsigned int max_instruments;
+
+        // active rows count, ordered rows index (h per instrument) and their RGBA values (h * 4 per instrument)
+        unsigned int *count;
+        unsigned int *rows;
+        float *values;
+    };
+
+    extern struct _fas_sparse_frame *createSparseFrame(unsigned int h, unsigned int max_instruments);
+    extern struct _fas_sparse_frame *freeSparseFrame(struct _fas_sparse_frame **frame);
+
+    /**
+     * check a sparse frame payload runs (no data conversion); return -1 when the payload is malformed
+     **/
+    extern int validateSparseFrame(unsigned int h, unsigned int instruments, unsigned int data_frame_size, unsigned char *data, size_t data_length);
+
+    /**
+     * decode a sparse frame payload; return -1 when the payload is malformed
+     **/
+    extern int decodeSparseFrame(struct _fas_sparse_frame *frame, unsigned int instruments, unsigned int data_frame_size, unsigned char *data, size_t data_length);
+
+    extern unsigned int fillNotesBufferSparse(unsigned int samples_count, unsigned int waves_count, unsigned int max_density,
+                                unsigned int instruments, unsigned int data_frame_size, struct note *note_buffer,
+                                struct _fas_sparse_frame *prev_frame, struct _fas_sparse_frame *frame);
+
 #endif
@@ -5,127 +5,401 @@
 #include "oscillators.h"
 
 #ifdef WITH_FAUST
-void createFaustGenerators(
+static int createFaustVoice(struct _fas_faust_dsp *fdsp, llvm_dsp_factory *factory, unsigned int sample_rate) {
+    struct _fas_faust_ui_control *uiface = calloc(1, sizeof(struct _fas_faust_ui_control));
+
+    UIGlue *ui = calloc(1, sizeof(UIGlue));
+    if (uiface == NULL || ui == NULL) {
+        free(uiface);
+        free(ui);
+
+        return -1;
+    }
+
+    ui->openTabBox = ui_open_tab_box;
+    ui->openHorizontalBox = ui_open_horizontal_box;
+    ui->openVerticalBox = ui_open_vertical_box;
+    ui->closeBox = ui_close_box;
+    ui->addButton = ui_add_button;
+    ui->addCheckButton = ui_add_check_button;
+    ui->addVerticalSlider = ui_add_vertical_slider;
+    ui->addHorizontalSlider = ui_add_horizontal_slider;
+    ui->addNumEntry = ui_add_num_entry;
+    ui->addHorizontalBargraph = ui_add_horizontal_bargraph;
+    ui->addVerticalBargraph = ui_add_vertical_bargraph;
+    ui->addSoundfile = ui_add_sound_file;
+    ui->declare = ui_declare;
+    ui->uiInterface = uiface;
+
+    llvm_dsp *dsp = createCDSPInstance(factory);
+
+    buildUserInterfaceCDSPInstance(dsp, ui);
+
+    initCDSPInstance(dsp, sample_rate);
+
+    fdsp->controls = uiface;
+    fdsp->ui = ui;
+    fdsp->dsp = dsp;
+
+    resolveFaustZones(fdsp);
+
+    return 0;
+}
+
+struct _fas_faust_voices *createFaustGenerators(
     struct _faust_factories *faust_factories,
-    struct oscillator *osc_bank,
-    unsigned int n,
-    unsigned int sample_rate,
-    unsigned int max_instruments) {
-    if (!osc_bank || faust_factories == NULL) {
-        return;
+    unsigned int polyphony,
+    unsigned int sample_rate) {
+    if (faust_factories == NULL || faust_factories->len == 0 || polyphony == 0) {
+        return NULL;
     }
 
-    unsigned int y = 0, i = 0, k = 0;
+    struct _fas_faust_voices *voices = calloc(1, sizeof(struct _fas_faust_voices));
+    if (voices == NULL) {
+        printf("createFaustGenerators alloc. error.");
+        fflush(stdout);
+        return NULL;
+    }
 
-    int nmo = n - 1;
-    for (y = 0; y < n; y += 1) {
-        int index = nmo - y;
+    unsigned int count = faust_factories->len * polyphony;
 
-        struct oscillator *osc = &osc_bank[index];
+    voices->factories_count = faust_factories->len;
+    voices->polyphony = polyphony;
 
-        osc->faust_gens_len = faust_factories->len;
-        osc->faust_gens = calloc(max_instruments, sizeof(struct _fas_faust_dsp **));
+    voices->voices = calloc(count, sizeof(struct _fas_faust_voice));
+    voices->free_voices = calloc(count, sizeof(unsigned int));
+    voices->free_count = calloc(voices->factories_count, sizeof(unsigned int));
+    voices->inputs = calloc(voices->factories_count, sizeof(int));
 
-        if (osc->faust_gens_len == 0) {
-            continue;
-        }
+    if (voices->voices == NULL || voices->free_voices == NULL || voices->free_count == NULL || voices->inputs == NULL) {
+        printf("createFaustGenerators alloc. error.");
+        fflush(stdout);
 
-        for (i = 0; i < max_instruments; i += 1) {
-            osc->faust_gens[i] = calloc(faust_factories->len, sizeof(struct _fas_faust_dsp *));
-            for (k = 0; k < faust_factories->len; k += 1) {
-                osc->faust_gens[i][k] = calloc(1, sizeof(struct _fas_faust_dsp));
-
-                struct _fas_faust_ui_control *uiface = calloc(1, sizeof(struct _fas_faust_ui_control));
-                
-                UIGlue *ui = calloc(1, sizeof(UIGlue));
-                ui->openTabBox = ui_open_tab_box;
-                ui->openHorizontalBox = ui_open_horizontal_box;
-                ui->openVerticalBox = ui_open_vertical_box;
-                ui->closeBox = ui_close_box;
-                ui->addButton = ui_add_button;
-                ui->addCheckButton = ui_add_check_button;
-                ui->addVerticalSlider = ui_add_vertical_slider;
-                ui->addHorizontalSlider = ui_add_horizontal_slider;
-                ui->addNumEntry = ui_add_num_entry;
-                ui->addHorizontalBargraph = ui_add_horizontal_bargraph;
-                ui->addVerticalBargraph = ui_add_vertical_bargraph;
-                ui->addSoundfile = ui_add_sound_file;
-                ui->declare = ui_declare;
-                ui->uiInterface = uiface;
-                
-                llvm_dsp *dsp = createCDSPInstance(faust_factories->factories[k]);
-
-                buildUserInterfaceCDSPInstance(dsp, ui);
-
-                initCDSPInstance(dsp, sample_rate);
-
-                // initialize on known controls
-                struct _fas_faust_ui_control *tmp;
-                tmp = getFaustControl(uiface, "fs_freq");
-                if (tmp) {
-                    *tmp->zone = osc->freq;
-                }
+        return freeFaustGenerators(&voices);
+    }
 
-                tmp = getFaustControl(uiface, "fs_freq_prev");
-                if (tmp) {
-                    *tmp->zone = osc->prev_freq;
-                }
+    unsigned int f = 0, v = 0;
+    for (f = 0; f < voices->factories_count; f += 1) {
+        for (v = 0; v < polyphony; v += 1) {
+            unsigned int index = f * polyphony + v;
 
-                tmp = getFaustControl(uiface, "fs_freq_next");
-                if (tmp) {
-                    *tmp->zone = osc->next_freq;
-                }
+            struct _fas_faust_voice *voice = &voices->voices[index];
 
-                tmp = getFaustControl(uiface, "fs_bw");
-                if (tmp) {
-                    *tmp->zone = osc->bw[i];
-                }
-                //
+            voice->factory = f;
+            voice->owner = -1;
+
+            if (createFaustVoice(&voice->fdsp, faust_factories->factories[f], sample_rate)) {
+                printf("createFaustGenerators alloc. error.");
+                fflush(stdout);
 
-                osc->faust_gens[i][k]->controls = uiface;
-                osc->faust_gens[i][k]->ui = ui;
-                osc->faust_gens[i][k]->dsp = dsp;
+                return freeFaustGenerators(&voices);
             }
+
+            voices->free_voices[index] = index;
         }
+
+        voices->free_count[f] = polyphony;
+        voices->inputs[f] = getNumInputsCDSPInstance(voices->voices[f * polyphony].fdsp.dsp);
     }
+
+    return voices;
 }
 
-void freeFaustGenerators(
-        struct oscillator **o,
-        unsigned int n,
-        unsigned int max_instruments
-    ) {
-    struct oscillator *oscs = *o;
+static void releaseFaustVoice(struct _fas_faust_voices *voices, unsigned int index) {
+    struct _fas_faust_voice *voice = &voices->voices[index];
 
-    if (oscs == NULL) {
+    if (voice->owner < 0) {
         return;
     }
 
-    unsigned int y = 0, i = 0, k = 0;
-    for (y = 0; y < n; y += 1) {
-        if (oscs[y].faust_gens == NULL) {
-            continue;
+    voices->assigned[voice->owner] = 0;
+    voice->owner = -1;
+
+    voices->free_voices[voice->factory * voices->polyphony + voices->free_count[voice->factory]] = index;
+    voices->free_count[voice->factory] += 1;
+}
+
+int setFaustGeneratorsBank(struct _fas_faust_voices *voices, unsigned int n, unsigned int max_instruments) {
+    if (voices == NULL) {
+        return 0;
+    }
+
+    unsigned int i = 0;
+    if (voices->assigned) {
+        for (i = 0; i < voices->factories_count * voices->polyphony; i += 1) {
+            releaseFaustVoice(voices, i);
         }
 
-        for (i = 0; i < max_instruments; i += 1) {
-            if (oscs[y].faust_gens[i] == NULL) {
-                continue;
-            }
+        free(voices->assigned);
+    }
 
-            for (k = 0; k < oscs[y].faust_gens_len; k += 1) {
-                struct _fas_faust_dsp *fdsp = oscs[y].faust_gens[i][k];
+    voices->rows = n;
+    voices->max_instruments = max_instruments;
 
-                deleteCDSPInstance(fdsp->dsp);
+    voices->assigned = calloc(n * max_instruments, sizeof(unsigned int));
+    if (voices->assigned == NULL) {
+        printf("setFaustGeneratorsBank alloc. error.");
+        fflush(stdout);
+
+        voices->rows = 0;
+
+        return -1;
+    }
+
+    return 0;
+}
+
+struct _fas_faust_dsp *acquireFaustVoice(struct _fas_faust_voices *voices, struct oscillator *osc, unsigned int factory, unsigned int instrument, unsigned int row) {
+    if (voices->assigned == NULL || row >= voices->rows || factory >= voices->factories_count) {
+        return NULL;
+    }
+
+    unsigned int owner = instrument * voices->rows + row;
+    unsigned int v = voices->assigned[owner];
+
+    if (v) {
+        struct _fas_faust_voice *voice = &voices->voices[v - 1];
 
-                freeFaustControls(fdsp->controls);
-                free(fdsp->ui);
+        if (voice->factory == factory) {
+            voice->stamp = voices->stamp;
 
-                free(fdsp);
+            return &voice->fdsp;
+        }
+
+        // generator changed
+        releaseFaustVoice(voices, v - 1);
+    }
+
+    if (voices->free_count[factory] == 0) {
+        return NULL;
+    }
+
+    voices->free_count[factory] -= 1;
+
+    unsigned int index = voices->free_voices[factory * voices->polyphony + voices->free_count[factory]];
+
+    struct _fas_faust_voice *voice = &voices->voices[index];
+    voice->owner = owner;
+    voice->stamp = voices->stamp;
+
+    voices->assigned[owner] = index + 1;
+
+    struct _fas_faust_dsp *fdsp = &voice->fdsp;
+
+    // note-on : previous note state is cleared, controls are initialized for this row
+    instanceClearCDSPInstance(fdsp->dsp);
+
+    setFaustZone(fdsp, FAS_FAUST_ZONE_FREQ, osc->freq);
+    setFaustZone(fdsp, FAS_FAUST_ZONE_FREQ_PREV, osc->prev_freq);
+    setFaustZone(fdsp, FAS_FAUST_ZONE_FREQ_NEXT, osc->next_freq);
+    setFaustZone(fdsp, FAS_FAUST_ZONE_BW, osc->bw);
+
+    return fdsp;
+}
+
+void releaseFaustVoices(struct _fas_faust_voices *voices) {
+    if (voices == NULL) {
+        return;
+    }
+
+    unsigned int i = 0;
+    for (i = 0; i < voices->factories_count * voices->polyphony; i += 1) {
+        struct _fas_faust_voice *voice = &voices->voices[i];
+
+        if (voice->owner >= 0 && voice->stamp != voices->stamp) {
+            releaseFaustVoice(voices, i);
+        }
+    }
+
+    voices->stamp += 1;
+}
+
+struct _fas_faust_voices *freeFaustGenerators(struct _fas_faust_voices **v) {
+    struct _fas_faust_voices *voices = *v;
+
+    if (voices == NULL) {
+        return NULL;
+    }
+
+    unsigned int i = 0;
+    if (voices->voices) {
+        for (i = 0; i < voices->factories_count * voices->polyphony; i += 1) {
+            struct _fas_faust_dsp *fdsp = &voices->voices[i].fdsp;
+
+            if (fdsp->dsp) {
+                deleteCDSPInstance(fdsp->dsp);
             }
 
-            free(oscs[y].faust_gens[i]);
+            freeFaustControls(fdsp->controls);
+            free(fdsp->ui);
+        }
+    }
+
+    free(voices->voices);
+    free(voices->free_voices);
+    free(voices->free_count);
+    free(voices->inputs);
+    free(voices->assigned);
+    free(voices);
+
+    *v = NULL;
+
+    return NULL;
+}
+#endif
+
+#ifdef WITH_SOUNDPIPE
+static void createSoundpipeFilter(sp_data *spd, struct oscillator *osc, void **filters, unsigned int id, FAS_FLOAT freq_limit, unsigned int sample_rate) {
+    if (filters[id]) {
+        return;
+    }
+
+    if (id == SP_MOOG_FILTER) {
+        sp_moogladder_create((sp_moogladder **)&filters[id]);
+        sp_moogladder_init(spd, filters[id]);
+    } else if (id == SP_DIODE_FILTER) {
+        sp_diode_create((sp_diode **)&filters[id]);
+        sp_diode_init(spd, filters[id]);
+    } else if (id == SP_KORG35_FILTER) {
+        sp_wpkorg35_create((sp_wpkorg35 **)&filters[id]);
+        sp_wpkorg35_init(spd, filters[id]);
+    } else if (id == SP_LPF18_FILTER) {
+        sp_lpf18_create((sp_lpf18 **)&filters[id]);
+        sp_lpf18_init(spd, filters[id]);
+    } else if (id == SP_STRES_FILTER_L || id == SP_STRES_FILTER_R) {
+        sp_streson_create((sp_streson **)&filters[id]);
+        sp_streson_init(spd, filters[id]);
+
+        sp_streson *streson = (sp_streson *)filters[id];
+        streson->freq = fmin(osc->freq, freq_limit);
+    } else if (id == SP_FORMANT_FILTER_L || id == SP_FORMANT_FILTER_R) {
+        sp_fofilt_create((sp_fofilt **)&filters[id]);
+        sp_fofilt_init(spd, filters[id]);
+
+        sp_fofilt *fofilt = (sp_fofilt *)filters[id];
+        fofilt->freq = fmin(osc->freq, freq_limit);
+    } else if (id == SP_MODE_FILTER_L || id == SP_MODE_FILTER_R) {
+        sp_mode_create((sp_mode **)&filters[id]);
+        sp_mode_init(spd, filters[id]);
+
+        FAS_FLOAT stabilized_modal_frequency = (sample_rate / osc->freq) < M_PI ? sample_rate / M_PI - 1 : osc->freq;
+
+        sp_mode *mode = (sp_mode *)filters[id];
+        mode->freq = fmin(stabilized_modal_frequency, freq_limit);
+    } else if (id == SP_BANDPASS_FILTER_L || id == SP_BANDPASS_FILTER_R) {
+        sp_butbp_create((sp_butbp **)&filters[id]);
+        sp_butbp_init(spd, filters[id]);
+
+        sp_butbp *bpb = (sp_butbp *)filters[id];
+        bpb->freq = fmin(osc->freq, freq_limit);
+        bpb->bw = osc->bw;
+    }
+}
+
+static void createSoundpipeGenerator(sp_data *spd, struct oscillator *osc, void **gens, unsigned int id, FAS_FLOAT freq_limit) {
+    if (gens[id]) {
+        return;
+    }
+
+    if (id == SP_WHITE_NOISE_GENERATOR) {
+        sp_noise_create((sp_noise **)&gens[id]);
+        sp_noise_init(spd, gens[id]);
+    } else if (id == SP_PINK_NOISE_GENERATOR) {
+        sp_pinknoise_create((sp_pinknoise **)&gens[id]);
+        sp_pinknoise_init(spd, gens[id]);
+    } else if (id == SP_BROWN_NOISE_GENERATOR) {
+        sp_brown_create((sp_brown **)&gens[id]);
+        sp_brown_init(spd, gens[id]);
+    } else if (id == SP_BAR_GENERATOR) {
+        SPFLOAT stiffness = osc->freq * 2.41 / 10;
+        sp_bar_create((sp_bar **)&gens[id]);
+        sp_bar_init(spd, gens[id], stiffness, 0.001f);
+    } else if (id == SP_DRIP_GENERATOR) {
+        sp_drip_create((sp_drip **)&gens[id]);
+        sp_drip_init(spd, gens[id], 0.09f);
+
+        sp_drip *drip = (sp_drip *)gens[id];
+        drip->amp = 1.f;
+        drip->freq = fmin(osc->freq, freq_limit);
+    } else if (id == SP_PD_GENERATOR) {
+        sp_pdhalf_create((sp_pdhalf **)&gens[id]);
+        sp_pdhalf_init(spd, gens[id]);
+    }
+}
+
+static void createSoundpipeModifier(sp_data *spd, struct oscillator *osc, void **mods, unsigned int id) {
+    if (mods[id]) {
+        return;
+    }
+
+    if (id == SP_CRUSH_MODS) {
+        sp_bitcrush_create((sp_bitcrush **)&mods[id]);
+        sp_bitcrush_init(spd, mods[id]);
+    } else if (id == SP_WAVSH_MODS) {
+        sp_dist_create((sp_dist **)&mods[id]);
+        sp_dist_init(spd, mods[id]);
+
+        sp_dist *dist = (sp_dist *)mods[id];
+        dist->pregain = 1.f;
+        dist->postgain = 1.f;
+    } else if (id == SP_FOLD_MODS) {
+        sp_fold_create((sp_fold **)&mods[id]);
+        sp_fold_init(spd, mods[id]);
+    }
+}
+
+void createOscillatorsSoundpipe(sp_data *spd, struct oscillator *osc_bank, unsigned int n, unsigned int instrument, int synthesis_method, unsigned int sample_rate) {
+    if (osc_bank == NULL) {
+        return;
+    }
+
+    FAS_FLOAT freq_limit = sample_rate / 2 * FAS_FREQ_LIMIT_FACTOR;
+
+    unsigned int y = 0;
+    for (y = 0; y < n; y += 1) {
+        struct oscillator *osc = &osc_bank[y];
+
+        void **filters = osc->sp_filters[instrument];
+        void **gens = osc->sp_gens[instrument];
+        void **mods = osc->sp_mods[instrument];
+
+        if (synthesis_method == FAS_ADDITIVE) {
+#ifdef PARTIAL_FX
+            // convolution partials use the convolvers pool (see convolver.h)
+            createSoundpipeModifier(spd, osc, mods, SP_CRUSH_MODS);
+            createSoundpipeModifier(spd, osc, mods, SP_WAVSH_MODS);
+            createSoundpipeModifier(spd, osc, mods, SP_FOLD_MODS);
+            createSoundpipeGenerator(spd, osc, gens, SP_PD_GENERATOR, freq_limit);
+#endif
+        } else if (synthesis_method == FAS_SUBTRACTIVE) {
+            createSoundpipeGenerator(spd, osc, gens, SP_WHITE_NOISE_GENERATOR, freq_limit);
+            createSoundpipeGenerator(spd, osc, gens, SP_PINK_NOISE_GENERATOR, freq_limit);
+            createSoundpipeGenerator(spd, osc, gens, SP_BROWN_NOISE_GENERATOR, freq_limit);
+            createSoundpipeFilter(spd, osc, filters, SP_MOOG_FILTER, freq_limit, sample_rate);
+            createSoundpipeFilter(spd, osc, filters, SP_DIODE_FILTER, freq_limit, sample_rate);
+            createSoundpipeFilter(spd, osc, filters, SP_KORG35_FILTER, freq_limit, sample_rate);
+            createSoundpipeFilter(spd, osc, filters, SP_LPF18_FILTER, freq_limit, sample_rate);
+        } else if (synthesis_method == FAS_PHYSICAL_MODELLING) {
+            // Karplus-Strong excitation is filtered noise
+            createSoundpipeGenerator(spd, osc, gens, SP_WHITE_NOISE_GENERATOR, freq_limit);
+            createSoundpipeFilter(spd, osc, filters, SP_STRES_FILTER_L, freq_limit, sample_rate);
+            createSoundpipeGenerator(spd, osc, gens, SP_DRIP_GENERATOR, freq_limit);
+            createSoundpipeGenerator(spd, osc, gens, SP_BAR_GENERATOR, freq_limit);
+        } else if (synthesis_method == FAS_BANDPASS) {
+            createSoundpipeFilter(spd, osc, filters, SP_BANDPASS_FILTER_L, freq_limit, sample_rate);
+            createSoundpipeFilter(spd, osc, filters, SP_BANDPASS_FILTER_R, freq_limit, sample_rate);
+        } else if (synthesis_method == FAS_FORMANT_SYNTH) {
+            createSoundpipeFilter(spd, osc, filters, SP_FORMANT_FILTER_L, freq_limit, sample_rate);
+            createSoundpipeFilter(spd, osc, filters, SP_FORMANT_FILTER_R, freq_limit, sample_rate);
+        } else if (synthesis_method == FAS_STRING_RESON) {
+            createSoundpipeFilter(spd, osc, filters, SP_STRES_FILTER_L, freq_limit, sample_rate);
+            createSoundpipeFilter(spd, osc, filters, SP_STRES_FILTER_R, freq_limit, sample_rate);
+        } else if (synthesis_method == FAS_MODAL_SYNTH) {
+            createSoundpipeFilter(spd, osc, filters, SP_MODE_FILTER_L, freq_limit, sample_rate);
+            createSoundpipeFilter(spd, osc, filters, SP_MODE_FILTER_R, freq_limit, sample_rate);
+        } else if (synthesis_method == FAS_PHASE_DISTORSION) {
+            createSoundpipeGenerator(spd, osc, gens, SP_PD_GENERATOR, freq_limit);
         }
-        free(oscs[y].faust_gens);
     }
 }
 #endif
@@ -160,10 +434,10 @@ struct oscillator *createOscillatorsBank(
     FAS_FLOAT phase_step;
     int nmo = n - 1;
 
-    FAS_FLOAT nyquist_limit = sample_rate / 2;
-
     FAS_FLOAT max_frequency = base_frequency * pow(2.0, nmo / octave_length);
 
+    unsigned int buffer_offset = 0;
+
     for (y = 0; y < n; y += 1) {
         index = nmo - y;
 
@@ -179,181 +453,31 @@ struct oscillator *createOscillatorsBank(
         osc->prev_freq = frequency_prev;
         osc->next_freq = frequency_next;
 
-        osc->phase_index = malloc(sizeof(FAS_FLOAT) * max_instruments);
-        osc->phase_index2 = malloc(sizeof(FAS_FLOAT) * max_instruments);
-
 #ifdef MAGIC_CIRCLE
         osc->mc_eps = 2. * sin(2. * 3.141592653589 * (frequency / (FAS_FLOAT)sample_rate) / 2.);
-        osc->mc_x = malloc(sizeof(FAS_FLOAT) * max_instruments);
-        osc->mc_y = malloc(sizeof(FAS_FLOAT) * max_instruments);
 #endif
 
-        osc->fphase = malloc(sizeof(FAS_FLOAT) * max_instruments);
-
-        // ==
-        osc->fp1 = malloc(sizeof(FAS_FLOAT *) * max_instruments);
-        osc->fp2 = malloc(sizeof(FAS_FLOAT *) * max_instruments);
-        osc->fp3 = malloc(sizeof(FAS_FLOAT *) * max_instruments);
-        osc->fp4 = malloc(sizeof(FAS_FLOAT *) * max_instruments);
-
-        osc->wav1 = malloc(sizeof(FAS_FLOAT *) * max_instruments);
-        osc->wav2 = malloc(sizeof(FAS_FLOAT *) * max_instruments);
-
-        osc->triggered = calloc(max_instruments, sizeof(unsigned int));
-
         osc->buffer_len = (FAS_FLOAT)sample_rate / frequency;
-        osc->buffer = malloc(sizeof(FAS_FLOAT) * osc->buffer_len * max_instruments);
-
-        osc->noise_index = malloc(sizeof(uint16_t) * max_instruments);
+        osc->buffer_offset = buffer_offset;
 
-        osc->pvalue = malloc(sizeof(FAS_FLOAT) * max_instruments);
+        buffer_offset += osc->buffer_len;
 
-        osc->bw = malloc(sizeof(FAS_FLOAT) * max_instruments);
+        osc->bw = (fabs(frequency - frequency_prev) + fabs(frequency - frequency_next));
 
 #ifdef WITH_SOUNDPIPE
         osc->sp_filters = malloc(sizeof(void **) * max_instruments);
         osc->sp_mods = malloc(sizeof(void **) * max_instruments);
         osc->sp_gens = malloc(sizeof(void **) * max_instruments);
-
-        sp_ftbl_create(spd, (sp_ftbl **)&osc->ft_void, 1);
-#endif
-
-        for (i = 0; i < max_instruments; i += 1) {
-            osc->phase_index[i] = rand() / (FAS_FLOAT)RAND_MAX * wavetable_size;
-            osc->noise_index[i] = rand() / (FAS_FLOAT)RAND_MAX * 65536;
-            osc->pvalue[i] = 0;
-
-#ifdef MAGIC_CIRCLE
-            osc->mc_x[i] = 1;
-            osc->mc_y[i] = 0;
 #endif
 
-            osc->bw[i] = (fabs(frequency - frequency_prev) + fabs(frequency - frequency_next));
-
 #ifdef WITH_SOUNDPIPE
-            // Soundpipe filters
-            osc->sp_filters[i] = malloc(sizeof(void *) * (SP_OSC_FILTERS + 2)); // + 2 : adjust for stereo filters / gens (formant / modal)
-
-            sp_moogladder_create((sp_moogladder **)&osc->sp_filters[i][SP_MOOG_FILTER]);
-            sp_moogladder_init(spd, osc->sp_filters[i][SP_MOOG_FILTER]);
-
-            sp_diode_create((sp_diode **)&osc->sp_filters[i][SP_DIODE_FILTER]);
-            sp_diode_init(spd, osc->sp_filters[i][SP_DIODE_FILTER]);
-
-            sp_wpkorg35_create((sp_wpkorg35 **)&osc->sp_filters[i][SP_KORG35_FILTER]);
-            sp_wpkorg35_init(spd, osc->sp_filters[i][SP_KORG35_FILTER]);
-
-            sp_streson_create((sp_streson **)&osc->sp_filters[i][SP_STRES_FILTER_L]);
-            sp_streson_init(spd, osc->sp_filters[i][SP_STRES_FILTER_L]);
-
-            sp_streson_create((sp_streson **)&osc->sp_filters[i][SP_STRES_FILTER_R]);
-            sp_streson_init(spd, osc->sp_filters[i][SP_STRES_FILTER_R]);
-
-            sp_streson *streson_l = (sp_streson *)osc->sp_filters[i][SP_STRES_FILTER_L];
-            streson_l->freq = fmin(frequency, nyquist_limit * FAS_FREQ_LIMIT_FACTOR);
-
-            sp_streson *streson_r = (sp_streson *)osc->sp_filters[i][SP_STRES_FILTER_R];
-            streson_r->freq = fmin(frequency, nyquist_limit * FAS_FREQ_LIMIT_FACTOR);
-
-            sp_lpf18_create((sp_lpf18 **)&osc->sp_filters[i][SP_LPF18_FILTER]);
-            sp_lpf18_init(spd, osc->sp_filters[i][SP_LPF18_FILTER]);
-
-            sp_fofilt_create((sp_fofilt **)&osc->sp_filters[i][SP_FORMANT_FILTER_L]);
-            sp_fofilt_init(spd, osc->sp_filters[i][SP_FORMANT_FILTER_L]);
-
-            sp_fofilt_create((sp_fofilt **)&osc->sp_filters[i][SP_FORMANT_FILTER_R]);
-            sp_fofilt_init(spd, osc->sp_filters[i][SP_FORMANT_FILTER_R]);
-
-            sp_fofilt *fofilt_l = (sp_fofilt *)osc->sp_filters[i][SP_FORMANT_FILTER_L];
-            fofilt_l->freq = fmin(frequency, nyquist_limit * FAS_FREQ_LIMIT_FACTOR);
-
-            sp_fofilt *fofilt_r = (sp_fofilt *)osc->sp_filters[i][SP_FORMANT_FILTER_R];
-            fofilt_r->freq = fmin(frequency, nyquist_limit * FAS_FREQ_LIMIT_FACTOR);
-
-            sp_mode_create((sp_mode **)&osc->sp_filters[i][SP_MODE_FILTER_L]);
-            sp_mode_init(spd, osc->sp_filters[i][SP_MODE_FILTER_L]);
-
-            sp_mode_create((sp_mode **)&osc->sp_filters[i][SP_MODE_FILTER_R]);
-            sp_mode_init(spd, osc->sp_filters[i][SP_MODE_FILTER_R]);
-
-            FAS_FLOAT stabilized_modal_frequency = (sample_rate / frequency) < M_PI ? sample_rate / M_PI - 1 : frequency;
-
-            sp_mode *mode_l = (sp_mode *)osc->sp_filters[i][SP_MODE_FILTER_L];
-            mode_l->freq = fmin(stabilized_modal_frequency, nyquist_limit * FAS_FREQ_LIMIT_FACTOR);
-
-            sp_mode *mode_r = (sp_mode *)osc->sp_filters[i][SP_MODE_FILTER_R];
-            mode_r->freq = fmin(stabilized_modal_frequency, nyquist_limit * FAS_FREQ_LIMIT_FACTOR);
-
-            sp_butbp_create((sp_butbp **)&osc->sp_filters[i][SP_BANDPASS_FILTER_L]);
-            sp_butbp_init(spd, osc->sp_filters[i][SP_BANDPASS_FILTER_L]);
-
-            sp_butbp_create((sp_butbp **)&osc->sp_filters[i][SP_BANDPASS_FILTER_R]);
-            sp_butbp_init(spd, osc->sp_filters[i][SP_BANDPASS_FILTER_R]);
-
-            sp_butbp *bpb_l = (sp_butbp *)osc->sp_filters[i][SP_BANDPASS_FILTER_L];
-            bpb_l->freq = fmin(frequency, nyquist_limit * FAS_FREQ_LIMIT_FACTOR);
-            bpb_l->bw = osc->bw[i];
-
-            sp_butbp *bpb_r = (sp_butbp *)osc->sp_filters[i][SP_BANDPASS_FILTER_R];
-            bpb_r->freq = fmin(frequency, nyquist_limit * FAS_FREQ_LIMIT_FACTOR);
-            bpb_r->bw = osc->bw[i];
-
-            // Soundpipe generator
-            osc->sp_gens[i] = malloc(sizeof(void *) * SP_OSC_GENS);
-
-            sp_noise_create((sp_noise **)&osc->sp_gens[i][SP_WHITE_NOISE_GENERATOR]);
-            sp_noise_init(spd, osc->sp_gens[i][SP_WHITE_NOISE_GENERATOR]);
-
-            sp_pinknoise_create((sp_pinknoise **)&osc->sp_gens[i][SP_PINK_NOISE_GENERATOR]);
-            sp_pinknoise_init(spd, osc->sp_gens[i][SP_PINK_NOISE_GENERATOR]);
-
-            sp_brown_create((sp_brown **)&osc->sp_gens[i][SP_BROWN_NOISE_GENERATOR]);
-            sp_brown_init(spd, osc->sp_gens[i][SP_BROWN_NOISE_GENERATOR]);
-
-            SPFLOAT stiffness = frequency * 2.41 / 10;
-            sp_bar_create((sp_bar **)&osc->sp_gens[i][SP_BAR_GENERATOR]);
-            sp_bar_init(spd, osc->sp_gens[i][SP_BAR_GENERATOR], stiffness, 0.001f);
-
-            sp_drip_create((sp_drip **)&osc->sp_gens[i][SP_DRIP_GENERATOR]);
-            sp_drip_init(spd, osc->sp_gens[i][SP_DRIP_GENERATOR], 0.09f);
-
-            sp_drip *drip = (sp_drip *)osc->sp_gens[i][SP_DRIP_GENERATOR];
-            drip->amp = 1.f;
-            drip->freq = fmin(frequency, nyquist_limit * FAS_FREQ_LIMIT_FACTOR);
-
-            sp_pdhalf_create((sp_pdhalf **)&osc->sp_gens[i][SP_PD_GENERATOR]);
-            sp_pdhalf_init(spd, osc->sp_gens[i][SP_PD_GENERATOR]);
-
-            // Soundpipe modifiers (generic effects)
-            osc->sp_mods[i] = malloc(sizeof(void *) * SP_OSC_MODS);
-
-            sp_bitcrush_create((sp_bitcrush **)&osc->sp_mods[i][SP_CRUSH_MODS]);
-            sp_bitcrush_init(spd, osc->sp_mods[i][SP_CRUSH_MODS]);
-
-            sp_dist_create((sp_dist **)&osc->sp_mods[i][SP_WAVSH_MODS]);
-            sp_dist_init(spd, osc->sp_mods[i][SP_WAVSH_MODS]);
-
-            sp_dist *dist = (sp_dist *)osc->sp_mods[i][SP_WAVSH_MODS];
-            dist->pregain = 1.f;
-            dist->postgain = 1.f;
-
-            sp_fold_create((sp_fold **)&osc->sp_mods[i][SP_FOLD_MODS]);
-            sp_fold_init(spd, osc->sp_mods[i][SP_FOLD_MODS]);
-
-            sp_conv_create((sp_conv **)&osc->sp_mods[i][SP_CONV_MODS]);
-            sp_conv_init(spd, osc->sp_mods[i][SP_CONV_MODS], osc->ft_void, 2048);  
-#endif
-
-            // == PM
-            osc->phase_index2[i] = rand() / (FAS_FLOAT)RAND_MAX * wavetable_size;
-
-            osc->fphase[i] = 0;
-
-            osc->fp1[i] = calloc(6, sizeof(FAS_FLOAT));
-            osc->fp2[i] = calloc(6, sizeof(FAS_FLOAT));
-            osc->fp3[i] = calloc(6, sizeof(FAS_FLOAT));
-            osc->fp4[i] = calloc(6, sizeof(FAS_FLOAT));
+        // Soundpipe objects are created on demand (see createOscillatorsSoundpipe)
+        for (i = 0; i < max_instruments; i += 1) {
+            osc->sp_filters[i] = calloc(SP_OSC_FILTERS + 2, sizeof(void *)); // + 2 : adjust for stereo filters / gens (formant / modal)
+            osc->sp_gens[i] = calloc(SP_OSC_GENS, sizeof(void *));
+            osc->sp_mods[i] = calloc(SP_OSC_MODS, sizeof(void *));
         }
+#endif
 
         osc->phase_step = phase_step;
         osc->phase_increment = phase_increment;
@@ -386,8 +510,9 @@ struct oscillator *updateOscillatorBank(
         struct oscillator *osc = &oscs[n - 1 - y];
         for (i = 0; i < max_instruments; i += 1) {
 #ifdef WITH_SOUNDPIPE
-            if (target == 0) {
-                sp_drip_destroy((sp_drip **)&oscs[y].sp_gens[i][SP_DRIP_GENERATOR]);
+            // only objects of physical modelling instruments are allocated
+            if (target == 0 && osc->sp_gens[i][SP_DRIP_GENERATOR]) {
+                sp_drip_destroy((sp_drip **)&osc->sp_gens[i][SP_DRIP_GENERATOR]);
 
                 sp_drip_create((sp_drip **)&osc->sp_gens[i][SP_DRIP_GENERATOR]);
                 sp_drip_init(spd, osc->sp_gens[i][SP_DRIP_GENERATOR], value1);
@@ -395,8 +520,8 @@ struct oscillator *updateOscillatorBank(
                 sp_drip *drip = (sp_drip *)osc->sp_gens[i][SP_DRIP_GENERATOR];
                 drip->amp = 1.f;
                 drip->freq = fmin(osc->freq, nyquist_limit * FAS_FREQ_LIMIT_FACTOR);
-            } else if (target == 1) {
-                sp_bar_destroy((sp_bar **)&oscs[y].sp_gens[i][SP_BAR_GENERATOR]);
+            } else if (target == 1 && osc->sp_gens[i][SP_BAR_GENERATOR]) {
+                sp_bar_destroy((sp_bar **)&osc->sp_gens[i][SP_BAR_GENERATOR]);
 
                 SPFLOAT stiffness;
                 SPFLOAT imsec = 2.41;
@@ -434,87 +559,167 @@ struct oscillator *freeOscillatorsBank(struct oscillator **o, unsigned int n, un
         return NULL;
     }
 
-#ifdef WITH_FAUST
-    freeFaustGenerators(o, n, max_instruments);
-#endif
-
     unsigned int y = 0, i = 0, k = 0, j = 0;
     for (y = 0; y < n; y += 1) {
-        free(oscs[y].phase_index);
-        free(oscs[y].fphase);
-        free(oscs[y].noise_index);
-        free(oscs[y].pvalue);
-        free(oscs[y].buffer);
+#ifdef WITH_SOUNDPIPE
+        for (i = 0; i < max_instruments; i += 1) {
+            void **filters = oscs[y].sp_filters[i];
+            void **gens = oscs[y].sp_gens[i];
+            void **mods = oscs[y].sp_mods[i];
+
+            // objects are only allocated for the synthesis methods used by this instrument
+            if (filters[SP_MOOG_FILTER]) sp_moogladder_destroy((sp_moogladder **)&filters[SP_MOOG_FILTER]);
+            if (filters[SP_DIODE_FILTER]) sp_diode_destroy((sp_diode **)&filters[SP_DIODE_FILTER]);
+            if (filters[SP_KORG35_FILTER]) sp_wpkorg35_destroy((sp_wpkorg35 **)&filters[SP_KORG35_FILTER]);
+            if (filters[SP_STRES_FILTER_L]) sp_streson_destroy((sp_streson **)&filters[SP_STRES_FILTER_L]);
+            if (filters[SP_STRES_FILTER_R]) sp_streson_destroy((sp_streson **)&filters[SP_STRES_FILTER_R]);
+            if (filters[SP_LPF18_FILTER]) sp_lpf18_destroy((sp_lpf18 **)&filters[SP_LPF18_FILTER]);
+            if (filters[SP_FORMANT_FILTER_L]) sp_fofilt_destroy((sp_fofilt **)&filters[SP_FORMANT_FILTER_L]);
+            if (filters[SP_FORMANT_FILTER_R]) sp_fofilt_destroy((sp_fofilt **)&filters[SP_FORMANT_FILTER_R]);
+            if (filters[SP_MODE_FILTER_L]) sp_mode_destroy((sp_mode **)&filters[SP_MODE_FILTER_L]);
+            if (filters[SP_MODE_FILTER_R]) sp_mode_destroy((sp_mode **)&filters[SP_MODE_FILTER_R]);
+            if (filters[SP_BANDPASS_FILTER_L]) sp_butbp_destroy((sp_butbp **)&filters[SP_BANDPASS_FILTER_L]);
+            if (filters[SP_BANDPASS_FILTER_R]) sp_butbp_destroy((sp_butbp **)&filters[SP_BANDPASS_FILTER_R]);
+
+            free(filters);
+
+            if (gens[SP_WHITE_NOISE_GENERATOR]) sp_noise_destroy((sp_noise **)&gens[SP_WHITE_NOISE_GENERATOR]);
+            if (gens[SP_PINK_NOISE_GENERATOR]) sp_pinknoise_destroy((sp_pinknoise **)&gens[SP_PINK_NOISE_GENERATOR]);
+            if (gens[SP_BROWN_NOISE_GENERATOR]) sp_brown_destroy((sp_brown **)&gens[SP_BROWN_NOISE_GENERATOR]);
+            if (gens[SP_BAR_GENERATOR]) sp_bar_destroy((sp_bar **)&gens[SP_BAR_GENERATOR]);
+            if (gens[SP_DRIP_GENERATOR]) sp_drip_destroy((sp_drip **)&gens[SP_DRIP_GENERATOR]);
+            if (gens[SP_PD_GENERATOR]) sp_pdhalf_destroy((sp_pdhalf **)&gens[SP_PD_GENERATOR]);
+
+            free(gens);
+
+            if (mods[SP_CRUSH_MODS]) sp_bitcrush_destroy((sp_bitcrush **)&mods[SP_CRUSH_MODS]);
+            if (mods[SP_WAVSH_MODS]) sp_dist_destroy((sp_dist **)&mods[SP_WAVSH_MODS]);
+            if (mods[SP_FOLD_MODS]) sp_fold_destroy((sp_fold **)&mods[SP_FOLD_MODS]);
+
+            free(mods);
+        }
+
+        free(oscs[y].sp_filters);
+        free(oscs[y].sp_gens);
+        free(oscs[y].sp_mods);
+#endif
+    }
+
+    free(oscs);
+
+    return NULL;
+}
+
+// reserve a cache line aligned field of size bytes in a slab and return its offset
+static size_t slabField(size_t *slab_size, size_t size) {
+    size_t offset = *slab_size;
+
+    *slab_size += ((size + FAS_CACHE_LINE_SIZE - 1) / FAS_CACHE_LINE_SIZE) * FAS_CACHE_LINE_SIZE;
+
+    return offset;
+}
+
+struct oscillators_state *createOscillatorsState(struct oscillator *osc_bank, unsigned int n, unsigned int wavetable_size, unsigned int max_instruments) {
+    if (osc_bank == NULL) {
+        return NULL;
+    }
+
+    struct oscillators_state *states = (struct oscillators_state *)calloc(max_instruments, sizeof(struct oscillators_state));
+
+    if (states == NULL) {
+        printf("createOscillatorsState alloc. error.");
+        fflush(stdout);
+        return NULL;
+    }
 
-        free(oscs[y].triggered);
+    unsigned int y = 0, k = 0;
 
-        free(oscs[y].phase_index2);
+    size_t buffer_len = 0;
+    for (y = 0; y < n; y += 1) {
+        buffer_len += osc_bank[y].buffer_len;
+    }
 
+    // slab layout (same for all instruments)
+    size_t slab_size = 0;
+    size_t fp1_offset = slabField(&slab_size, sizeof(FAS_FLOAT) * FAS_OSC_PARAMS * n);
+    size_t fp2_offset = slabField(&slab_size, sizeof(FAS_FLOAT) * FAS_OSC_PARAMS * n);
+    size_t fp3_offset = slabField(&slab_size, sizeof(FAS_FLOAT) * FAS_OSC_PARAMS * n);
+    size_t fp4_offset = slabField(&slab_size, sizeof(FAS_FLOAT) * FAS_OSC_PARAMS * n);
 #ifdef MAGIC_CIRCLE
-        free(oscs[y].mc_x);
-        free(oscs[y].mc_y);
+    size_t mc_x_offset = slabField(&slab_size, sizeof(FAS_FLOAT) * n);
+    size_t mc_y_offset = slabField(&slab_size, sizeof(FAS_FLOAT) * n);
 #endif
+    size_t phase_index_offset = slabField(&slab_size, sizeof(FAS_FLOAT) * n);
+    size_t phase_index2_offset = slabField(&slab_size, sizeof(FAS_FLOAT) * n);
+    size_t fphase_offset = slabField(&slab_size, sizeof(FAS_FLOAT) * n);
+    size_t pvalue_offset = slabField(&slab_size, sizeof(FAS_FLOAT) * n);
+    size_t wav1_offset = slabField(&slab_size, sizeof(FAS_FLOAT *) * n);
+    size_t wav2_offset = slabField(&slab_size, sizeof(FAS_FLOAT *) * n);
+    size_t triggered_offset = slabField(&slab_size, sizeof(unsigned int) * n);
+    size_t noise_index_offset = slabField(&slab_size, sizeof(uint16_t) * n);
+    size_t buffer_offset = slabField(&slab_size, sizeof(FAS_FLOAT) * buffer_len);
+
+    for (k = 0; k < max_instruments; k += 1) {
+        struct oscillators_state *state = &states[k];
+
+        char *slab = (char *)alignedCalloc(FAS_CACHE_LINE_SIZE, slab_size);
+        if (slab == NULL) {
+            printf("createOscillatorsState slab alloc. error.");
+            fflush(stdout);
+
+            return freeOscillatorsState(&states, max_instruments);
+        }
 
-        free(oscs[y].bw);
+        state->slab = slab;
 
-        for (i = 0; i < max_instruments; i += 1) {
-            free(oscs[y].fp1[i]);
-            free(oscs[y].fp2[i]);
-            free(oscs[y].fp3[i]);
-            free(oscs[y].fp4[i]);
+        state->fp1 = (FAS_FLOAT (*)[FAS_OSC_PARAMS])&slab[fp1_offset];
+        state->fp2 = (FAS_FLOAT (*)[FAS_OSC_PARAMS])&slab[fp2_offset];
+        state->fp3 = (FAS_FLOAT (*)[FAS_OSC_PARAMS])&slab[fp3_offset];
+        state->fp4 = (FAS_FLOAT (*)[FAS_OSC_PARAMS])&slab[fp4_offset];
+#ifdef MAGIC_CIRCLE
+        state->mc_x = (FAS_FLOAT *)&slab[mc_x_offset];
+        state->mc_y = (FAS_FLOAT *)&slab[mc_y_offset];
+#endif
+        state->phase_index = (FAS_FLOAT *)&slab[phase_index_offset];
+        state->phase_index2 = (FAS_FLOAT *)&slab[phase_index2_offset];
+        state->fphase = (FAS_FLOAT *)&slab[fphase_offset];
+        state->pvalue = (FAS_FLOAT *)&slab[pvalue_offset];
+        state->wav1 = (FAS_FLOAT **)&slab[wav1_offset];
+        state->wav2 = (FAS_FLOAT **)&slab[wav2_offset];
+        state->triggered = (unsigned int *)&slab[triggered_offset];
+        state->noise_index = (uint16_t *)&slab[noise_index_offset];
+        state->buffer = (FAS_FLOAT *)&slab[buffer_offset];
+
+        for (y = 0; y < n; y += 1) {
+            state->phase_index[y] = randf(0, wavetable_size);
+            state->phase_index2[y] = randf(0, wavetable_size);
+            state->noise_index[y] = fasRand() >> 16;
 
-#ifdef WITH_SOUNDPIPE
-            sp_moogladder_destroy((sp_moogladder **)&oscs[y].sp_filters[i][SP_MOOG_FILTER]);
-            sp_diode_destroy((sp_diode **)&oscs[y].sp_filters[i][SP_DIODE_FILTER]);
-            sp_wpkorg35_destroy((sp_wpkorg35 **)&oscs[y].sp_filters[i][SP_KORG35_FILTER]);
-            sp_streson_destroy((sp_streson **)&oscs[y].sp_filters[i][SP_STRES_FILTER_L]);
-            sp_streson_destroy((sp_streson **)&oscs[y].sp_filters[i][SP_STRES_FILTER_R]);
-            sp_lpf18_destroy((sp_lpf18 **)&oscs[y].sp_filters[i][SP_LPF18_FILTER]);
-            sp_fofilt_destroy((sp_fofilt **)&oscs[y].sp_filters[i][SP_FORMANT_FILTER_L]);
-            sp_fofilt_destroy((sp_fofilt **)&oscs[y].sp_filters[i][SP_FORMANT_FILTER_R]);
-            sp_mode_destroy((sp_mode **)&oscs[y].sp_filters[i][SP_MODE_FILTER_L]);
-            sp_mode_destroy((sp_mode **)&oscs[y].sp_filters[i][SP_MODE_FILTER_R]);
-            sp_butbp_destroy((sp_butbp **)&oscs[y].sp_filters[i][SP_BANDPASS_FILTER_L]);
-            sp_butbp_destroy((sp_butbp **)&oscs[y].sp_filters[i][SP_BANDPASS_FILTER_R]);
-
-            free(oscs[y].sp_filters[i]);
-
-            sp_noise_destroy((sp_noise **)&oscs[y].sp_gens[i][SP_WHITE_NOISE_GENERATOR]);
-            sp_pinknoise_destroy((sp_pinknoise **)&oscs[y].sp_gens[i][SP_PINK_NOISE_GENERATOR]);
-            sp_brown_destroy((sp_brown **)&oscs[y].sp_gens[i][SP_BROWN_NOISE_GENERATOR]);
-            sp_bar_destroy((sp_bar **)&oscs[y].sp_gens[i][SP_BAR_GENERATOR]);
-            sp_drip_destroy((sp_drip **)&oscs[y].sp_gens[i][SP_DRIP_GENERATOR]);
-            sp_pdhalf_destroy((sp_pdhalf **)&oscs[y].sp_gens[i][SP_PD_GENERATOR]);
-            
-            free(oscs[y].sp_gens[i]);
-
-            sp_bitcrush_destroy((sp_bitcrush **)&oscs[y].sp_mods[i][SP_CRUSH_MODS]);
-            sp_dist_destroy((sp_dist **)&oscs[y].sp_mods[i][SP_WAVSH_MODS]);
-            sp_fold_destroy((sp_fold **)&oscs[y].sp_mods[i][SP_FOLD_MODS]);
-            sp_conv_destroy((sp_conv **)&oscs[y].sp_mods[i][SP_CONV_MODS]);
-
-            free(oscs[y].sp_mods[i]);
+#ifdef MAGIC_CIRCLE
+            state->mc_x[y] = 1;
+            state->mc_y[y] = 0;
 #endif
         }
+    }
 
-        free(oscs[y].fp1);
-        free(oscs[y].fp2);
-        free(oscs[y].fp3);
-        free(oscs[y].fp4);
+    return states;
+}
 
-        free(oscs[y].wav1);
-        free(oscs[y].wav2);
+struct oscillators_state *freeOscillatorsState(struct oscillators_state **s, unsigned int max_instruments) {
+    struct oscillators_state *states = *s;
 
-#ifdef WITH_SOUNDPIPE
-        sp_ftbl_destroy((sp_ftbl **)&oscs[y].ft_void);
+    if (states == NULL) {
+        return NULL;
+    }
 
-        free(oscs[y].sp_filters);
-        free(oscs[y].sp_gens);
-        free(oscs[y].sp_mods);
-#endif
+    unsigned int k = 0;
+    for (k = 0; k < max_instruments; k += 1) {
+        alignedFree(states[k].slab);
     }
 
-    free(oscs);
+    free(states);
+
+    *s = NULL;
 
     return NULL;
 }
@@ -22,21 +22,49 @@
         FAS_FLOAT next_freq;
 
         // bandwidth Hz
-        FAS_FLOAT *bw;
-
-        // generic parameters storage (initially used for filter parameters)
-        FAS_FLOAT **fp1, **fp2, **fp3, **fp4;
+        FAS_FLOAT bw;
 
         // MCF recursive algorithm for sinewave oscillator
 #ifdef MAGIC_CIRCLE
         FAS_FLOAT mc_eps;
+#endif
+
+        // wavetable related oscillator
+        FAS_FLOAT phase_step;
+
+        // floating-point phase increment (for PolyBLEP subtractive waveforms / physical modelling)
+        FAS_FLOAT phase_increment;
+
+        // for physical modelling (Karplus-Strong state table length and position in the instrument state buffer)
+        unsigned int buffer_len;
+        unsigned int buffer_offset;
+
+        // Soundpipe generators/modifiers/filters
+#ifdef WITH_SOUNDPIPE
+        void ***sp_filters;
+        void ***sp_gens;
+        void ***sp_mods;
+#endif
+    };
+
+    /**
+     * oscillators state of an instrument, all fields are indexed by oscillator (row)
+     * each instrument state is a single slab with cache line aligned fields
+     **/
+    struct oscillators_state {
+        // generic parameters storage (initially used for filter parameters)
+        FAS_FLOAT (*fp1)[FAS_OSC_PARAMS];
+        FAS_FLOAT (*fp2)[FAS_OSC_PARAMS];
+        FAS_FLOAT (*fp3)[FAS_OSC_PARAMS];
+        FAS_FLOAT (*fp4)[FAS_OSC_PARAMS];
+
+#ifdef MAGIC_CIRCLE
         FAS_FLOAT *mc_x;
         FAS_FLOAT *mc_y;
 #endif
 
-        // wavetable related oscillator
+        // wavetable phase
         FAS_FLOAT *phase_index;
-        FAS_FLOAT phase_step;
 
         // fm/pm; modulator
         FAS_FLOAT *phase_index2;
@@ -46,14 +74,12 @@
 
         // floating-point phase (for PolyBLEP subtractive waveforms / physical modelling) TODO : use wavetable phase (since we dropped integer based phase)
         FAS_FLOAT *fphase;
-        FAS_FLOAT phase_increment;
 
         // generic parameter which generally represent a previous value
         FAS_FLOAT *pvalue;
 
-        // for physical modelling (Karplus-Strong state table)
+        // for physical modelling (Karplus-Strong state tables of all oscillators; see buffer_offset)
         FAS_FLOAT *buffer;
-        unsigned int buffer_len;
 
         // trigger state; wether oscillator has been triggered
         unsigned int *triggered;
@@ -61,20 +87,7 @@
         // unallocated wave
         FAS_FLOAT **wav1, **wav2;
 
-        // Faust generators
-#ifdef WITH_FAUST
-        struct _fas_faust_dsp ***faust_gens;
-        size_t faust_gens_len;
-#endif
-
-        // Soundpipe generators/modifiers/filters
-#ifdef WITH_SOUNDPIPE
-        void ***sp_filters;
-        void ***sp_gens;
-        void ***sp_mods;
-
-        sp_ftbl *ft_void;
-#endif
+        void *slab;
     };
 
     /**
@@ -87,6 +100,14 @@
 #endif
         unsigned int n, double base_frequency, unsigned int octaves, unsigned int sample_rate, unsigned int wavetable_size, unsigned int max_instruments);
 
+#ifdef WITH_SOUNDPIPE
+    /**
+     * create the Soundpipe objects (filters, generators, modifiers) used by a synthesis method for all oscillators of an instrument
+     * objects which already exist are kept; this allocate so it is called from the control thread before the audio thread use the method
+     **/
+    extern void createOscillatorsSoundpipe(sp_data *spd, struct oscillator *osc_bank, unsigned int n, unsigned int instrument, int synthesis_method, unsigned int sample_rate);
+#endif
+
     struct oscillator *updateOscillatorBank(
     #ifdef WITH_SOUNDPIPE
         sp_data *spd,
@@ -101,17 +122,75 @@
 
     extern struct oscillator *freeOscillatorsBank(struct oscillator **oscs, unsigned int n, unsigned int max_instruments);
 
+    /**
+     * create the oscillators state of max_instruments instruments for the N oscillators of osc_bank
+     **/
+    extern struct oscillators_state *createOscillatorsState(struct oscillator *osc_bank, unsigned int n, unsigned int wavetable_size, unsigned int max_instruments);
+    extern struct oscillators_state *freeOscillatorsState(struct oscillators_state **states, unsigned int max_instruments);
+
 #ifdef WITH_FAUST
-    extern void createFaustGenerators(
+    // Faust generator instance of the voices pool
+    struct _fas_faust_voice {
+        struct _fas_faust_dsp fdsp;
+
+        unsigned int factory;
+        // assigned (instrument, row) as instrument * rows + row, -1 when free
+        int owner;
+        // frame of the last note played by this voice
+        unsigned int stamp;
+    };
+
+    /**
+     * Faust generators voices pool; polyphony instances are created for each generators factory and assigned to an (instrument, row) pair
+     * on note-on (notes preprocessing), they are recycled once the note is not part of a frame anymore
+     **/
+    struct _fas_faust_voices {
+        struct _fas_faust_voice *voices; // factories_count * polyphony, grouped by factory
+        unsigned int factories_count;
+        unsigned int polyphony;
+
+        // free voices stack of each factories (indexes into voices)
+        unsigned int *free_voices;
+        unsigned int *free_count;
+
+        // inputs count of each factories
+        int *inputs;
+
+        // assigned voice index + 1 of each (instrument, row), 0 when none
+        unsigned int *assigned;
+        unsigned int rows;
+        unsigned int max_instruments;
+
+        unsigned int stamp;
+    };
+
+    extern struct _fas_faust_voices *createFaustGenerators(
         struct _faust_factories *faust_factories,
-        struct oscillator *osc_bank,
-        unsigned int n,
-        unsigned int sample_rate,
-        unsigned int max_instruments);
+        unsigned int polyphony,
+        unsigned int sample_rate);
 
-    extern void freeFaustGenerators(
-        struct oscillator **o,
-        unsigned int n,
-        unsigned int max_instruments);
+    /**
+     * (re)allocate voices assignment for a bank of n rows, all voices are released
+     **/
+    extern int setFaustGeneratorsBank(struct _fas_faust_voices *voices, unsigned int n, unsigned int max_instruments);
+
+    /**
+     * return the voice of an (instrument, row) pair for the current frame, a free voice is assigned (and cleared) when there is none or when the factory changed
+     * return NULL when the pool of this factory is exhausted
+     **/
+    extern struct _fas_faust_dsp *acquireFaustVoice(struct _fas_faust_voices *voices, struct oscillator *osc, unsigned int factory, unsigned int instrument, unsigned int row);
+
+    /**
+     * release voices which were not acquired since the last call then start a new frame
+     **/
+    extern void releaseFaustVoices(struct _fas_faust_voices *voices);
+
+    static inline struct _fas_faust_dsp *getFaustVoice(struct _fas_faust_voices *voices, unsigned int instrument, unsigned int row) {
+        unsigned int v = voices->assigned[instrument * voices->rows + row];
+
+        return v ? &voices->voices[v - 1].fdsp : NULL;
+    }
+
+    extern struct _fas_faust_voices *freeFaustGenerators(struct _fas_faust_voices **voices);
 #endif
 #endif
@@ -0,0 +1,141 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "scheduler.h"
+
+struct _instruments_graph *createInstrumentsGraph(unsigned int max_nodes) {
+    struct _instruments_graph *graph = (struct _instruments_graph *)calloc(1, sizeof(struct _instruments_graph));
+
+    if (graph == NULL) {
+        printf("createInstrumentsGraph alloc. error.");
+        fflush(stdout);
+        return NULL;
+    }
+
+    graph->max_nodes = max_nodes;
+
+    graph->edges = (unsigned char *)calloc(max_nodes * max_nodes, sizeof(unsigned char));
+    graph->in_degree = (unsigned int *)calloc(max_nodes, sizeof(unsigned int));
+    graph->order = (unsigned int *)calloc(max_nodes, sizeof(unsigned int));
+    graph->levels = (unsigned int *)calloc(max_nodes + 1, sizeof(unsigned int));
+
+    if (graph->edges == NULL || graph->in_degree == NULL || graph->order == NULL || graph->levels == NULL) {
+        printf("createInstrumentsGraph alloc. error.");
+        fflush(stdout);
+
+        return freeInstrumentsGraph(&graph);
+    }
+
+    return graph;
+}
+
+void resetInstrumentsGraph(struct _instruments_graph *graph, unsigned int count) {
+    unsigned int i = 0;
+
+    if (count > graph->max_nodes) {
+        count = graph->max_nodes;
+    }
+
+    // only the used part of the matrix is cleared
+    for (i = 0; i < graph->count || i < count; i += 1) {
+        memset(&graph->edges[i * graph->max_nodes], 0, graph->max_nodes * sizeof(unsigned char));
+    }
+
+    graph->count = count;
+    graph->per_sample = 0;
+}
+
+void addInstrumentsEdge(struct _instruments_graph *graph, unsigned int from, unsigned int to) {
+    if (from >= graph->count || to >= graph->count) {
+        return;
+    }
+
+    graph->edges[from * graph->max_nodes + to] = 1;
+}
+
+int sortInstrumentsGraph(struct _instruments_graph *graph) {
+    unsigned int n = graph->count;
+    unsigned int i, j;
+
+    if (!graph->per_sample) {
+        for (j = 0; j < n; j += 1) {
+            graph->in_degree[j] = 0;
+
+            for (i = 0; i < n; i += 1) {
+                graph->in_degree[j] += graph->edges[i * graph->max_nodes + j];
+            }
+        }
+
+        // Kahn algorithm; a level is made of all nodes whose dependencies were output in previous levels
+        unsigned int sorted = 0;
+
+        graph->levels_count = 0;
+
+        while (sorted < n) {
+            unsigned int level_start = sorted;
+
+            for (j = 0; j < n; j += 1) {
+                if (graph->in_degree[j] == 0) {
+                    graph->order[sorted++] = j;
+                }
+            }
+
+            if (sorted == level_start) {
+                // cycle
+                graph->per_sample = 1;
+
+                break;
+            }
+
+            graph->levels[graph->levels_count++] = level_start;
+
+            for (i = level_start; i < sorted; i += 1) {
+                unsigned int node = graph->order[i];
+
+                // mark as output
+                graph->in_degree[node] = (unsigned int)-1;
+
+                for (j = 0; j < n; j += 1) {
+                    if (graph->edges[node * graph->max_nodes + j]) {
+                        graph->in_degree[j] -= 1;
+                    }
+                }
+            }
+        }
+
+        if (!graph->per_sample) {
+            graph->levels[graph->levels_count] = n;
+
+            return 0;
+        }
+    }
+
+    // per-sample rendering : instruments order
+    for (j = 0; j < n; j += 1) {
+        graph->order[j] = j;
+    }
+
+    graph->levels[0] = 0;
+    graph->levels[1] = n;
+    graph->levels_count = n > 0 ? 1 : 0;
+
+    return -1;
+}
+
+struct _instruments_graph *freeInstrumentsGraph(struct _instruments_graph **g) {
+    struct _instruments_graph *graph = *g;
+
+    if (graph == NULL) {
+        return NULL;
+    }
+
+    free(graph->edges);
+    free(graph->in_degree);
+    free(graph->order);
+    free(graph->levels);
+    free(graph);
+
+    *g = NULL;
+
+    return NULL;
+}
@@ -0,0 +1,48 @@
+#ifndef _FAS_SCHEDULER_H_
+#define _FAS_SCHEDULER_H_
+
+    #include <stdlib.h>
+
+    /**
+     * instruments dependency graph; an edge from -> to means that instrument "from" must be rendered before instrument "to"
+     * (routing source / modulation target), it is sorted into levels of instruments which can be rendered in parallel
+     **/
+    struct _instruments_graph {
+        unsigned int max_nodes;
+        // nodes count (active instruments)
+        unsigned int count;
+
+        // adjacency matrix : edges[from * max_nodes + to]
+        unsigned char *edges;
+        unsigned int *in_degree;
+
+        // topological order grouped by levels, instruments of a level only depend on instruments of previous levels
+        unsigned int *order;
+        // start position of each levels into order (levels_count + 1 entries)
+        unsigned int *levels;
+        unsigned int levels_count;
+
+        // graph cannot be rendered by blocks (cycle, self / channel input); order is then the instruments order in a single level
+        int per_sample;
+    };
+
+    extern struct _instruments_graph *createInstrumentsGraph(unsigned int max_nodes);
+
+    /**
+     * clear all edges and set the nodes count
+     **/
+    extern void resetInstrumentsGraph(struct _instruments_graph *graph, unsigned int count);
+
+    /**
+     * add a dependency; ignored when one of the nodes is not part of the graph
+     **/
+    extern void addInstrumentsEdge(struct _instruments_graph *graph, unsigned int from, unsigned int to);
+
+    /**
+     * compute levels; return -1 (and set per_sample) when the graph has a cycle
+     **/
+    extern int sortInstrumentsGraph(struct _instruments_graph *graph);
+
+    extern struct _instruments_graph *freeInstrumentsGraph(struct _instruments_graph **graph);
+
+#endif
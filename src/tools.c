@@ -1,3 +1,5 @@
+#include <stdatomic.h>
+
 #include "tools.h"
 
 // http://www.martin-finke.de/blog/articles/audio-plugins-018-polyblep-oscillator/
@@ -46,14 +48,42 @@ FAS_FLOAT raw_waveform(FAS_FLOAT phase, int type) {
     return value;
 }
 
-FAS_FLOAT randf(FAS_FLOAT min, FAS_FLOAT max) {
-    if (min == 0.f && max == 0.f) {
-        return 0.f;
+_Thread_local struct _fas_rand_state fas_rand_state;
+
+static _Atomic uint64_t fas_rand_seed;
+static atomic_uint fas_rand_threads;
+
+void fasRandSeed(uint64_t seed) {
+    atomic_store(&fas_rand_seed, seed);
+    atomic_store(&fas_rand_threads, 0);
+
+    // calling thread is the first stream
+    fasRandInitThread();
+}
+
+void fasRandInitThread(void) {
+    unsigned int index = atomic_fetch_add(&fas_rand_threads, 1);
+
+    fas_rand_state.counter = fasRandMix(atomic_load(&fas_rand_seed) + (uint64_t)index * FAS_RAND_GAMMA);
+    fas_rand_state.seeded = 1;
+}
+
+void randfBatch(FAS_FLOAT *out, unsigned int n, FAS_FLOAT min, FAS_FLOAT max) {
+    if (!fas_rand_state.seeded) {
+        fasRandInitThread();
+    }
+
+    uint64_t counter = fas_rand_state.counter;
+    FAS_FLOAT range = max - min;
+
+    unsigned int i = 0;
+    for (i = 0; i < n; i += 1) {
+        uint64_t z = fasRandMix(counter + (uint64_t)(i + 1) * FAS_RAND_GAMMA);
+
+        out[i] = min + range * ((FAS_FLOAT)(uint32_t)(z >> 40) * (1.0f / 16777216.0f));
     }
 
-    FAS_FLOAT range = (max - min);
-    FAS_FLOAT div = RAND_MAX / range;
-    return min + (rand() / div);
+    fas_rand_state.counter = counter + (uint64_t)n * FAS_RAND_GAMMA;
 }
 
 FAS_FLOAT gaussian(FAS_FLOAT x, int L, FAS_FLOAT sigma) {
@@ -285,4 +315,24 @@ double get_time(void) {
 
 FAS_FLOAT lerp(FAS_FLOAT a, FAS_FLOAT b, FAS_FLOAT f) {
     return (a * (1.0 - f)) + (b * f);
-}
\ No newline at end of file
+}
+
+void *alignedCalloc(size_t alignment, size_t size) {
+    // original pointer is stored right before the aligned block
+    void *ptr = calloc(1, size + alignment + sizeof(void *));
+    if (ptr == NULL) {
+        return NULL;
+    }
+
+    uintptr_t aligned = ((uintptr_t)ptr + sizeof(void *) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+
+    ((void **)aligned)[-1] = ptr;
+
+    return (void *)aligned;
+}
+
+void alignedFree(void *ptr) {
+    if (ptr) {
+        free(((void **)ptr)[-1]);
+    }
+}
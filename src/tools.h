@@ -3,6 +3,7 @@
 
     #include <string.h>
     #include <stdlib.h>
+    #include <stdint.h>
     #include <stdio.h>
     #include <math.h>
 
@@ -16,7 +17,46 @@
     extern FAS_FLOAT poly_blep(FAS_FLOAT phase_increment, FAS_FLOAT t);
     FAS_FLOAT raw_waveform(FAS_FLOAT phase, int type);
     
-    extern FAS_FLOAT randf(FAS_FLOAT min, FAS_FLOAT max);
+    /**
+     * per-thread pseudo random numbers generator (SplitMix64); lock free, each thread get its own stream on first use
+     * streams are derived from the seed so renders are reproducible for a seed (as long as threads first use order is the same)
+     **/
+    struct _fas_rand_state {
+        uint64_t counter;
+        int seeded;
+    };
+
+    #define FAS_RAND_GAMMA 0x9E3779B97F4A7C15ULL
+
+    extern _Thread_local struct _fas_rand_state fas_rand_state;
+
+    extern void fasRandSeed(uint64_t seed);
+    extern void fasRandInitThread(void);
+
+    static inline uint64_t fasRandMix(uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+        return z ^ (z >> 31);
+    }
+
+    static inline uint32_t fasRand(void) {
+        if (!fas_rand_state.seeded) {
+            fasRandInitThread();
+        }
+
+        fas_rand_state.counter += FAS_RAND_GAMMA;
+
+        return fasRandMix(fas_rand_state.counter) >> 32;
+    }
+
+    // uniform in [min, max)
+    static inline FAS_FLOAT randf(FAS_FLOAT min, FAS_FLOAT max) {
+        return min + (max - min) * ((FAS_FLOAT)(fasRand() >> 8) * (1.0f / 16777216.0f));
+    }
+
+    // fill out with n uniform values in [min, max); outputs are independent so the loop can be vectorised
+    extern void randfBatch(FAS_FLOAT *out, unsigned int n, FAS_FLOAT min, FAS_FLOAT max);
     extern FAS_FLOAT **createEnvelopes(unsigned int n);
     extern void freeEnvelopes(FAS_FLOAT **envs);
 
@@ -28,4 +68,8 @@
 
     FAS_FLOAT lerp(FAS_FLOAT a, FAS_FLOAT b, FAS_FLOAT f);
 
+    // zero initialized allocation aligned on alignment bytes (power of two); must be released with alignedFree
+    void *alignedCalloc(size_t alignment, size_t size);
+    void alignedFree(void *ptr);
+
 #endif
@@ -33,8 +33,8 @@
 
         int output_chn;
 
-        FAS_FLOAT output_l;
-        FAS_FLOAT output_r;
+        FAS_FLOAT output_l[FAS_BLOCK_SIZE];
+        FAS_FLOAT output_r[FAS_BLOCK_SIZE];
 
         FAS_FLOAT last_sample_l;
         FAS_FLOAT last_sample_r;
@@ -65,6 +65,13 @@
         unsigned int hop_size;
     };
 
+    // instrument rendering kernel; render len samples of instrument k notes (s to e) into out_l / out_r
+#ifdef INTERLEAVED_SAMPLE_FORMAT
+    typedef void (*fas_render_kernel)(unsigned int k, unsigned int s, unsigned int e, float *audio_in, unsigned long i, FAS_FLOAT *lerp_t, unsigned int len, FAS_FLOAT *out_l, FAS_FLOAT *out_r);
+#else
+    typedef void (*fas_render_kernel)(unsigned int k, unsigned int s, unsigned int e, float **inputBuffer, unsigned long i, FAS_FLOAT *lerp_t, unsigned int len, FAS_FLOAT *out_l, FAS_FLOAT *out_r);
+#endif
+
     // synth. instrument
     struct _synth_instrument {
         int type;
@@ -80,6 +87,32 @@
         
         FAS_FLOAT last_sample_l;
         FAS_FLOAT last_sample_r;
+
+        // notes range and output of the current block
+        unsigned int notes_start;
+        unsigned int notes_end;
+
+        FAS_FLOAT output_l[FAS_BLOCK_SIZE];
+        FAS_FLOAT output_r[FAS_BLOCK_SIZE];
+
+        // rendering kernel of the current block (see main.c selectRenderKernel)
+        fas_render_kernel kernel;
+    };
+
+    // instrument notes range rendering task; tall instruments may be split into several tasks
+    struct _render_task {
+        unsigned int instrument;
+
+        // notes range
+        unsigned int s;
+        unsigned int e;
+
+        // rendering target : instrument output (first range) or the task own block
+        FAS_FLOAT *out_l;
+        FAS_FLOAT *out_r;
+
+        FAS_FLOAT output_l[FAS_BLOCK_SIZE];
+        FAS_FLOAT output_r[FAS_BLOCK_SIZE];
     };
 
     // synth. command
@@ -97,8 +130,12 @@
         struct _synth_settings *settings;
         // oscillators bank
         struct oscillator *oscillators;
+        // oscillators per instruments state (one aligned slab per instruments)
+        struct oscillators_state *oscillators_state;
+        // additive synthesis packed partials (one per instruments)
+        struct _additive_bank *additive_banks;
         // granular synthesis grains data
-        struct grain *grains;
+        struct _fas_grains *grains;
         // channels settings
         struct _synth_chn_settings *chn_settings;
         // instruments settings
@@ -118,16 +155,16 @@
         char peer_name[PEER_NAME_BUFFER_LENGTH];
         char peer_ip[PEER_ADDRESS_BUFFER_LENGTH];
 
-        // contain either a fragmented packet or the final packet data
+        // contain either a fragmented packet or the final packet data; fragments are written in place
+        // the buffer is preallocated (frame packet size) on bank settings and only grow when a packet exceed its capacity
         char *packet;
         size_t packet_len;
+        size_t packet_capacity;
         int packet_skip;
 
         int connected;
 
-        // current / previous audio-frame data
-        char *frame_data;
-        char *prev_frame_data;
+        // audio-frame format; frame packets are handed (buffer exchange) to the decode pipeline
         size_t expected_frame_length;
         size_t expected_max_frame_length;
 
@@ -18,6 +18,11 @@ void print_usage() {
     printf("  --render_width %u\n", FAS_RENDER_WIDTH);
     printf("  --max_instruments %u\n", FAS_MAX_INSTRUMENTS);
     printf("  --max_channels %u\n", FAS_MAX_CHANNELS);
+    printf("  --workers %u\n", FAS_WORKERS);
+    printf("  --decoders %u\n", FAS_DECODERS);
+    printf("  --partition_threshold %u\n", FAS_PARTITION_THRESHOLD);
+    printf("  --lookahead %u\n", FAS_LOOKAHEAD);
+    printf("  --rand_seed %u\n", FAS_RAND_SEED);
     //printf("  --render_convert main.fs\n");
     printf("  --iface 127.0.0.1\n");
     printf("  --input_device -1\n");
@@ -27,7 +32,13 @@ void print_usage() {
     printf("  --impulses_dir ./impulses/\n");
     printf("  --faust_gens_dir ./faust/generators/\n");
     printf("  --faust_effs_dir ./faust/effects/\n");
+    printf("  --faust_options \"\"\n");
+    printf("  --faust_target \"\"\n");
+    printf("  --faust_polyphony %u\n", FAS_FAUST_POLYPHONY);
+    printf("  --faust_cache_dir ./faust/cache/\n");
     printf("  --granular_max_density %u\n", FAS_GRANULAR_MAX_DENSITY);
+    printf("  --granular_max_grains %u\n", FAS_GRANULAR_MAX_GRAINS);
+    printf("  --partial_conv_polyphony %u\n", FAS_PARTIAL_CONV_POLYPHONY);
     printf("  --stream_infos_send_delay %u\n", FAS_STREAM_INFOS_SEND_DELAY);
     printf("  --input_channels %u\n", FAS_INPUT_CHANNELS);
     printf("  --output_channels %u\n", FAS_OUTPUT_CHANNELS);
@@ -0,0 +1,198 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "workers.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+
+    #define fasCpuRelax() _mm_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+    #define fasCpuRelax() __asm__ __volatile__("yield")
+#else
+    #define fasCpuRelax()
+#endif
+
+static void executeJobs(struct _fas_workers *workers) {
+    unsigned int index;
+
+    while ((index = atomic_fetch_add_explicit(&workers->next_job, 1, memory_order_relaxed)) < workers->jobs_count) {
+        workers->job(index, workers->data);
+
+        atomic_fetch_add_explicit(&workers->done_jobs, 1, memory_order_release);
+    }
+}
+
+static void *workerThread(void *args) {
+    struct _fas_workers *workers = (struct _fas_workers *)args;
+
+    unsigned int last_generation = 0;
+    unsigned int idle = 0;
+
+    while (!atomic_load_explicit(&workers->quit, memory_order_relaxed)) {
+        unsigned int generation = atomic_load_explicit(&workers->generation, memory_order_acquire);
+
+        if ((generation & 1) == 0 || generation == last_generation) {
+            // wait for a run : spin, yield then sleep when idle for a long time (paused stream etc.)
+            idle += 1;
+
+            if (idle < FAS_WORKERS_SPIN) {
+                fasCpuRelax();
+            } else if (idle < FAS_WORKERS_SPIN * 2) {
+                sched_yield();
+            } else {
+                struct timespec ts = { 0, FAS_WORKERS_SLEEP_NS };
+                nanosleep(&ts, NULL);
+            }
+
+            continue;
+        }
+
+        idle = 0;
+
+        // enter the run then make sure it is still open; the audio thread wait for active workers before closing it
+        atomic_fetch_add(&workers->active, 1);
+
+        if (atomic_load(&workers->generation) == generation) {
+            executeJobs(workers);
+        }
+
+        last_generation = generation;
+
+        atomic_fetch_sub_explicit(&workers->active, 1, memory_order_release);
+    }
+
+    return NULL;
+}
+
+struct _fas_workers *createWorkers(unsigned int count) {
+    if (count == 0) {
+        return NULL;
+    }
+
+    struct _fas_workers *workers = (struct _fas_workers *)calloc(1, sizeof(struct _fas_workers));
+    if (workers == NULL) {
+        printf("createWorkers alloc. error.");
+        fflush(stdout);
+        return NULL;
+    }
+
+    workers->threads = (pthread_t *)calloc(count, sizeof(pthread_t));
+    if (workers->threads == NULL) {
+        printf("createWorkers alloc. error.");
+        fflush(stdout);
+
+        free(workers);
+        return NULL;
+    }
+
+    atomic_init(&workers->generation, 0);
+    atomic_init(&workers->next_job, 0);
+    atomic_init(&workers->done_jobs, 0);
+    atomic_init(&workers->active, 0);
+    atomic_init(&workers->quit, 0);
+
+#ifdef __linux__
+    long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+    unsigned int i = 0;
+    for (i = 0; i < count; i += 1) {
+        int err = pthread_create(&workers->threads[i], NULL, &workerThread, (void *)workers);
+        if (err != 0) {
+            fprintf(stderr, "createWorkers : pthread_create error %i\n", err);
+
+            workers->count = i;
+            return freeWorkers(&workers);
+        }
+
+        workers->count = i + 1;
+
+        // real-time priority (best effort; need privileges)
+        struct sched_param param;
+        param.sched_priority = sched_get_priority_max(SCHED_FIFO) - 1;
+        if (pthread_setschedparam(workers->threads[i], SCHED_FIFO, &param) != 0) {
+#ifdef DEBUG
+    printf("createWorkers : worker %i real-time priority not available\n", i);
+    fflush(stdout);
+#endif
+        }
+
+#ifdef __linux__
+        // pin workers to distinct cores (first core is left to the audio thread)
+        if (cpu_count > 1) {
+            cpu_set_t cpuset;
+            CPU_ZERO(&cpuset);
+            CPU_SET((i + 1) % cpu_count, &cpuset);
+
+            pthread_setaffinity_np(workers->threads[i], sizeof(cpu_set_t), &cpuset);
+        }
+#endif
+    }
+
+    return workers;
+}
+
+void runWorkers(struct _fas_workers *workers, unsigned int jobs_count, fas_workers_job job, void *data) {
+    unsigned int index = 0;
+
+    if (workers == NULL || jobs_count <= 1) {
+        for (index = 0; index < jobs_count; index += 1) {
+            job(index, data);
+        }
+
+        return;
+    }
+
+    workers->job = job;
+    workers->data = data;
+    workers->jobs_count = jobs_count;
+
+    atomic_store_explicit(&workers->next_job, 0, memory_order_relaxed);
+    atomic_store_explicit(&workers->done_jobs, 0, memory_order_relaxed);
+
+    // open the run
+    atomic_fetch_add_explicit(&workers->generation, 1, memory_order_release);
+
+    executeJobs(workers);
+
+    while (atomic_load_explicit(&workers->done_jobs, memory_order_acquire) < jobs_count) {
+        fasCpuRelax();
+    }
+
+    // close the run then wait for workers which may still be inside
+    atomic_fetch_add(&workers->generation, 1);
+
+    while (atomic_load(&workers->active) != 0) {
+        fasCpuRelax();
+    }
+}
+
+struct _fas_workers *freeWorkers(struct _fas_workers **w) {
+    struct _fas_workers *workers = *w;
+
+    if (workers == NULL) {
+        return NULL;
+    }
+
+    atomic_store(&workers->quit, 1);
+
+    unsigned int i = 0;
+    for (i = 0; i < workers->count; i += 1) {
+        pthread_join(workers->threads[i], NULL);
+    }
+
+    free(workers->threads);
+    free(workers);
+
+    *w = NULL;
+
+    return NULL;
+}
@@ -0,0 +1,54 @@
+#ifndef _FAS_WORKERS_H_
+#define _FAS_WORKERS_H_
+
+    #include <stdatomic.h>
+    #include <pthread.h>
+
+    #include "constants.h"
+
+    /**
+     * job function of a workers run; called once per job index (0 ... jobs_count - 1) by any threads of the pool
+     **/
+    typedef void (*fas_workers_job)(unsigned int index, void *data);
+
+    /**
+     * real-time workers pool; pre-spawned (pinned when possible) threads waiting on a lock-free barrier
+     *
+     * a run is started by the audio thread (which also process jobs), jobs are distributed through an atomic counter
+     * and the audio thread only wait for workers which entered the run (no locks; a sleeping worker never delay a run)
+     **/
+    struct _fas_workers {
+        unsigned int count;
+
+        pthread_t *threads;
+
+        // current run (only modified by the audio thread while no workers are active)
+        fas_workers_job job;
+        void *data;
+        unsigned int jobs_count;
+
+        // run state; odd when a run is open
+        atomic_uint generation;
+
+        atomic_uint next_job;
+        atomic_uint done_jobs;
+
+        // workers currently inside a run
+        atomic_uint active;
+
+        atomic_int quit;
+    };
+
+    /**
+     * spawn count workers threads (the audio thread is the additional one), return NULL when count is 0 or on failure
+     **/
+    extern struct _fas_workers *createWorkers(unsigned int count);
+
+    /**
+     * execute jobs_count jobs on the pool and return once all of them are done; jobs are executed in order on the calling thread when workers is NULL
+     **/
+    extern void runWorkers(struct _fas_workers *workers, unsigned int jobs_count, fas_workers_job job, void *data);
+
+    extern struct _fas_workers *freeWorkers(struct _fas_workers **workers);
+
+#endif